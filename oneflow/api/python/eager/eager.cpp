@@ -16,8 +16,16 @@ limitations under the License.
 #include <pybind11/pybind11.h>
 #include "oneflow/api/python/of_api_registry.h"
 #include "oneflow/core/job/cluster_instruction.h"
+#include "oneflow/core/eager/eager_kernel_cache.h"
+
+namespace py = pybind11;
 
 ONEFLOW_API_PYBIND11_MODULE("eager", m) {
   using namespace oneflow;
   m.def("Sync", &ClusterInstruction::MasterSendEagerSync);
+  m.def("KernelCacheHitAndMissCount", []() {
+    const auto* cache = Global<eager::EagerKernelCache>::Get();
+    if (cache == nullptr) { return py::make_tuple(0, 0); }
+    return py::make_tuple(cache->hit_cnt(), cache->miss_cnt());
+  });
 }
@@ -17,6 +17,7 @@ limitations under the License.
 #include <string>
 #include "oneflow/api/python/of_api_registry.h"
 #include "oneflow/api/python/vm/run_instruction.h"
+#include "oneflow/core/vm/vm_util.h"
 
 namespace py = pybind11;
 
@@ -25,4 +26,6 @@ ONEFLOW_API_PYBIND11_MODULE("vm", m) {
   m.def("RunLogicalInstruction", &RunLogicalInstruction, py::call_guard<py::gil_scoped_release>());
   m.def("RunPhysicalInstruction", &RunPhysicalInstruction,
         py::call_guard<py::gil_scoped_release>());
+  m.def("Sync", []() { return vm::Sync().GetOrThrow(); },
+        py::call_guard<py::gil_scoped_release>());
 }
@@ -56,6 +56,10 @@ void Actor::Init(const JobDesc* job_desc, const TaskProto& task_proto,
                   [](const ExecKernel& ek) { return ek.kernel->IsKernelLaunchSynchronized(); });
   if (!is_kernel_launch_synchronized_) { CHECK_EQ(exec_kernel_vec_.size(), 1); }
 
+  if (Global<profiler::MetricsRegistry>::Get() != nullptr) {
+    metrics_.reset(new ActorMetrics(task_proto));
+  }
+
   remaining_eord_cnt_ = 0;
   msg_handler_ = nullptr;
   eord_regst_desc_ids_.clear();
@@ -415,7 +419,9 @@ void Actor::TryLogActEvent(const std::function<void()>& DoAct) const {
 void Actor::ActUntilFail() {
   while (IsReadReady() && IsWriteReady()) {
     act_id_ += 1;
+    if (metrics_) { metrics_->OnActStart(); }
     TryLogActEvent([&] { Act(); });
+    if (metrics_) { metrics_->OnActEnd(); }
 
     AsyncSendCustomizedProducedRegstMsgToConsumer();
     AsyncSendNaiveProducedRegstMsgToConsumer();
@@ -427,6 +433,7 @@ void Actor::ActUntilFail() {
 
     AsyncSendQueuedMsg();
   }
+  if (metrics_) { metrics_->OnBlocked(IsReadReady()); }
 }
 
 void Actor::AsyncSendNaiveProducedRegstMsgToConsumer() {
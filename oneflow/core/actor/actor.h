@@ -27,6 +27,7 @@ limitations under the License.
 #include "oneflow/core/register/register_manager.h"
 #include "oneflow/core/thread/thread_context.h"
 #include "oneflow/core/actor/register_slot.h"
+#include "oneflow/core/actor/actor_metrics.h"
 
 namespace oneflow {
 
@@ -251,6 +252,7 @@ class Actor {
   std::deque<ActorMsg> async_msg_queue_;
   bool is_kernel_launch_synchronized_;
   std::vector<int64_t> tmp_regst_desc_id_vec_;
+  std::unique_ptr<ActorMetrics> metrics_;
 };
 
 std::unique_ptr<Actor> NewActor(const TaskProto&, const ThreadCtx&);
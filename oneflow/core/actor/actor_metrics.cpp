@@ -0,0 +1,78 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/actor/actor_metrics.h"
+
+namespace oneflow {
+
+namespace {
+
+// GetCurTime() is in nanoseconds
+int64_t ElapsedMicroseconds(double start, double end) {
+  return static_cast<int64_t>((end - start) / 1000);
+}
+
+std::string ActorLabels(const TaskProto& task_proto) {
+  std::string op_name;
+  if (task_proto.exec_sequence().exec_node_size() > 0) {
+    op_name =
+        task_proto.exec_sequence().exec_node(0).kernel_conf().op_attribute().op_conf().name();
+  }
+  return profiler::MetricsLabel("actor_id", task_proto.task_id()) + ","
+         + profiler::MetricsLabel("task_type", TaskType_Name(task_proto.task_type())) + ","
+         + profiler::MetricsLabel("op_name", op_name);
+}
+
+}  // namespace
+
+ActorMetrics::ActorMetrics(const TaskProto& task_proto)
+    : wait_type_(kNotWaiting), wait_start_time_(0), act_start_time_(0) {
+  auto* registry = Global<profiler::MetricsRegistry>::Get();
+  const std::string labels = ActorLabels(task_proto);
+  act_cnt_ = registry->MutCounter("actor_act_cnt", labels);
+  act_time_us_ = registry->MutHistogram("actor_act_time_us", labels);
+  readable_wait_time_us_ = registry->MutHistogram("actor_readable_wait_time_us", labels);
+  writeable_wait_time_us_ = registry->MutHistogram("actor_writeable_wait_time_us", labels);
+}
+
+void ActorMetrics::FinishWaiting(double now) {
+  if (wait_type_ == kWaitReadable) {
+    readable_wait_time_us_->Observe(ElapsedMicroseconds(wait_start_time_, now));
+  } else if (wait_type_ == kWaitWriteable) {
+    writeable_wait_time_us_->Observe(ElapsedMicroseconds(wait_start_time_, now));
+  }
+  wait_type_ = kNotWaiting;
+}
+
+void ActorMetrics::OnActStart() {
+  act_start_time_ = GetCurTime();
+  FinishWaiting(act_start_time_);
+}
+
+void ActorMetrics::OnActEnd() {
+  act_cnt_->Add(1);
+  act_time_us_->Observe(ElapsedMicroseconds(act_start_time_, GetCurTime()));
+}
+
+void ActorMetrics::OnBlocked(bool is_read_ready) {
+  const WaitType wait_type = is_read_ready ? kWaitWriteable : kWaitReadable;
+  if (wait_type == wait_type_) { return; }
+  const double now = GetCurTime();
+  FinishWaiting(now);
+  wait_type_ = wait_type;
+  wait_start_time_ = now;
+}
+
+}  // namespace oneflow
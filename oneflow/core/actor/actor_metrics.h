@@ -0,0 +1,51 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_ACTOR_ACTOR_METRICS_H_
+#define ONEFLOW_CORE_ACTOR_ACTOR_METRICS_H_
+
+#include "oneflow/core/job/task.pb.h"
+#include "oneflow/core/profiler/metrics.h"
+
+namespace oneflow {
+
+// Per actor runtime metrics. All methods are called on the thread owning the actor.
+class ActorMetrics final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ActorMetrics);
+  explicit ActorMetrics(const TaskProto& task_proto);
+  ~ActorMetrics() = default;
+
+  void OnActStart();
+  void OnActEnd();
+  // called when the actor stops acting because it is not read ready or not write ready
+  void OnBlocked(bool is_read_ready);
+
+ private:
+  enum WaitType { kNotWaiting = 0, kWaitReadable, kWaitWriteable };
+  void FinishWaiting(double now);
+
+  profiler::MetricsCounter* act_cnt_;
+  profiler::MetricsHistogram* act_time_us_;
+  profiler::MetricsHistogram* readable_wait_time_us_;
+  profiler::MetricsHistogram* writeable_wait_time_us_;
+  WaitType wait_type_;
+  double wait_start_time_;
+  double act_start_time_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_ACTOR_ACTOR_METRICS_H_
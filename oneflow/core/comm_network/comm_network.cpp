@@ -21,16 +21,14 @@ limitations under the License.
 
 namespace oneflow {
 
-CommNet::~CommNet() {
-  ready_cbs_.Close();
-  ready_cb_poller_.join();
-}
+CommNet::~CommNet() {}
 
 void* CommNet::NewActorReadId() { return new ActorReadContext; }
 
 void CommNet::DeleteActorReadId(void* actor_read_id) {
   auto actor_read_ctx = static_cast<ActorReadContext*>(actor_read_id);
   CHECK(actor_read_ctx->waiting_list.empty());
+  CHECK(!actor_read_ctx->is_running_callbacks);
   delete actor_read_ctx;
 }
 
@@ -38,53 +36,60 @@ void CommNet::Read(void* actor_read_id, int64_t src_machine_id, void* src_token,
   auto actor_read_ctx = static_cast<ActorReadContext*>(actor_read_id);
   ReadContext* read_ctx = new ReadContext;
   read_ctx->actor_read_ctx = actor_read_ctx;
-  auto do_read = [this, read_ctx, src_machine_id, src_token, dst_token]() {
-    DoRead(read_ctx, src_machine_id, src_token, dst_token);
-  };
-  AddWorkToStream(actor_read_id, do_read, true);
+  {
+    std::unique_lock<std::mutex> lck(actor_read_ctx->waiting_list_mtx);
+    read_ctx->item_it = actor_read_ctx->waiting_list.emplace(actor_read_ctx->waiting_list.end(),
+                                                             true, nullptr);
+  }
+  // the number of reads in flight is bounded by the regsts of the actor
+  DoRead(read_ctx, src_machine_id, src_token, dst_token);
 }
 
 void CommNet::AddReadCallBack(void* actor_read_id, std::function<void()> callback) {
-  AddWorkToStream(actor_read_id, callback, false);
+  auto actor_read_ctx = static_cast<ActorReadContext*>(actor_read_id);
+  {
+    std::unique_lock<std::mutex> lck(actor_read_ctx->waiting_list_mtx);
+    if (!actor_read_ctx->waiting_list.empty() || actor_read_ctx->is_running_callbacks) {
+      actor_read_ctx->waiting_list.emplace_back(false, callback);
+      return;
+    }
+    actor_read_ctx->is_running_callbacks = true;
+  }
+  callback();
+  RunReadyCallBacks(actor_read_ctx);
 }
 
 void CommNet::ReadDone(void* read_id) {
   ReadContext* read_ctx = static_cast<ReadContext*>(read_id);
   ActorReadContext* actor_read_ctx = read_ctx->actor_read_ctx;
-  CommNetItem item;
   {
     std::unique_lock<std::mutex> lck(actor_read_ctx->waiting_list_mtx);
-    CHECK(!actor_read_ctx->waiting_list.empty());
-    CHECK(actor_read_ctx->waiting_list.front().callback == nullptr);
-    actor_read_ctx->waiting_list.pop_front();
-  }
-  while (true) {
-    {
-      std::unique_lock<std::mutex> lck(actor_read_ctx->waiting_list_mtx);
-      if (actor_read_ctx->waiting_list.empty()) { break; }
-      item = actor_read_ctx->waiting_list.front();
-      actor_read_ctx->waiting_list.pop_front();
-    }
-    CHECK(item.callback);
-    ready_cbs_.Send(item.callback);
-    if (item.is_read) { break; }
+    CHECK(read_ctx->item_it->is_read);
+    CHECK(!read_ctx->item_it->is_done);
+    read_ctx->item_it->is_done = true;
+    delete read_ctx;
+    // the running thread will pick up the callbacks behind this read
+    if (actor_read_ctx->is_running_callbacks) { return; }
+    actor_read_ctx->is_running_callbacks = true;
   }
-  delete read_ctx;
+  RunReadyCallBacks(actor_read_ctx);
 }
 
-void CommNet::AddWorkToStream(void* actor_read_id, const std::function<void()>& cb, bool is_read) {
-  auto actor_read_ctx = static_cast<ActorReadContext*>(actor_read_id);
+void CommNet::RunReadyCallBacks(ActorReadContext* actor_read_ctx) {
   std::unique_lock<std::mutex> lck(actor_read_ctx->waiting_list_mtx);
-  if (actor_read_ctx->waiting_list.empty()) {
-    ready_cbs_.Send(cb);
-  } else {
-    CommNetItem work_item(is_read, cb);
-    actor_read_ctx->waiting_list.push_back(work_item);
-  }
-  if (is_read) {
-    CommNetItem empty_cb;
-    actor_read_ctx->waiting_list.push_back(empty_cb);
+  CHECK(actor_read_ctx->is_running_callbacks);
+  while (!actor_read_ctx->waiting_list.empty()) {
+    CommNetItem& item = actor_read_ctx->waiting_list.front();
+    if (item.is_read && !item.is_done) { break; }
+    std::function<void()> callback = std::move(item.callback);
+    actor_read_ctx->waiting_list.pop_front();
+    if (callback) {
+      lck.unlock();
+      callback();
+      lck.lock();
+    }
   }
+  actor_read_ctx->is_running_callbacks = false;
 }
 
 CommNet::CommNet(const Plan& plan) {
@@ -95,11 +100,6 @@ CommNet::CommNet(const Plan& plan) {
   CHECK(machine_ids_it != net_topo.end());
   std::vector<int64_t> peer_machine_ids = PbRf2StdVec(machine_ids_it->second.machine_id());
   peer_machine_id_.insert(peer_machine_ids.begin(), peer_machine_ids.end());
-
-  ready_cb_poller_ = std::thread([this]() {
-    std::function<void()> cb;
-    while (ready_cbs_.Receive(&cb) == kChannelStatusSuccess) { cb(); }
-  });
 }
 
 CommNet::CommNet() {
@@ -109,11 +109,6 @@ CommNet::CommNet() {
     if (i == this_machine_id) { continue; }
     peer_machine_id_.insert(i);
   }
-
-  ready_cb_poller_ = std::thread([this]() {
-    std::function<void()> cb;
-    while (ready_cbs_.Receive(&cb) == kChannelStatusSuccess) { cb(); }
-  });
 }
 
 }  // namespace oneflow
@@ -22,15 +22,16 @@ limitations under the License.
 #include "oneflow/core/common/platform.h"
 #include "oneflow/core/job/plan.pb.h"
 #include "oneflow/core/job/machine_context.h"
-#include "oneflow/core/common/channel.h"
 
 namespace oneflow {
 
 struct CommNetItem {
   bool is_read;
+  bool is_done;
   std::function<void()> callback;
   CommNetItem() : CommNetItem(false, nullptr) {}
-  CommNetItem(bool read, const std::function<void()>& cb) : is_read(read), callback(cb) {}
+  CommNetItem(bool read, const std::function<void()>& cb)
+      : is_read(read), is_done(false), callback(cb) {}
 };
 
 class CommNet {
@@ -45,6 +46,8 @@ class CommNet {
   virtual void RegisterMemoryDone() = 0;
 
   // Stream
+  // The reads of one actor are issued at once and may finish out of order. A read callback runs
+  // after all reads and callbacks added before it, on the thread which finished the last of them
   void* NewActorReadId();
   void DeleteActorReadId(void* actor_read_id);
   void Read(void* actor_read_id, int64_t src_machine_id, void* src_token, void* dst_token);
@@ -60,21 +63,22 @@ class CommNet {
   virtual void DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) = 0;
   const HashSet<int64_t>& peer_machine_id() { return peer_machine_id_; }
 
-  Channel<std::function<void()>> ready_cbs_;
-
  private:
   friend class Global<CommNet>;
-  void AddWorkToStream(void* actor_read_id, const std::function<void()>& cb, bool is_read);
   struct ActorReadContext;
   struct ReadContext {
     ActorReadContext* actor_read_ctx;
+    std::list<CommNetItem>::iterator item_it;
   };
   struct ActorReadContext {
     std::mutex waiting_list_mtx;
     std::list<CommNetItem> waiting_list;
+    // set while one thread runs the callbacks, which keeps them in order
+    bool is_running_callbacks = false;
   };
+  void RunReadyCallBacks(ActorReadContext* actor_read_ctx);
+
   HashSet<int64_t> peer_machine_id_;
-  std::thread ready_cb_poller_;
 };
 
 template<typename MemDescType>
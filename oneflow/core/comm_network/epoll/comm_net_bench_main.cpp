@@ -0,0 +1,207 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/comm_network/epoll/epoll_comm_network.h"
+#include "oneflow/core/control/ctrl_client.h"
+#include "oneflow/core/control/ctrl_server.h"
+#include "oneflow/core/job/env.pb.h"
+#include "oneflow/core/job/env_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/resource_desc.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+
+DEFINE_int32(ctrl_port, 12243, "ctrl port of the first process, the second one listens on +1.");
+DEFINE_int32(comm_net_worker_num, 1, "number of epoll pollers of each process.");
+DEFINE_int32(iter_num, 2000, "number of reads of each size.");
+DEFINE_int32(max_bytes, 4 << 20, "size of the largest read.");
+DEFINE_int32(max_in_flight_read_num, 8, "number of outstanding reads in the bandwidth phase.");
+
+namespace oneflow {
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace {
+
+constexpr int32_t kProcessNum = 2;
+
+EnvProto GetEnvProto(int32_t rank) {
+  EnvProto ret;
+  for (int32_t i = 0; i < kProcessNum; ++i) {
+    auto* machine = ret.add_machine();
+    machine->set_id(i);
+    machine->set_addr("127.0.0.1");
+    machine->set_ctrl_port_agent(FLAGS_ctrl_port + i);
+  }
+  ret.set_ctrl_port(FLAGS_ctrl_port + rank);
+  return ret;
+}
+
+Resource GetResource() {
+  Resource ret;
+  ret.set_machine_num(kProcessNum);
+  ret.set_gpu_device_num(0);
+  ret.set_cpu_device_num(1);
+  ret.set_comm_net_worker_num(FLAGS_comm_net_worker_num);
+  return ret;
+}
+
+class InFlightCounter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(InFlightCounter);
+  InFlightCounter() : cnt_(0) {}
+  ~InFlightCounter() = default;
+
+  void WaitUntilBelow(int64_t limit) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    cond_.wait(lck, [&]() { return cnt_ < limit; });
+    ++cnt_;
+  }
+  void Decrease() {
+    std::unique_lock<std::mutex> lck(mtx_);
+    --cnt_;
+    cond_.notify_all();
+  }
+  void WaitUntilZero() {
+    std::unique_lock<std::mutex> lck(mtx_);
+    cond_.wait(lck, [&]() { return cnt_ == 0; });
+  }
+
+ private:
+  std::mutex mtx_;
+  std::condition_variable cond_;
+  int64_t cnt_;
+};
+
+// Machine 1 reads from the buffer of machine 0 through one actor read id, as CopyCommNetActor
+// does, keeping at most in_flight_read_num reads outstanding. Returns the seconds of all reads
+double TimeReads(void* actor_read_id, void* src_token, const std::vector<void*>& dst_tokens,
+                 int64_t in_flight_read_num) {
+  InFlightCounter counter;
+  const auto start = std::chrono::steady_clock::now();
+  for (int32_t iter = 0; iter < FLAGS_iter_num; ++iter) {
+    counter.WaitUntilBelow(in_flight_read_num);
+    Global<CommNet>::Get()->Read(actor_read_id, 0, src_token,
+                                 dst_tokens.at(iter % dst_tokens.size()));
+    Global<CommNet>::Get()->AddReadCallBack(actor_read_id, [&counter]() { counter.Decrease(); });
+  }
+  counter.WaitUntilZero();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BenchCommNet(int32_t rank) {
+  Global<EnvDesc>::New(GetEnvProto(rank));
+  Global<CtrlServer>::New();
+  Global<CtrlClient>::New();
+  // both processes share one address, so the machine id can not be looked up by address
+  Global<MachineCtx>::New(rank);
+  Global<ResourceDesc, ForEnv>::New(GetResource());
+  Global<ResourceDesc, ForSession>::New(GetResource());
+  Global<EpollCommNet>::New();
+  Global<CommNet>::SetAllocated(Global<EpollCommNet>::Get());
+
+  const int64_t buf_num = FLAGS_max_in_flight_read_num;
+  std::vector<char> src_buf(FLAGS_max_bytes, 'x');
+  std::vector<std::vector<char>> dst_bufs(buf_num, std::vector<char>(FLAGS_max_bytes));
+  if (rank == 0) {
+    std::cout << std::setw(16) << std::left << "#bytes" << std::setw(24) << std::left
+              << "#ping-pong latency[us]" << std::setw(24) << std::left
+              << "#serial read[MiB/s]" << std::setw(24) << std::left
+              << "#pipelined read[MiB/s]" << std::endl;
+  }
+  for (int64_t bytes = 8; bytes <= FLAGS_max_bytes; bytes *= 8) {
+    const std::string key = "comm_net_bench_src_token_" + std::to_string(bytes);
+    if (rank == 0) {
+      void* src_token = Global<CommNet>::Get()->RegisterMemory(src_buf.data(), bytes);
+      Global<CtrlClient>::Get()->PushKVT(key, reinterpret_cast<uint64_t>(src_token));
+      // the pollers of this process serve the reads of machine 1
+      OF_ENV_BARRIER();
+      Global<CommNet>::Get()->UnRegisterMemory(src_token);
+    } else {
+      uint64_t src_token = 0;
+      Global<CtrlClient>::Get()->PullKVT(key, &src_token);
+      std::vector<void*> dst_tokens;
+      for (auto& dst_buf : dst_bufs) {
+        dst_tokens.push_back(Global<CommNet>::Get()->RegisterMemory(dst_buf.data(), bytes));
+      }
+      void* actor_read_id = Global<CommNet>::Get()->NewActorReadId();
+      void* src = reinterpret_cast<void*>(src_token);
+      const double latency_s = TimeReads(actor_read_id, src, dst_tokens, 1);
+      const double pipelined_s = TimeReads(actor_read_id, src, dst_tokens, buf_num);
+      Global<CommNet>::Get()->DeleteActorReadId(actor_read_id);
+      for (void* dst_token : dst_tokens) { Global<CommNet>::Get()->UnRegisterMemory(dst_token); }
+      CHECK_EQ(dst_bufs.front().at(bytes - 1), 'x');
+      const double mib = static_cast<double>(bytes) * FLAGS_iter_num / (1024 * 1024);
+      std::cout << std::setw(16) << std::left << bytes << std::setw(24) << std::left
+                << latency_s * 1e6 / FLAGS_iter_num << std::setw(24) << std::left
+                << mib / latency_s << std::setw(24) << std::left << mib / pipelined_s
+                << std::endl;
+      OF_ENV_BARRIER();
+    }
+  }
+
+  Global<CommNet>::SetAllocated(nullptr);
+  Global<EpollCommNet>::Delete();
+  Global<ResourceDesc, ForSession>::Delete();
+  Global<ResourceDesc, ForEnv>::Delete();
+  Global<MachineCtx>::Delete();
+  Global<CtrlClient>::Delete();
+  Global<CtrlServer>::Delete();
+  Global<EnvDesc>::Delete();
+}
+
+}  // namespace
+
+#endif  // OF_PLATFORM_POSIX
+
+}  // namespace oneflow
+
+/*
+ * Read latency and bandwidth of EpollCommNet between two local processes. Try run this exe by :
+ *     ./comm_net_bench_main_exe -max_in_flight_read_num=8 -max_bytes=4194304
+ */
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+#ifdef OF_PLATFORM_POSIX
+  // fork before anything touches grpc
+  std::vector<pid_t> pids;
+  for (int32_t rank = 0; rank < kProcessNum; ++rank) {
+    pid_t pid = fork();
+    CHECK_GE(pid, 0);
+    if (pid == 0) {
+      BenchCommNet(rank);
+      return 0;
+    }
+    pids.push_back(pid);
+  }
+  int ret = 0;
+  for (pid_t pid : pids) {
+    int status = 0;
+    CHECK_EQ(waitpid(pid, &status, 0), pid);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) { ret = 1; }
+  }
+  return ret;
+#else
+  return 0;
+#endif  // OF_PLATFORM_POSIX
+}
@@ -70,11 +70,16 @@ void PushPort(int64_t machine_id, uint16_t port) {
   Global<CtrlClient>::Get()->PushKV(GenPortKey(machine_id), std::to_string(port));
 }
 void ClearPort(int64_t machine_id) { Global<CtrlClient>::Get()->ClearKV(GenPortKey(machine_id)); }
-uint16_t PullPort(int64_t machine_id) {
-  uint16_t port = 0;
-  Global<CtrlClient>::Get()->PullKV(
-      GenPortKey(machine_id), [&](const std::string& v) { port = oneflow_cast<uint16_t>(v); });
-  return port;
+HashMap<int64_t, uint16_t> PullPorts(const std::vector<int64_t>& machine_ids) {
+  std::vector<std::string> keys;
+  for (int64_t machine_id : machine_ids) { keys.push_back(GenPortKey(machine_id)); }
+  std::vector<std::string> vals;
+  Global<CtrlClient>::Get()->PullKVs(keys, &vals);
+  HashMap<int64_t, uint16_t> machine_id2port;
+  FOR_RANGE(size_t, i, 0, machine_ids.size()) {
+    CHECK(machine_id2port.emplace(machine_ids.at(i), oneflow_cast<uint16_t>(vals.at(i))).second);
+  }
+  return machine_id2port;
 }
 
 }  // namespace
@@ -123,6 +128,7 @@ EpollCommNet::EpollCommNet() {
   pollers_.resize(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(), nullptr);
   for (size_t i = 0; i < pollers_.size(); ++i) { pollers_[i] = new IOEventPoller; }
   InitSockets();
+  InitMetrics();
   for (IOEventPoller* poller : pollers_) { poller->Start(); }
 }
 
@@ -130,6 +136,7 @@ EpollCommNet::EpollCommNet(const Plan& plan) : CommNetIf(plan) {
   pollers_.resize(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(), nullptr);
   for (size_t i = 0; i < pollers_.size(); ++i) { pollers_[i] = new IOEventPoller; }
   InitSockets();
+  InitMetrics();
   for (IOEventPoller* poller : pollers_) { poller->Start(); }
 }
 
@@ -164,14 +171,19 @@ void EpollCommNet::InitSockets() {
     CHECK_LT(this_listen_port, GetMaxVal<uint16_t>());
   }
   int32_t src_machine_count = 0;
-
-  // connect
+  std::vector<int64_t> dst_machine_ids;
   for (int64_t peer_id : peer_machine_id()) {
     if (peer_id < this_machine_id) {
       ++src_machine_count;
-      continue;
+    } else {
+      dst_machine_ids.push_back(peer_id);
     }
-    uint16_t peer_port = PullPort(peer_id);
+  }
+  const HashMap<int64_t, uint16_t> machine_id2port = PullPorts(dst_machine_ids);
+
+  // connect
+  for (int64_t peer_id : dst_machine_ids) {
+    uint16_t peer_port = machine_id2port.at(peer_id);
     auto peer_machine = Global<ResourceDesc, ForSession>::Get()->machine(peer_id);
     sockaddr_in peer_sockaddr = GetSockAddr(peer_machine.addr(), peer_port);
     int sockfd = socket(AF_INET, SOCK_STREAM, 0);
@@ -202,6 +214,19 @@ void EpollCommNet::InitSockets() {
   }
 }
 
+void EpollCommNet::InitMetrics() {
+  int64_t total_machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
+  machine_id2read_bytes_.assign(total_machine_num, nullptr);
+  machine_id2read_cnt_.assign(total_machine_num, nullptr);
+  auto* registry = Global<profiler::MetricsRegistry>::Get();
+  if (registry == nullptr) { return; }
+  for (int64_t peer_id : peer_machine_id()) {
+    const std::string labels = profiler::MetricsLabel("src_machine_id", peer_id);
+    machine_id2read_bytes_[peer_id] = registry->MutCounter("comm_net_read_bytes", labels);
+    machine_id2read_cnt_[peer_id] = registry->MutCounter("comm_net_read_cnt", labels);
+  }
+}
+
 SocketHelper* EpollCommNet::GetSocketHelper(int64_t machine_id) {
   int sockfd = machine_id2sockfd_.at(machine_id);
   return sockfd2helper_.at(sockfd);
@@ -215,6 +240,11 @@ void EpollCommNet::DoRead(void* read_id, int64_t src_machine_id, void* src_token
   msg.request_write_msg.dst_token = dst_token;
   msg.request_write_msg.read_id = read_id;
   GetSocketHelper(src_machine_id)->AsyncWrite(msg);
+  if (machine_id2read_bytes_.at(src_machine_id) != nullptr) {
+    const auto* dst_mem_desc = static_cast<const SocketMemDesc*>(dst_token);
+    machine_id2read_bytes_.at(src_machine_id)->Add(dst_mem_desc->byte_size);
+    machine_id2read_cnt_.at(src_machine_id)->Add(1);
+  }
 }
 
 }  // namespace oneflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/comm_network/comm_network.h"
 #include "oneflow/core/comm_network/epoll/socket_helper.h"
 #include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+#include "oneflow/core/profiler/metrics.h"
 
 #ifdef OF_PLATFORM_POSIX
 
@@ -46,12 +47,15 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
   EpollCommNet();
   DEPRECATED EpollCommNet(const Plan& plan);
   void InitSockets();
+  void InitMetrics();
   SocketHelper* GetSocketHelper(int64_t machine_id);
   void DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) override;
 
   std::vector<IOEventPoller*> pollers_;
   std::vector<int> machine_id2sockfd_;
   HashMap<int, SocketHelper*> sockfd2helper_;
+  std::vector<profiler::MetricsCounter*> machine_id2read_bytes_;
+  std::vector<profiler::MetricsCounter*> machine_id2read_cnt_;
 };
 
 }  // namespace oneflow
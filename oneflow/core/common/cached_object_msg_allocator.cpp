@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include <iostream>
 #include "oneflow/core/common/cached_object_msg_allocator.h"
+#include "oneflow/core/common/util.h"
 
 namespace oneflow {
 
@@ -123,4 +124,161 @@ void ThreadUnsafeObjectMsgAllocator::Deallocate(char* ptr, std::size_t size) {
   return RoundUpDeallocate(nullptr, ptr, size);
 }
 
+struct ThreadLocalCachedObjectMsgAllocator::BlockHeader final {
+  ThreadCache* owner;
+  int64_t class_index;
+};
+
+struct ThreadLocalCachedObjectMsgAllocator::FreeBlock final {
+  FreeBlock* next;
+};
+
+struct ThreadLocalCachedObjectMsgAllocator::ThreadCache final {
+  explicit ThreadCache(int class_num)
+      : free_lists(class_num, nullptr),
+        remote_free_list(nullptr),
+        allocate_cnt(0),
+        deallocate_cnt(0),
+        remote_deallocate_cnt(0),
+        refill_cnt(0) {}
+
+  // only accessed by the owner thread
+  std::vector<FreeBlock*> free_lists;
+  // pushed by other threads, taken as a whole by the owner thread
+  std::atomic<FreeBlock*> remote_free_list;
+  // only written by the owner thread
+  std::atomic<int64_t> allocate_cnt;
+  std::atomic<int64_t> deallocate_cnt;
+  std::atomic<int64_t> remote_deallocate_cnt;
+  std::atomic<int64_t> refill_cnt;
+};
+
+namespace {
+
+std::atomic<int64_t> allocator_id_counter(0);
+
+void IncreaseCounter(std::atomic<int64_t>* counter) {
+  counter->store(counter->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+ThreadLocalCachedObjectMsgAllocator::ThreadLocalCachedObjectMsgAllocator(
+    ObjectMsgAllocator* backend_allocator, int64_t mem_size_shift_max, int64_t prefetch_cnt)
+    : CachedObjectMsgAllocatorBase(backend_allocator, mem_size_shift_max, prefetch_cnt),
+      allocator_id_(allocator_id_counter++) {}
+
+ThreadLocalCachedObjectMsgAllocator::~ThreadLocalCachedObjectMsgAllocator() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (const auto& thread_cache : thread_caches_) {
+    DrainRemoteFreeList(thread_cache.get());
+    for (FreeBlock* block : thread_cache->free_lists) {
+      while (block != nullptr) {
+        FreeBlock* next = block->next;
+        RoundUpDeallocate(nullptr, reinterpret_cast<char*>(block) - sizeof(BlockHeader),
+                          sizeof(BlockHeader));
+        block = next;
+      }
+    }
+  }
+}
+
+char* ThreadLocalCachedObjectMsgAllocator::Allocate(std::size_t size) {
+  ThreadCache* thread_cache = GetThreadCache();
+  const std::size_t mem_size = size + sizeof(BlockHeader);
+  const int class_index = RoundUpShift(mem_size) - kMemSizeShiftMin;
+  CHECK_LT(class_index, static_cast<int>(thread_cache->free_lists.size()));
+  FreeBlock** free_list = &thread_cache->free_lists.at(class_index);
+  if (*free_list == nullptr) { DrainRemoteFreeList(thread_cache); }
+  if (*free_list == nullptr) { Refill(thread_cache, class_index, mem_size); }
+  FreeBlock* block = *free_list;
+  *free_list = block->next;
+  IncreaseCounter(&thread_cache->allocate_cnt);
+  return reinterpret_cast<char*>(block);
+}
+
+void ThreadLocalCachedObjectMsgAllocator::Deallocate(char* ptr, std::size_t size) {
+  ThreadCache* thread_cache = GetThreadCache();
+  auto* header = reinterpret_cast<BlockHeader*>(ptr - sizeof(BlockHeader));
+  auto* block = reinterpret_cast<FreeBlock*>(ptr);
+  if (header->owner == thread_cache) {
+    FreeBlock** free_list = &thread_cache->free_lists.at(header->class_index);
+    block->next = *free_list;
+    *free_list = block;
+  } else {
+    std::atomic<FreeBlock*>* remote_free_list = &header->owner->remote_free_list;
+    FreeBlock* top = remote_free_list->load(std::memory_order_relaxed);
+    do {
+      block->next = top;
+    } while (!remote_free_list->compare_exchange_weak(top, block, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+    IncreaseCounter(&thread_cache->remote_deallocate_cnt);
+  }
+  IncreaseCounter(&thread_cache->deallocate_cnt);
+}
+
+ThreadLocalCachedObjectMsgAllocator::Stats ThreadLocalCachedObjectMsgAllocator::GetStats() {
+  Stats stats{0, 0, 0, 0};
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (const auto& thread_cache : thread_caches_) {
+    stats.allocate_cnt += thread_cache->allocate_cnt.load(std::memory_order_relaxed);
+    stats.deallocate_cnt += thread_cache->deallocate_cnt.load(std::memory_order_relaxed);
+    stats.remote_deallocate_cnt +=
+        thread_cache->remote_deallocate_cnt.load(std::memory_order_relaxed);
+    stats.refill_cnt += thread_cache->refill_cnt.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+ThreadLocalCachedObjectMsgAllocator::ThreadCache*
+ThreadLocalCachedObjectMsgAllocator::GetThreadCache() {
+  // allocator ids are never reused, so caches of destructed allocators are never looked up again
+  thread_local int64_t last_allocator_id = -1;
+  thread_local ThreadCache* last_thread_cache = nullptr;
+  if (last_allocator_id == allocator_id_) { return last_thread_cache; }
+  thread_local HashMap<int64_t, ThreadCache*> allocator_id2thread_cache;
+  auto iter = allocator_id2thread_cache.find(allocator_id_);
+  if (iter == allocator_id2thread_cache.end()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    thread_caches_.emplace_back(new ThreadCache(mem_size_shift_max() - kMemSizeShiftMin + 1));
+    iter = allocator_id2thread_cache.emplace(allocator_id_, thread_caches_.back().get()).first;
+  }
+  last_allocator_id = allocator_id_;
+  last_thread_cache = iter->second;
+  return last_thread_cache;
+}
+
+void ThreadLocalCachedObjectMsgAllocator::Refill(ThreadCache* thread_cache, int class_index,
+                                                 std::size_t mem_size) {
+  FreeBlock** free_list = &thread_cache->free_lists.at(class_index);
+  const int64_t block_size = int64_t(1) << (class_index + kMemSizeShiftMin);
+  int64_t refill_cnt = kRefillMemSize / block_size;
+  if (refill_cnt > kRefillCnt) { refill_cnt = kRefillCnt; }
+  if (refill_cnt < 1) { refill_cnt = 1; }
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (int64_t i = 0; i < refill_cnt; ++i) {
+    char* mem_ptr = RoundUpAllocate(nullptr, mem_size);
+    auto* header = reinterpret_cast<BlockHeader*>(mem_ptr);
+    header->owner = thread_cache;
+    header->class_index = class_index;
+    auto* block = reinterpret_cast<FreeBlock*>(mem_ptr + sizeof(BlockHeader));
+    block->next = *free_list;
+    *free_list = block;
+  }
+  IncreaseCounter(&thread_cache->refill_cnt);
+}
+
+void ThreadLocalCachedObjectMsgAllocator::DrainRemoteFreeList(ThreadCache* thread_cache) {
+  FreeBlock* block = thread_cache->remote_free_list.exchange(nullptr, std::memory_order_acquire);
+  while (block != nullptr) {
+    FreeBlock* next = block->next;
+    auto* header = reinterpret_cast<BlockHeader*>(reinterpret_cast<char*>(block)
+                                                  - sizeof(BlockHeader));
+    FreeBlock** free_list = &thread_cache->free_lists.at(header->class_index);
+    block->next = *free_list;
+    *free_list = block;
+    block = next;
+  }
+}
+
 }  // namespace oneflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_COMMON_OBJECT_MSG_ALLOCATOR_CORE_H_
 #define ONEFLOW_CORE_COMMON_OBJECT_MSG_ALLOCATOR_CORE_H_
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include "oneflow/core/object_msg/object_msg.h"
@@ -101,10 +103,13 @@ class CachedObjectMsgAllocatorBase : public ObjectMsgAllocator {
   char* RoundUpAllocate(std::mutex* mutex, std::size_t size);
   void RoundUpDeallocate(std::mutex* mutex, char* ptr, std::size_t size);
 
- private:
+ protected:
   int RoundUpShift(std::size_t size) const;
+  std::size_t mem_size_shift_max() const { return mem_size_shift_max_; }
 
   static const std::size_t kMemSizeShiftMin = 6;
+
+ private:
   void Prefetch();
 
   ObjectMsgAllocator* backend_allocator_;
@@ -158,6 +163,54 @@ class ThreadUnsafeObjectMsgAllocator : public CachedObjectMsgAllocatorBase {
   std::thread::id thread_id_;
 };
 
+// Keeps a cache of free blocks per thread on top of the sized pools, so the shared mutex is only
+// taken to refill a cache in batches. A block always returns to the cache of the thread that
+// refilled it: frees from other threads are pushed onto a lock-free remote free list, which the
+// owner drains when its own free list of that size runs out.
+class ThreadLocalCachedObjectMsgAllocator : public CachedObjectMsgAllocatorBase {
+ public:
+  ThreadLocalCachedObjectMsgAllocator(const ThreadLocalCachedObjectMsgAllocator&) = delete;
+  ThreadLocalCachedObjectMsgAllocator(ThreadLocalCachedObjectMsgAllocator&&) = delete;
+
+  ThreadLocalCachedObjectMsgAllocator(int mem_size_shift_max, int64_t prefetch_cnt)
+      : ThreadLocalCachedObjectMsgAllocator(ObjectMsgDefaultAllocator::GlobalObjectMsgAllocator(),
+                                            mem_size_shift_max, prefetch_cnt) {}
+  ThreadLocalCachedObjectMsgAllocator(ObjectMsgAllocator* backend_allocator,
+                                      int64_t mem_size_shift_max, int64_t prefetch_cnt);
+  ~ThreadLocalCachedObjectMsgAllocator() override;
+
+  char* Allocate(std::size_t size) override;
+  void Deallocate(char* ptr, std::size_t size) override;
+
+  struct Stats {
+    int64_t allocate_cnt;
+    int64_t deallocate_cnt;
+    // deallocations of blocks owned by another thread
+    int64_t remote_deallocate_cnt;
+    // batches taken from the sized pools under the shared mutex
+    int64_t refill_cnt;
+  };
+  Stats GetStats();
+
+ private:
+  struct ThreadCache;
+  struct BlockHeader;
+  struct FreeBlock;
+
+  // a refill takes up to kRefillCnt blocks but no more than kRefillMemSize bytes
+  static const int64_t kRefillCnt = 64;
+  static const int64_t kRefillMemSize = 128 * 1024;
+
+  ThreadCache* GetThreadCache();
+  void Refill(ThreadCache* thread_cache, int class_index, std::size_t mem_size);
+  void DrainRemoteFreeList(ThreadCache* thread_cache);
+
+  const int64_t allocator_id_;
+  // guards the sized pools and thread_caches_
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_;
+};
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CORE_COMMON_OBJECT_MSG_ALLOCATOR_CORE_H_
@@ -0,0 +1,63 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/cached_object_msg_allocator.h"
+#include "oneflow/core/common/util.h"
+
+#include <chrono>
+#include <iostream>
+
+DEFINE_int32(iter_num, 100000, "number of allocations of each thread.");
+
+namespace oneflow {
+
+namespace {
+
+void BenchmarkAllocator(const std::string& name, ObjectMsgAllocator* allocator, int thread_num) {
+  const int kBatchSize = 16;
+  const int iter_num = FLAGS_iter_num;
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.push_back(std::thread([allocator, iter_num]() {
+      char* mem_ptr[kBatchSize];
+      for (int i = 0; i < iter_num; i += kBatchSize) {
+        for (int j = 0; j < kBatchSize; ++j) { mem_ptr[j] = allocator->Allocate(64 << (j % 4)); }
+        for (int j = 0; j < kBatchSize; ++j) { allocator->Deallocate(mem_ptr[j], 64 << (j % 4)); }
+      }
+    }));
+  }
+  for (std::thread& thread : threads) { thread.join(); }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << name << " with " << thread_num
+            << " threads: " << iter_num * thread_num / seconds << " allocations/s" << std::endl;
+}
+
+}  // namespace
+
+}  // namespace oneflow
+
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  for (int thread_num : {1, 4}) {
+    CachedObjectMsgAllocator cached_allocator(20, 100);
+    BenchmarkAllocator("CachedObjectMsgAllocator", &cached_allocator, thread_num);
+    ThreadLocalCachedObjectMsgAllocator thread_local_allocator(20, 100);
+    BenchmarkAllocator("ThreadLocalCachedObjectMsgAllocator", &thread_local_allocator, thread_num);
+  }
+  return 0;
+}
@@ -97,6 +97,53 @@ TEST(ThreadUnsafeObjectMsgAllocator, stacked_object_msg_allocator) {
   ASSERT_EQ(cnt, 0);
 }
 
+TEST(ThreadLocalCachedObjectMsgAllocator, stacked_object_msg_allocator) {
+  int cnt = 0;
+  {
+    TestObjMsgAllocator backend_allocator(&cnt);
+    CachedObjectMsgAllocator backend_cache_allocator(&backend_allocator, 21, 100);
+    ThreadLocalCachedObjectMsgAllocator allocator(&backend_cache_allocator, 20, 100);
+    for (int i = 0; i < 100; ++i) {
+      char* mem_ptr = allocator.Allocate(1024);
+      allocator.Deallocate(mem_ptr, 1024);
+    }
+    char* mem_ptr[100];
+    for (int i = 0; i < 100; ++i) { mem_ptr[i] = allocator.Allocate(1024); }
+    for (int i = 0; i < 100; ++i) { allocator.Deallocate(mem_ptr[i], 1024); }
+    const auto& stats = allocator.GetStats();
+    ASSERT_EQ(stats.allocate_cnt, 200);
+    ASSERT_EQ(stats.deallocate_cnt, 200);
+    ASSERT_EQ(stats.remote_deallocate_cnt, 0);
+    ASSERT_EQ(stats.refill_cnt, 2);
+  }
+  ASSERT_EQ(cnt, 0);
+}
+
+TEST(ThreadLocalCachedObjectMsgAllocator, remote_deallocate) {
+  int cnt = 0;
+  {
+    TestObjMsgAllocator backend_allocator(&cnt);
+    ThreadLocalCachedObjectMsgAllocator allocator(&backend_allocator, 20, 100);
+    const int kNum = 1000;
+    std::vector<char*> mem_ptrs(kNum);
+    for (int i = 0; i < kNum; ++i) { mem_ptrs.at(i) = allocator.Allocate(100 + i); }
+    std::thread remote_thread([&]() {
+      for (int i = 0; i < kNum; ++i) { allocator.Deallocate(mem_ptrs.at(i), 100 + i); }
+    });
+    remote_thread.join();
+    const int64_t refill_cnt = allocator.GetStats().refill_cnt;
+    // blocks freed by the remote thread return to the cache of the allocating thread
+    for (int i = 0; i < kNum; ++i) { mem_ptrs.at(i) = allocator.Allocate(100 + i); }
+    for (int i = 0; i < kNum; ++i) { allocator.Deallocate(mem_ptrs.at(i), 100 + i); }
+    const auto& stats = allocator.GetStats();
+    ASSERT_EQ(stats.refill_cnt, refill_cnt);
+    ASSERT_EQ(stats.allocate_cnt, kNum * 2);
+    ASSERT_EQ(stats.deallocate_cnt, kNum * 2);
+    ASSERT_EQ(stats.remote_deallocate_cnt, kNum);
+  }
+  ASSERT_EQ(cnt, 0);
+}
+
 }  // namespace test
 
 }  // namespace oneflow
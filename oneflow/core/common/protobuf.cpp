@@ -52,6 +52,17 @@ bool TxtString2PbMessage(const std::string& proto_str, PbMessage* msg) {
   return google::protobuf::TextFormat::ParseFromString(proto_str, msg);
 }
 
+std::string PbMessage2DeterministicBinString(const PbMessage& proto) {
+  std::string str;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&str);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    CHECK(proto.SerializePartialToCodedStream(&coded_stream));
+  }
+  return str;
+}
+
 bool FieldDefinedInPbMessage(const PbMessage& msg, const std::string& field_name) {
   PROTOBUF_GET_FIELDDESC(msg, field_name);
   return fd != nullptr;
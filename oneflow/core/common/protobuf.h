@@ -72,6 +72,8 @@ void PrintProtoToTextFile(const PbMessage& proto, const std::string& file_path);
 std::string PbMessage2TxtString(const PbMessage& proto);
 void PbMessage2TxtString(const PbMessage& proto, std::string* str);
 bool TxtString2PbMessage(const std::string& proto_str, PbMessage* proto);
+// Binary serialization with map entries sorted by key, so equal messages give equal strings
+std::string PbMessage2DeterministicBinString(const PbMessage& proto);
 
 // Does PbMessage have the field_name
 bool FieldDefinedInPbMessage(const PbMessage&, const std::string& field_name);
@@ -0,0 +1,173 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/env.pb.h"
+#include "oneflow/core/job/env_desc.h"
+#include "oneflow/core/control/ctrl_client.h"
+#include "oneflow/core/control/ctrl_server.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+DEFINE_int32(process_num, 32, "number of local processes, each of which acts as a machine.");
+DEFINE_int32(ctrl_port, 12143, "ctrl port of the first process, process i listens on +i.");
+DEFINE_int32(ctrl_tree_fanout, 8, "fanout of the ctrl tree, 0 keeps everything on the master.");
+DEFINE_int32(iter_num, 20, "number of iterations of each phase.");
+DEFINE_int32(broadcast_bytes, 1 << 20, "size of the broadcast value.");
+
+namespace oneflow {
+
+namespace {
+
+EnvProto GetEnvProto(int32_t rank) {
+  EnvProto ret;
+  for (int32_t i = 0; i < FLAGS_process_num; ++i) {
+    auto* machine = ret.add_machine();
+    machine->set_id(i);
+    machine->set_addr("127.0.0.1");
+    machine->set_ctrl_port_agent(FLAGS_ctrl_port + i);
+  }
+  // every process listens on its own port, peers reach it through ctrl_port_agent
+  ret.set_ctrl_port(FLAGS_ctrl_port + rank);
+  ret.set_ctrl_tree_fanout(FLAGS_ctrl_tree_fanout);
+  return ret;
+}
+
+void RunPhase(const std::string& name, const std::function<void(int32_t iter)>& Phase) {
+  Global<CtrlClient>::Get()->Barrier(name + "_begin", FLAGS_process_num);
+  const auto start = std::chrono::steady_clock::now();
+  for (int32_t iter = 0; iter < FLAGS_iter_num; ++iter) { Phase(iter); }
+  Global<CtrlClient>::Get()->Barrier(name + "_end", FLAGS_process_num);
+  const double ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (Global<MachineCtx>::Get()->IsThisMachineMaster()) {
+    std::cout << std::setw(40) << std::left << name << std::setw(20) << std::left
+              << ms / FLAGS_iter_num << std::endl;
+  }
+}
+
+void BenchCtrl(int32_t rank) {
+  Global<EnvDesc>::New(GetEnvProto(rank));
+  Global<CtrlServer>::New();
+  const auto connect_start = std::chrono::steady_clock::now();
+  Global<CtrlClient>::New();
+  // all processes share one address, so the machine id can not be looked up by address
+  Global<MachineCtx>::New(rank);
+  const int64_t machine_num = FLAGS_process_num;
+  OF_ENV_BARRIER();
+  if (rank == 0) {
+    std::cout << "connect and first barrier of " << machine_num << " processes: "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()
+                                                           - connect_start)
+                     .count()
+              << " ms" << std::endl;
+    std::cout << std::setw(40) << std::left << "#phase" << std::setw(20) << std::left
+              << "#ms per iteration" << std::endl;
+  }
+  RunPhase("master barrier", [&](int32_t iter) {
+    Global<CtrlClient>::Get()->Barrier("master_barrier_" + std::to_string(iter), machine_num);
+  });
+  RunPhase("machine barrier", [&](int32_t iter) {
+    Global<CtrlClient>::Get()->MachineBarrier("machine_barrier_" + std::to_string(iter),
+                                              machine_num);
+  });
+  // the port exchange of EpollCommNet::InitSockets: everyone pushes one key and pulls all others
+  RunPhase("all-to-all kv", [&](int32_t iter) {
+    auto Key = [&](int64_t machine_id) {
+      return "all_to_all_" + std::to_string(iter) + "_" + std::to_string(machine_id);
+    };
+    Global<CtrlClient>::Get()->PushKV(Key(rank), std::to_string(rank));
+    for (int64_t i = 0; i < machine_num; ++i) {
+      std::string val;
+      Global<CtrlClient>::Get()->PullKV(Key(i), &val);
+      CHECK_EQ(val, std::to_string(i));
+    }
+  });
+  RunPhase("batched all-to-all kv", [&](int32_t iter) {
+    auto Key = [&](int64_t machine_id) {
+      return "batched_all_to_all_" + std::to_string(iter) + "_" + std::to_string(machine_id);
+    };
+    Global<CtrlClient>::Get()->PushKVs({Key(rank)}, {std::to_string(rank)});
+    std::vector<std::string> keys;
+    for (int64_t i = 0; i < machine_num; ++i) { keys.push_back(Key(i)); }
+    std::vector<std::string> vals;
+    Global<CtrlClient>::Get()->PullKVs(keys, &vals);
+    for (int64_t i = 0; i < machine_num; ++i) { CHECK_EQ(vals.at(i), std::to_string(i)); }
+  });
+  // PullKVResponse is used as a message holding plain bytes
+  PullKVResponse broadcast_msg;
+  broadcast_msg.set_val(std::string(FLAGS_broadcast_bytes, 'x'));
+  RunPhase("master kv broadcast", [&](int32_t iter) {
+    const std::string key = "master_kv_broadcast_" + std::to_string(iter);
+    if (rank == 0) {
+      Global<CtrlClient>::Get()->PushKV(key, broadcast_msg);
+    } else {
+      PullKVResponse msg;
+      Global<CtrlClient>::Get()->PullKV(key, &msg);
+      CHECK_EQ(msg.val().size(), static_cast<size_t>(FLAGS_broadcast_bytes));
+    }
+  });
+  RunPhase("tree kv broadcast", [&](int32_t iter) {
+    const std::string key = "tree_kv_broadcast_" + std::to_string(iter);
+    if (rank == 0) {
+      Global<CtrlClient>::Get()->PushBroadcastKV(key, machine_num, broadcast_msg);
+    } else {
+      PullKVResponse msg;
+      Global<CtrlClient>::Get()->PullBroadcastKV(key, machine_num, &msg);
+      CHECK_EQ(msg.val().size(), static_cast<size_t>(FLAGS_broadcast_bytes));
+    }
+  });
+  OF_ENV_BARRIER();
+  Global<MachineCtx>::Delete();
+  Global<CtrlClient>::Delete();
+  Global<CtrlServer>::Delete();
+  Global<EnvDesc>::Delete();
+}
+
+}  // namespace
+
+}  // namespace oneflow
+
+/*
+ * Startup benchmark of the control plane with many local processes. Try run this exe by :
+ *     ./ctrl_bench_main_exe -process_num=64 -ctrl_tree_fanout=8 -ctrl_port=12143
+ */
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // fork before anything touches grpc
+  std::vector<pid_t> pids;
+  for (int32_t rank = 0; rank < FLAGS_process_num; ++rank) {
+    pid_t pid = fork();
+    CHECK_GE(pid, 0);
+    if (pid == 0) {
+      BenchCtrl(rank);
+      return 0;
+    }
+    pids.push_back(pid);
+  }
+  int ret = 0;
+  for (pid_t pid : pids) {
+    int status = 0;
+    CHECK_EQ(waitpid(pid, &status, 0), pid);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) { ret = 1; }
+  }
+  return ret;
+}
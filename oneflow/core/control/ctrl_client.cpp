@@ -26,6 +26,27 @@ const int64_t sleep_seconds = 10;
 
 #define GRPC_CHECK(x) CHECK_EQ(x.error_code(), grpc::StatusCode::OK)
 
+// Machine-level barriers and broadcasts run on a tree of machines in which machine i has children
+// i * fanout + 1 ... i * fanout + fanout, so no ctrl server serves more than fanout + 1 calls
+// for one of them. Returns 0 if they should stay on the master ctrl server.
+int64_t CtrlTreeFanout(int64_t machine_num) {
+  const int64_t fanout = Global<EnvDesc>::Get()->ctrl_tree_fanout();
+  if (fanout <= 0 || machine_num <= fanout + 1) { return 0; }
+  return fanout;
+}
+
+int64_t CtrlTreeParent(int64_t machine_id, int64_t fanout) { return (machine_id - 1) / fanout; }
+
+int64_t CtrlTreeChildNum(int64_t machine_id, int64_t fanout, int64_t machine_num) {
+  const int64_t first_child = machine_id * fanout + 1;
+  if (first_child >= machine_num) { return 0; }
+  return std::min(fanout, machine_num - first_child);
+}
+
+std::string CtrlTreeKey(const std::string& k, int64_t machine_id) {
+  return k + "/ctrl_tree/" + std::to_string(machine_id);
+}
+
 template<CtrlMethod ctrl_method>
 class ClientCall final {
  public:
@@ -48,6 +69,7 @@ class ClientCall final {
 }  // namespace
 
 CtrlClient::~CtrlClient() {
+  WaitAsyncKVs();
   {
     std::unique_lock<std::mutex> lck(need_heartbeat_thread_stop_mtx_);
     need_heartbeat_thread_stop_ = true;
@@ -56,14 +78,39 @@ CtrlClient::~CtrlClient() {
 }
 
 void CtrlClient::Barrier(const std::string& barrier_name) {
-  Barrier(barrier_name, Global<EnvDesc>::Get()->TotalMachineNum());
+  MachineBarrier(barrier_name, Global<EnvDesc>::Get()->TotalMachineNum());
 }
 
 void CtrlClient::Barrier(const std::string& barrier_name, int32_t barrier_num) {
+  Barrier(GetMasterStub(), barrier_name, barrier_num);
+}
+
+void CtrlClient::MachineBarrier(const std::string& barrier_name, int64_t machine_num) {
+  const int64_t fanout = CtrlTreeFanout(machine_num);
+  if (fanout == 0) { return Barrier(barrier_name, machine_num); }
+  const int64_t machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  CHECK_LT(machine_id, machine_num);
+  const std::string up_name = barrier_name + "/ctrl_tree_up";
+  const std::string down_name = barrier_name + "/ctrl_tree_down";
+  const int64_t child_num = CtrlTreeChildNum(machine_id, fanout, machine_num);
+  // wait for the subtrees of all children to arrive
+  if (child_num > 0) { Barrier(stubs_.at(machine_id).get(), up_name, child_num + 1); }
+  if (machine_id != 0) {
+    const int64_t parent_id = CtrlTreeParent(machine_id, fanout);
+    const int64_t parent_barrier_num = CtrlTreeChildNum(parent_id, fanout, machine_num) + 1;
+    // report the arrival of this subtree, then wait to be released by the parent
+    Barrier(stubs_.at(parent_id).get(), up_name, parent_barrier_num);
+    Barrier(stubs_.at(parent_id).get(), down_name, parent_barrier_num);
+  }
+  if (child_num > 0) { Barrier(stubs_.at(machine_id).get(), down_name, child_num + 1); }
+}
+
+void CtrlClient::Barrier(CtrlService::Stub* stub, const std::string& barrier_name,
+                         int32_t barrier_num) {
   ClientCall<CtrlMethod::kBarrier> call;
   call.mut_request()->set_name(barrier_name);
   call.mut_request()->set_num(barrier_num);
-  call(GetMasterStub());
+  call(stub);
 }
 
 TryLockResult CtrlClient::TryLock(const std::string& name) {
@@ -94,17 +141,19 @@ void CtrlClient::WaitUntilDone(const std::string& name) {
 }
 
 void CtrlClient::PushKV(const std::string& k, std::function<void(std::string*)> VSetter) {
-  ClientCall<CtrlMethod::kPushKV> call;
-  call.mut_request()->set_key(k);
-  VSetter(call.mut_request()->mutable_val());
-  call(GetResponsibleStub(k));
+  PushKV(GetResponsibleStub(k), k, VSetter);
 }
 
 void CtrlClient::PushMasterKV(const std::string& k, std::function<void(std::string*)> VSetter) {
+  PushKV(GetMasterStub(), k, VSetter);
+}
+
+void CtrlClient::PushKV(CtrlService::Stub* stub, const std::string& k,
+                        std::function<void(std::string*)> VSetter) {
   ClientCall<CtrlMethod::kPushKV> call;
   call.mut_request()->set_key(k);
   VSetter(call.mut_request()->mutable_val());
-  call(GetMasterStub());
+  call(stub);
 }
 
 void CtrlClient::PushKV(const std::string& k, const std::string& v) {
@@ -132,17 +181,19 @@ void CtrlClient::ClearMasterKV(const std::string& k) {
 }
 
 void CtrlClient::PullKV(const std::string& k, std::function<void(const std::string&)> VGetter) {
-  ClientCall<CtrlMethod::kPullKV> call;
-  call.mut_request()->set_key(k);
-  call(GetResponsibleStub(k));
-  VGetter(call.response().val());
+  PullKV(GetResponsibleStub(k), k, VGetter);
 }
 
 void CtrlClient::PullMasterKV(const std::string& k,
                               std::function<void(const std::string&)> VGetter) {
+  PullKV(GetMasterStub(), k, VGetter);
+}
+
+void CtrlClient::PullKV(CtrlService::Stub* stub, const std::string& k,
+                        std::function<void(const std::string&)> VGetter) {
   ClientCall<CtrlMethod::kPullKV> call;
   call.mut_request()->set_key(k);
-  call(GetMasterStub());
+  call(stub);
   VGetter(call.response().val());
 }
 
@@ -158,6 +209,137 @@ void CtrlClient::PullMasterKV(const std::string& k, PbMessage* msg) {
   PullMasterKV(k, [&](const std::string& i) { msg->ParseFromString(i); });
 }
 
+void CtrlClient::PushKVs(const std::vector<std::string>& keys,
+                         const std::vector<std::string>& vals) {
+  CHECK_EQ(keys.size(), vals.size());
+  ForEachKVsBatch(
+      keys, [&](int64_t i) { return vals.at(i).size(); },
+      [&](CtrlService::Stub* stub, const std::vector<int64_t>& key_idxs) {
+        ClientCall<CtrlMethod::kPushKVs> call;
+        for (int64_t i : key_idxs) {
+          PushKVRequest* kv = call.mut_request()->add_kv();
+          kv->set_key(keys.at(i));
+          kv->set_val(vals.at(i));
+        }
+        call(stub);
+      });
+}
+
+void CtrlClient::PullKVs(const std::vector<std::string>& keys, std::vector<std::string>* vals) {
+  vals->clear();
+  vals->resize(keys.size());
+  ForEachKVsBatch(
+      keys, [](int64_t) { return 0; },
+      [&](CtrlService::Stub* stub, const std::vector<int64_t>& key_idxs) {
+        size_t pulled_num = 0;
+        while (pulled_num < key_idxs.size()) {
+          ClientCall<CtrlMethod::kPullKVs> call;
+          FOR_RANGE(size_t, i, pulled_num, key_idxs.size()) {
+            call.mut_request()->add_key(keys.at(key_idxs.at(i)));
+          }
+          call(stub);
+          // the server cuts a response at kCtrlKVsBatchMaxByteSize, pull the rest again
+          CHECK_GT(call.response().val_size(), 0);
+          CHECK_LE(pulled_num + call.response().val_size(), key_idxs.size());
+          for (const std::string& val : call.response().val()) {
+            vals->at(key_idxs.at(pulled_num)) = val;
+            ++pulled_num;
+          }
+        }
+      });
+}
+
+void CtrlClient::AsyncPushKVs(std::vector<std::string> keys, std::vector<std::string> vals,
+                              std::function<void()> Done) {
+  std::unique_lock<std::mutex> lck(async_kv_threads_mtx_);
+  async_kv_threads_.emplace_back(
+      [this](const std::vector<std::string>& keys, const std::vector<std::string>& vals,
+             const std::function<void()>& Done) {
+        PushKVs(keys, vals);
+        Done();
+      },
+      std::move(keys), std::move(vals), std::move(Done));
+}
+
+void CtrlClient::AsyncPullKVs(std::vector<std::string> keys,
+                              std::function<void(const std::vector<std::string>&)> VsGetter) {
+  std::unique_lock<std::mutex> lck(async_kv_threads_mtx_);
+  async_kv_threads_.emplace_back(
+      [this](const std::vector<std::string>& keys,
+             const std::function<void(const std::vector<std::string>&)>& VsGetter) {
+        std::vector<std::string> vals;
+        PullKVs(keys, &vals);
+        VsGetter(vals);
+      },
+      std::move(keys), std::move(VsGetter));
+}
+
+void CtrlClient::WaitAsyncKVs() {
+  std::vector<std::thread> async_kv_threads;
+  {
+    std::unique_lock<std::mutex> lck(async_kv_threads_mtx_);
+    async_kv_threads.swap(async_kv_threads_);
+  }
+  for (std::thread& thread : async_kv_threads) { thread.join(); }
+}
+
+void CtrlClient::ForEachKVsBatch(
+    const std::vector<std::string>& keys, const std::function<size_t(int64_t)>& ByteSize4KeyIdx,
+    const std::function<void(CtrlService::Stub*, const std::vector<int64_t>&)>& Handler) {
+  // (machine id, key indices) of every batch
+  std::vector<std::pair<int64_t, std::vector<int64_t>>> batches;
+  std::vector<size_t> batch_byte_sizes;
+  std::vector<int64_t> machine_id2open_batch_idx(stubs_.size(), -1);
+  FOR_RANGE(int64_t, i, 0, keys.size()) {
+    const int64_t machine_id = GetResponsibleMachineId(keys.at(i));
+    const size_t byte_size = keys.at(i).size() + ByteSize4KeyIdx(i);
+    int64_t& batch_idx = machine_id2open_batch_idx.at(machine_id);
+    if (batch_idx != -1 && batch_byte_sizes.at(batch_idx) + byte_size > kCtrlKVsBatchMaxByteSize) {
+      batch_idx = -1;
+    }
+    if (batch_idx == -1) {
+      batch_idx = batches.size();
+      batches.emplace_back(machine_id, std::vector<int64_t>());
+      batch_byte_sizes.push_back(0);
+    }
+    batches.at(batch_idx).second.push_back(i);
+    batch_byte_sizes.at(batch_idx) += byte_size;
+  }
+  if (batches.empty()) { return; }
+  std::vector<std::thread> threads;
+  FOR_RANGE(size_t, i, 1, batches.size()) {
+    threads.emplace_back([&, i]() {
+      Handler(stubs_.at(batches.at(i).first).get(), batches.at(i).second);
+    });
+  }
+  Handler(stubs_.at(batches.at(0).first).get(), batches.at(0).second);
+  for (std::thread& thread : threads) { thread.join(); }
+}
+
+void CtrlClient::PushBroadcastKV(const std::string& k, int64_t machine_num, const PbMessage& msg) {
+  CHECK(Global<MachineCtx>::Get()->IsThisMachineMaster());
+  if (CtrlTreeFanout(machine_num) == 0) { return PushKV(k, msg); }
+  PushKV(GetMasterStub(), CtrlTreeKey(k, 0), [&](std::string* o) { msg.SerializeToString(o); });
+}
+
+void CtrlClient::PullBroadcastKV(const std::string& k, int64_t machine_num, PbMessage* msg) {
+  CHECK(!Global<MachineCtx>::Get()->IsThisMachineMaster());
+  const int64_t fanout = CtrlTreeFanout(machine_num);
+  if (fanout == 0) { return PullKV(k, msg); }
+  const int64_t machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  CHECK_LT(machine_id, machine_num);
+  const int64_t parent_id = CtrlTreeParent(machine_id, fanout);
+  std::string val;
+  PullKV(stubs_.at(parent_id).get(), CtrlTreeKey(k, parent_id),
+         [&](const std::string& i) { val = i; });
+  // relay the value to the children through the ctrl server of this machine
+  if (CtrlTreeChildNum(machine_id, fanout, machine_num) > 0) {
+    PushKV(stubs_.at(machine_id).get(), CtrlTreeKey(k, machine_id),
+           [&](std::string* o) { *o = val; });
+  }
+  msg->ParseFromString(val);
+}
+
 void CtrlClient::PushActEvent(const ActEvent& act_event) {
   ClientCall<CtrlMethod::kPushActEvent> call;
   *(call.mut_request()->mutable_act_event()) = act_event;
@@ -247,8 +429,11 @@ CtrlService::Stub* CtrlClient::GetThisStub() {
 }
 
 CtrlService::Stub* CtrlClient::GetResponsibleStub(const std::string& key) {
-  int64_t machine_id = (std::hash<std::string>{}(key)) % Global<EnvDesc>::Get()->TotalMachineNum();
-  return stubs_[machine_id].get();
+  return stubs_[GetResponsibleMachineId(key)].get();
+}
+
+int64_t CtrlClient::GetResponsibleMachineId(const std::string& key) {
+  return (std::hash<std::string>{}(key)) % Global<EnvDesc>::Get()->TotalMachineNum();
 }
 
 }  // namespace oneflow
@@ -30,6 +30,8 @@ class CtrlClient final {
 
   void Barrier(const std::string& barrier_name);
   void Barrier(const std::string& barrier_name, int32_t barrier_num);
+  // Each of the machines [0, machine_num) calls it once
+  void MachineBarrier(const std::string& barrier_name, int64_t machine_num);
 
   TryLockResult TryLock(const std::string& name);
   void NotifyDone(const std::string& name);
@@ -58,6 +60,23 @@ class CtrlClient final {
     *v = oneflow_cast<T>(v_str);
   }
 
+  // Batched KV calls send the keys of one responsible ctrl server in a single RPC and call the
+  // servers concurrently. vals[i] belongs to keys[i]
+  void PushKVs(const std::vector<std::string>& keys, const std::vector<std::string>& vals);
+  void PullKVs(const std::vector<std::string>& keys, std::vector<std::string>* vals);
+  // Return at once and run Done on a background thread after the calls finish. All of them are
+  // joined by WaitAsyncKVs() or the destructor
+  void AsyncPushKVs(std::vector<std::string> keys, std::vector<std::string> vals,
+                    std::function<void()> Done);
+  void AsyncPullKVs(std::vector<std::string> keys,
+                    std::function<void(const std::vector<std::string>&)> VsGetter);
+  void WaitAsyncKVs();
+
+  // The master pushes a value which every other machine of [0, machine_num) pulls. Values are
+  // relayed by the ctrl servers of a tree of machines and kept until Clear()
+  void PushBroadcastKV(const std::string& k, int64_t machine_num, const PbMessage& msg);
+  void PullBroadcastKV(const std::string& k, int64_t machine_num, PbMessage* msg);
+
   void PushActEvent(const ActEvent&);
   void Clear();
 
@@ -69,15 +88,27 @@ class CtrlClient final {
   friend class Global<CtrlClient>;
   CtrlClient();
   void LoadServer(const std::string& server_addr, CtrlService::Stub* stub);
+  void Barrier(CtrlService::Stub* stub, const std::string& barrier_name, int32_t barrier_num);
+  void PushKV(CtrlService::Stub* stub, const std::string& k,
+              std::function<void(std::string*)> VSetter);
+  void PullKV(CtrlService::Stub* stub, const std::string& k,
+              std::function<void(const std::string&)> VGetter);
   void PushMasterKV(const std::string& k, std::function<void(std::string*)> VSetter);
   void PullMasterKV(const std::string& k, std::function<void(const std::string&)> VGetter);
   CtrlService::Stub* GetMasterStub() { return stubs_[0].get(); }
   CtrlService::Stub* GetThisStub();
   CtrlService::Stub* GetResponsibleStub(const std::string& key);
+  int64_t GetResponsibleMachineId(const std::string& key);
+  void ForEachKVsBatch(const std::vector<std::string>& keys,
+                       const std::function<size_t(int64_t)>& ByteSize4KeyIdx,
+                       const std::function<void(CtrlService::Stub*, const std::vector<int64_t>&)>&
+                           Handler);
 
   std::vector<std::unique_ptr<CtrlService::Stub>> stubs_;
   std::mutex done_names_mtx_;
   HashSet<std::string> done_names_;
+  std::mutex async_kv_threads_mtx_;
+  std::vector<std::thread> async_kv_threads_;
 
   bool need_heartbeat_thread_stop_;
   std::mutex need_heartbeat_thread_stop_mtx_;
@@ -87,9 +118,9 @@ class CtrlClient final {
 #define FILE_LINE_STR __FILE__ ":" OF_PP_STRINGIZE(__LINE__)
 
 #define OF_ENV_BARRIER() Global<CtrlClient>::Get()->Barrier(FILE_LINE_STR)
-#define OF_SESSION_BARRIER()                        \
-  Global<CtrlClient>::Get()->Barrier(FILE_LINE_STR, \
-                                     Global<ResourceDesc, ForSession>::Get()->TotalMachineNum())
+#define OF_SESSION_BARRIER()                 \
+  Global<CtrlClient>::Get()->MachineBarrier( \
+      FILE_LINE_STR, Global<ResourceDesc, ForSession>::Get()->TotalMachineNum())
 
 static void OfCallOnce(const std::string& name, std::function<void()> f) {
   TryLockResult lock_ret = Global<CtrlClient>::Get()->TryLock(name);
@@ -167,18 +167,7 @@ void CtrlServer::Init() {
   });
 
   Add([this](CtrlCall<CtrlMethod::kPushKV>* call) {
-    const std::string& k = call->request().key();
-    const std::string& v = call->request().val();
-    CHECK(kv_.emplace(k, v).second);
-
-    auto pending_kv_calls_it = pending_kv_calls_.find(k);
-    if (pending_kv_calls_it != pending_kv_calls_.end()) {
-      for (auto pending_call : pending_kv_calls_it->second) {
-        pending_call->mut_response()->set_val(v);
-        pending_call->SendResponse();
-      }
-      pending_kv_calls_.erase(pending_kv_calls_it);
-    }
+    PushKV(call->request().key(), call->request().val());
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kPushKV>();
   });
@@ -187,6 +176,7 @@ void CtrlServer::Init() {
     const std::string& k = call->request().key();
     CHECK_EQ(kv_.erase(k), 1);
     CHECK(pending_kv_calls_.find(k) == pending_kv_calls_.end());
+    CHECK(pending_kvs_calls_.find(k) == pending_kvs_calls_.end());
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kClearKV>();
   });
@@ -215,6 +205,8 @@ void CtrlServer::Init() {
     kv_.clear();
     CHECK(pending_kv_calls_.empty()) << "size(): " << pending_kv_calls_.size()
                                      << ", begin()->key: " << pending_kv_calls_.begin()->first;
+    CHECK(pending_kvs_calls_.empty()) << "size(): " << pending_kvs_calls_.size()
+                                      << ", begin()->key: " << pending_kvs_calls_.begin()->first;
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kClear>();
   });
@@ -232,6 +224,65 @@ void CtrlServer::Init() {
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kEraseCount>();
   });
+
+  Add([this](CtrlCall<CtrlMethod::kPushKVs>* call) {
+    for (const auto& kv : call->request().kv()) { PushKV(kv.key(), kv.val()); }
+    call->SendResponse();
+    EnqueueRequest<CtrlMethod::kPushKVs>();
+  });
+
+  Add([this](CtrlCall<CtrlMethod::kPullKVs>* call) {
+    int64_t missing_key_num = 0;
+    for (const std::string& k : call->request().key()) {
+      if (kv_.find(k) != kv_.end()) { continue; }
+      pending_kvs_calls_[k].push_back(call);
+      ++missing_key_num;
+    }
+    if (missing_key_num == 0) {
+      SendPullKVsResponse(call);
+    } else {
+      CHECK(pending_kvs_call2missing_key_num_.emplace(call, missing_key_num).second);
+    }
+    EnqueueRequest<CtrlMethod::kPullKVs>();
+  });
+}
+
+void CtrlServer::PushKV(const std::string& k, const std::string& v) {
+  CHECK(kv_.emplace(k, v).second);
+
+  auto pending_kv_calls_it = pending_kv_calls_.find(k);
+  if (pending_kv_calls_it != pending_kv_calls_.end()) {
+    for (auto pending_call : pending_kv_calls_it->second) {
+      pending_call->mut_response()->set_val(v);
+      pending_call->SendResponse();
+    }
+    pending_kv_calls_.erase(pending_kv_calls_it);
+  }
+  auto pending_kvs_calls_it = pending_kvs_calls_.find(k);
+  if (pending_kvs_calls_it != pending_kvs_calls_.end()) {
+    for (auto pending_call : pending_kvs_calls_it->second) {
+      auto missing_it = pending_kvs_call2missing_key_num_.find(pending_call);
+      CHECK(missing_it != pending_kvs_call2missing_key_num_.end());
+      if (--missing_it->second > 0) { continue; }
+      pending_kvs_call2missing_key_num_.erase(missing_it);
+      SendPullKVsResponse(pending_call);
+    }
+    pending_kvs_calls_.erase(pending_kvs_calls_it);
+  }
+}
+
+void CtrlServer::SendPullKVsResponse(CtrlCall<CtrlMethod::kPullKVs>* call) {
+  size_t byte_size = 0;
+  for (const std::string& k : call->request().key()) {
+    const std::string& v = kv_.at(k);
+    // the client pulls the keys left out again
+    if (call->mut_response()->val_size() > 0 && byte_size + v.size() > kCtrlKVsBatchMaxByteSize) {
+      break;
+    }
+    byte_size += v.size();
+    *call->mut_response()->add_val() = v;
+  }
+  call->SendResponse();
 }
 
 }  // namespace oneflow
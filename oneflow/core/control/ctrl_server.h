@@ -43,6 +43,8 @@ class CtrlServer final {
  private:
   void HandleRpcs();
   void Init();
+  void PushKV(const std::string& k, const std::string& v);
+  void SendPullKVsResponse(CtrlCall<CtrlMethod::kPullKVs>* call);
 
   void EnqueueRequests() {
     for_each_i(handlers_, helper{this}, std::make_index_sequence<kCtrlMethodNum>{});
@@ -88,9 +90,11 @@ class CtrlServer final {
   HashMap<std::string, std::pair<std::list<CtrlCallIf*>, int32_t>> barrier_calls_;
   // TryLock, NotifyDone, WaitUntilDone
   HashMap<std::string, void*> name2lock_status_;
-  // PushKV, ClearKV, PullKV
+  // PushKV, ClearKV, PullKV, PushKVs, PullKVs
   HashMap<std::string, std::string> kv_;
   HashMap<std::string, std::list<CtrlCall<CtrlMethod::kPullKV>*>> pending_kv_calls_;
+  HashMap<std::string, std::list<CtrlCall<CtrlMethod::kPullKVs>*>> pending_kvs_calls_;
+  HashMap<CtrlCall<CtrlMethod::kPullKVs>*, int64_t> pending_kvs_call2missing_key_num_;
   // IncreaseCount, EraseCount
   HashMap<std::string, int32_t> count_;
 
@@ -44,7 +44,9 @@ namespace oneflow {
   OF_PP_MAKE_TUPLE_SEQ(PushActEvent)  \
   OF_PP_MAKE_TUPLE_SEQ(Clear)         \
   OF_PP_MAKE_TUPLE_SEQ(IncreaseCount) \
-  OF_PP_MAKE_TUPLE_SEQ(EraseCount)
+  OF_PP_MAKE_TUPLE_SEQ(EraseCount)    \
+  OF_PP_MAKE_TUPLE_SEQ(PushKVs)       \
+  OF_PP_MAKE_TUPLE_SEQ(PullKVs)
 
 #define CatRequest(method) method##Request,
 #define CatReqponse(method) method##Response,
@@ -60,6 +62,9 @@ namespace oneflow {
 MAKE_META_DATA()
 
 constexpr const size_t kCtrlMethodNum = OF_PP_SEQ_SIZE(CTRL_METHOD_SEQ);
+// PushKVs and PullKVs split their values into RPCs of about this size to stay below the message
+// size limit of the channels. A larger value takes one RPC of its own
+constexpr const size_t kCtrlKVsBatchMaxByteSize = 16 * 1024 * 1024;
 
 template<CtrlMethod ctrl_method>
 using CtrlRequest =
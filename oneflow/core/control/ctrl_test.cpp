@@ -77,6 +77,46 @@ TEST(CtrlServer, new_delete) {
   Global<EnvDesc>::Delete();
 }
 
+TEST(CtrlClient, push_pull_kvs) {
+  int port = CtrlUtil().FindAvailablePort();
+  if (port == -1) { return; }
+  EnvProto env_proto = GetEnvProto(port);
+  Global<EnvDesc>::New(env_proto);
+  Global<CtrlServer>::New();
+  Global<CtrlClient>::New();
+  int64_t this_mchn_id =
+      Global<EnvDesc>::Get()->GetMachineId(Global<CtrlServer>::Get()->this_machine_addr());
+  Global<MachineCtx>::New(this_mchn_id);
+
+  std::vector<std::string> keys;
+  std::vector<std::string> vals;
+  for (int32_t i = 0; i < 64; ++i) {
+    keys.push_back("kvs_" + std::to_string(i));
+    vals.push_back(std::to_string(i));
+  }
+  // two values which do not fit into one response
+  keys.push_back("kvs_large_0");
+  vals.push_back(std::string(kCtrlKVsBatchMaxByteSize / 2 + 1, 'a'));
+  keys.push_back("kvs_large_1");
+  vals.push_back(std::string(kCtrlKVsBatchMaxByteSize / 2 + 1, 'b'));
+  // pull before the push, the call waits for the missing keys on the server
+  std::vector<std::string> pulled_vals;
+  Global<CtrlClient>::Get()->AsyncPullKVs(
+      keys, [&](const std::vector<std::string>& vs) { pulled_vals = vs; });
+  Global<CtrlClient>::Get()->PushKVs(keys, vals);
+  Global<CtrlClient>::Get()->WaitAsyncKVs();
+  ASSERT_EQ(pulled_vals, vals);
+  std::string val;
+  Global<CtrlClient>::Get()->PullKV("kvs_7", &val);
+  ASSERT_EQ(val, "7");
+  Global<CtrlClient>::Get()->Clear();
+
+  Global<MachineCtx>::Delete();
+  Global<CtrlClient>::Delete();
+  Global<CtrlServer>::Delete();
+  Global<EnvDesc>::Delete();
+}
+
 }  // namespace oneflow
 
 #endif  // OF_PLATFORM_POSIX
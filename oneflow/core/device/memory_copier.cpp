@@ -15,7 +15,9 @@ limitations under the License.
 */
 #include "oneflow/core/device/memory_copier.h"
 #include "oneflow/core/common/auto_registration_factory.h"
-#include "oneflow/core/common/nd_index_offset_helper.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
@@ -77,25 +79,104 @@ MemoryCopyNdDesc GetDescInBytes(const MemoryCopyNdDesc& desc) {
 
 }  // namespace
 
+namespace {
+
+// A copy of at least this many bytes per thread is split over the compute thread pool
+constexpr int64_t kParallelCopyMinBytesPerThread = 2 << 20;
+
+template<size_t row_size>
+struct FixedSizeRowCopy {
+  // a memcpy of a constant size compiles to a few moves
+  void operator()(unsigned char* dst, const unsigned char* src) const {
+    memcpy(dst, src, row_size);
+  }
+};
+
+struct RowCopy {
+  size_t row_size;
+  void operator()(unsigned char* dst, const unsigned char* src) const {
+    memcpy(dst, src, row_size);
+  }
+};
+
+// Copies rows [row_begin, row_end) of an extent whose last axis is a contiguous row. The index
+// of the outer axes is advanced like an odometer, so no offset is recomputed from an index.
+template<int32_t NDIMS, typename CopyRowT>
+void CopyRows(unsigned char* dst, const unsigned char* src, const int64_t* dst_strides,
+              const int64_t* src_strides, const int64_t* extent, int64_t row_begin,
+              int64_t row_end, const CopyRowT& CopyRow) {
+  int64_t idx[NDIMS - 1];
+  int64_t remaining = row_begin;
+  for (int32_t i = NDIMS - 2; i >= 0; --i) {
+    idx[i] = remaining % extent[i];
+    remaining /= extent[i];
+    dst += idx[i] * dst_strides[i];
+    src += idx[i] * src_strides[i];
+  }
+  for (int64_t row = row_begin; row < row_end; ++row) {
+    CopyRow(dst, src);
+    for (int32_t i = NDIMS - 2; i >= 0; --i) {
+      dst += dst_strides[i];
+      src += src_strides[i];
+      if (++idx[i] < extent[i]) { break; }
+      dst -= dst_strides[i] * extent[i];
+      src -= src_strides[i] * extent[i];
+      idx[i] = 0;
+    }
+  }
+}
+
+}  // namespace
+
 template<int32_t NDIMS>
 void CopyNDCpuImpl(DeviceCtx* ctx, void* dst, const void* src, const MemoryCopyNdDesc& desc) {
-  NdIndexOffsetHelper<int64_t, NDIMS> src_helper(desc.src_shape.dim_vec().data());
-  NdIndexOffsetHelper<int64_t, NDIMS> dst_helper(desc.dst_shape.dim_vec().data());
-  NdIndexOffsetHelper<int64_t, NDIMS> copy_helper(desc.extent.dim_vec().data());
-  FOR_RANGE(int64_t, i, 0, desc.extent.elem_cnt()) {
-    int64_t copy_idx[NDIMS];
-    int64_t src_idx[NDIMS];
-    int64_t dst_idx[NDIMS];
-    copy_helper.OffsetToNdIndex(i, copy_idx);
-    FOR_RANGE(int64_t, j, 0, NDIMS) {
-      src_idx[j] = desc.src_pos.At(j) + copy_idx[j];
-      dst_idx[j] = desc.dst_pos.At(j) + copy_idx[j];
+  int64_t dst_strides[NDIMS];
+  int64_t src_strides[NDIMS];
+  int64_t extent[NDIMS];
+  dst_strides[NDIMS - 1] = 1;
+  src_strides[NDIMS - 1] = 1;
+  for (int32_t i = NDIMS - 2; i >= 0; --i) {
+    dst_strides[i] = dst_strides[i + 1] * desc.dst_shape.At(i + 1);
+    src_strides[i] = src_strides[i + 1] * desc.src_shape.At(i + 1);
+  }
+  unsigned char* dst_ptr = reinterpret_cast<unsigned char*>(dst);
+  const unsigned char* src_ptr = reinterpret_cast<const unsigned char*>(src);
+  FOR_RANGE(int32_t, i, 0, NDIMS) {
+    dst_ptr += desc.dst_pos.At(i) * dst_strides[i];
+    src_ptr += desc.src_pos.At(i) * src_strides[i];
+    extent[i] = desc.extent.At(i);
+  }
+  const int64_t row_size = extent[NDIMS - 1];
+  const int64_t row_num = desc.extent.elem_cnt() / row_size;
+  auto CopyRowRange = [&](int64_t row_begin, int64_t row_end) {
+    if (row_size == 4) {
+      CopyRows<NDIMS>(dst_ptr, src_ptr, dst_strides, src_strides, extent, row_begin, row_end,
+                      FixedSizeRowCopy<4>());
+    } else if (row_size == 8) {
+      CopyRows<NDIMS>(dst_ptr, src_ptr, dst_strides, src_strides, extent, row_begin, row_end,
+                      FixedSizeRowCopy<8>());
+    } else if (row_size == 16) {
+      CopyRows<NDIMS>(dst_ptr, src_ptr, dst_strides, src_strides, extent, row_begin, row_end,
+                      FixedSizeRowCopy<16>());
+    } else {
+      CopyRows<NDIMS>(dst_ptr, src_ptr, dst_strides, src_strides, extent, row_begin, row_end,
+                      RowCopy{static_cast<size_t>(row_size)});
     }
-    const int64_t src_offset = src_helper.NdIndexToOffset(src_idx);
-    const int64_t dst_offset = dst_helper.NdIndexToOffset(dst_idx);
-    unsigned char* dst_ptr = reinterpret_cast<unsigned char*>(dst) + dst_offset;
-    const unsigned char* src_ptr = reinterpret_cast<const unsigned char*>(src) + src_offset;
-    *dst_ptr = *src_ptr;
+  };
+  int64_t part_num = 1;
+  if (Global<ThreadPool>::Get() != nullptr) {
+    part_num = std::min<int64_t>(row_num * row_size / kParallelCopyMinBytesPerThread,
+                                 Global<ThreadPool>::Get()->thread_num());
+    part_num = std::min<int64_t>(part_num, row_num);
+  }
+  if (part_num <= 1) {
+    CopyRowRange(0, row_num);
+  } else {
+    BalancedSplitter bs(row_num, part_num);
+    MultiThreadLoop(part_num, [&](size_t i) {
+      const Range range = bs.At(i);
+      CopyRowRange(range.begin(), range.end());
+    });
   }
 }
 
@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/device/memory_copier.h"
+
+#include <chrono>
+#include <iostream>
+
+DEFINE_int32(iter_num, 10, "number of copies of each case.");
+
+namespace oneflow {
+
+namespace {
+
+MemoryCopyNdDesc GetDesc(const DimVector& dst_shape, const DimVector& src_shape,
+                         const DimVector& dst_pos, const DimVector& src_pos,
+                         const DimVector& extent) {
+  MemoryCopyNdDesc desc;
+  desc.dst_shape = Shape(dst_shape);
+  desc.src_shape = Shape(src_shape);
+  desc.dst_pos = NdIndex(dst_pos);
+  desc.src_pos = NdIndex(src_pos);
+  desc.extent = Shape(extent);
+  return desc;
+}
+
+void BenchmarkCopy(const std::string& name, const MemoryCopyNdDesc& desc) {
+  std::unique_ptr<MemoryCopier> copier(NewDefaultMemoryCopier(DeviceType::kCPU));
+  std::vector<float> src(desc.src_shape.elem_cnt(), 1);
+  std::vector<float> dst(desc.dst_shape.elem_cnt(), 0);
+  copier->CopyElem<float>(nullptr, dst.data(), src.data(), desc);
+  const auto start = std::chrono::steady_clock::now();
+  FOR_RANGE(int32_t, i, 0, FLAGS_iter_num) {
+    copier->CopyElem<float>(nullptr, dst.data(), src.data(), desc);
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double gib = static_cast<double>(desc.extent.elem_cnt() * sizeof(float)) * FLAGS_iter_num
+                     / (1024 * 1024 * 1024);
+  std::cout << name << ": " << gib / seconds << " GiB/s" << std::endl;
+}
+
+}  // namespace
+
+}  // namespace oneflow
+
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // NCHW split on C and W, the layout of a 2-D model parallel boxing
+  BenchmarkCopy("split c and w", GetDesc({32, 64, 56, 28}, {32, 256, 56, 56}, {0, 0, 0, 0},
+                                         {0, 64, 0, 28}, {32, 64, 56, 28}));
+  // concat of 4 parts on C, each one copied into its slice of the output
+  BenchmarkCopy("concat c", GetDesc({32, 256, 28, 28, 2}, {32, 64, 28, 28, 2}, {0, 128, 0, 0, 0},
+                                    {0, 0, 0, 0, 0}, {32, 64, 28, 28, 2}));
+  // short rows of one element
+  BenchmarkCopy("split last axis", GetDesc({16, 8, 128, 256, 1}, {16, 8, 128, 256, 2},
+                                           {0, 0, 0, 0, 0}, {0, 0, 0, 0, 1}, {16, 8, 128, 256, 1}));
+  return 0;
+}
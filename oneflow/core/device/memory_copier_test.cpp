@@ -0,0 +1,91 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/device/memory_copier.h"
+#include "oneflow/core/common/nd_index_offset_helper.h"
+#include <random>
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+MemoryCopyNdDesc GetDesc(const DimVector& dst_shape, const DimVector& src_shape,
+                         const DimVector& dst_pos, const DimVector& src_pos,
+                         const DimVector& extent) {
+  MemoryCopyNdDesc desc;
+  desc.dst_shape = Shape(dst_shape);
+  desc.src_shape = Shape(src_shape);
+  desc.dst_pos = NdIndex(dst_pos);
+  desc.src_pos = NdIndex(src_pos);
+  desc.extent = Shape(extent);
+  return desc;
+}
+
+template<int32_t NDIMS>
+void NaiveCopyElem(float* dst, const float* src, const MemoryCopyNdDesc& desc) {
+  NdIndexOffsetHelper<int64_t, NDIMS> src_helper(desc.src_shape.dim_vec().data());
+  NdIndexOffsetHelper<int64_t, NDIMS> dst_helper(desc.dst_shape.dim_vec().data());
+  NdIndexOffsetHelper<int64_t, NDIMS> copy_helper(desc.extent.dim_vec().data());
+  FOR_RANGE(int64_t, i, 0, desc.extent.elem_cnt()) {
+    int64_t copy_idx[NDIMS];
+    int64_t src_idx[NDIMS];
+    int64_t dst_idx[NDIMS];
+    copy_helper.OffsetToNdIndex(i, copy_idx);
+    FOR_RANGE(int64_t, j, 0, NDIMS) {
+      src_idx[j] = desc.src_pos.At(j) + copy_idx[j];
+      dst_idx[j] = desc.dst_pos.At(j) + copy_idx[j];
+    }
+    dst[dst_helper.NdIndexToOffset(dst_idx)] = src[src_helper.NdIndexToOffset(src_idx)];
+  }
+}
+
+template<int32_t NDIMS>
+void TestRandomCopy(std::mt19937* gen) {
+  std::unique_ptr<MemoryCopier> copier(NewDefaultMemoryCopier(DeviceType::kCPU));
+  std::uniform_int_distribution<int64_t> dis(0, 3);
+  DimVector dst_shape, src_shape, dst_pos, src_pos, extent;
+  FOR_RANGE(int32_t, i, 0, NDIMS) {
+    extent.push_back(dis(*gen) + 1);
+    dst_pos.push_back(dis(*gen));
+    src_pos.push_back(dis(*gen));
+    dst_shape.push_back(dst_pos.back() + extent.back() + dis(*gen));
+    src_shape.push_back(src_pos.back() + extent.back() + dis(*gen));
+  }
+  const MemoryCopyNdDesc desc = GetDesc(dst_shape, src_shape, dst_pos, src_pos, extent);
+  std::vector<float> src(desc.src_shape.elem_cnt());
+  for (float& val : src) { val = dis(*gen); }
+  std::vector<float> dst(desc.dst_shape.elem_cnt(), -1);
+  std::vector<float> expected(dst);
+  copier->CopyElem<float>(nullptr, dst.data(), src.data(), desc);
+  NaiveCopyElem<NDIMS>(expected.data(), src.data(), desc);
+  ASSERT_EQ(dst, expected);
+}
+
+}  // namespace
+
+TEST(HostMemoryCopier, random_nd_copy) {
+  std::mt19937 gen(0);
+  FOR_RANGE(int32_t, i, 0, 200) {
+    TestRandomCopy<4>(&gen);
+    TestRandomCopy<5>(&gen);
+    TestRandomCopy<6>(&gen);
+  }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -0,0 +1,216 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/eager/eager_kernel_cache.h"
+#include "oneflow/core/common/protobuf.h"
+
+namespace oneflow {
+namespace eager {
+
+namespace {
+
+void AppendKeyField(const std::string& field, std::string* key) {
+  key->append(std::to_string(field.size()));
+  key->append(":");
+  key->append(field);
+}
+
+void RestoreBlobDescs(const EagerKernelCacheValue& cached,
+                      const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp) {
+  for (const auto& pair : cached.bn_in_op2blob_desc) {
+    BlobDesc* blob_desc = BlobDesc4BnInOp(pair.first);
+    if (blob_desc != nullptr) { *blob_desc = pair.second; }
+  }
+}
+
+void SaveBlobDescs(const std::vector<std::string>& result_bns,
+                   const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+                   EagerKernelCacheValue* value) {
+  for (const std::string& bn_in_op : result_bns) {
+    const BlobDesc* blob_desc = BlobDesc4BnInOp(bn_in_op);
+    if (blob_desc != nullptr) { value->bn_in_op2blob_desc.emplace_back(bn_in_op, *blob_desc); }
+  }
+}
+
+}  // namespace
+
+EagerKernelCache::EagerKernelCache(size_t capacity)
+    : capacity_(capacity), hit_cnt_(0), miss_cnt_(0) {}
+
+EagerKernelCache::~EagerKernelCache() {
+  const int64_t total_cnt = hit_cnt() + miss_cnt();
+  if (total_cnt > 0) {
+    LOG(INFO) << "eager kernel cache hit: " << hit_cnt() << ", miss: " << miss_cnt()
+              << ", hit rate: " << static_cast<double>(hit_cnt()) / total_cnt;
+  }
+}
+
+std::shared_ptr<const EagerKernelCacheValue> EagerKernelCache::Find(const std::string& key) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (capacity_ == 0) { return nullptr; }
+  auto it = key2value_it_.find(key);
+  if (it == key2value_it_.end()) {
+    miss_cnt_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  value_list_.splice(value_list_.begin(), value_list_, it->second);
+  hit_cnt_.fetch_add(1, std::memory_order_relaxed);
+  return it->second->value;
+}
+
+std::shared_ptr<const EagerKernelCacheValue> EagerKernelCache::Insert(
+    const std::string& key, const std::shared_ptr<const EagerKernelCacheValue>& value) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (capacity_ == 0) { return value; }
+  auto it = key2value_it_.find(key);
+  if (it != key2value_it_.end()) { return it->second->value; }
+  value_list_.push_front(CachedValue{key, value});
+  key2value_it_.emplace(key, value_list_.begin());
+  EvictAboveCapacity();
+  return value;
+}
+
+void EagerKernelCache::SetCapacity(size_t capacity) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  EvictAboveCapacity();
+}
+
+size_t EagerKernelCache::capacity() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return capacity_;
+}
+
+size_t EagerKernelCache::size() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return value_list_.size();
+}
+
+void EagerKernelCache::EvictAboveCapacity() {
+  while (value_list_.size() > capacity_) {
+    key2value_it_.erase(value_list_.back().key);
+    value_list_.pop_back();
+  }
+}
+
+std::string EagerKernelCacheOpKey(const Operator& op) {
+  OperatorConf op_conf(op.op_conf());
+  op_conf.clear_name();
+  op_conf.clear_scope_symbol_id();
+  op_conf.clear_ctrl_in_op_name();
+  if (op_conf.has_user_conf()) {
+    // lbns contain the names of this op and of the producers, only the arg counts matter
+    auto ClearLbns = [](PbMap<std::string, UserOpConf::ListString>* arg2lbns) {
+      for (auto& pair : *arg2lbns) {
+        for (std::string& lbn : *pair.second.mutable_s()) { lbn.clear(); }
+      }
+    };
+    ClearLbns(op_conf.mutable_user_conf()->mutable_input());
+    ClearLbns(op_conf.mutable_user_conf()->mutable_output());
+  }
+  std::string key;
+  AppendKeyField(PbMessage2DeterministicBinString(op_conf), &key);
+  AppendKeyField(std::to_string(op.device_type()), &key);
+  return key;
+}
+
+std::string EagerKernelCachePlacementKey(const JobDesc& job_desc, const ParallelDesc& parallel_desc,
+                                         const ParallelContext& parallel_ctx) {
+  std::string key;
+  // job descs and parallel descs of eager calls are symbols, which are interned by content
+  if (job_desc.symbol_id().IsOk()) {
+    AppendKeyField("symbol " + std::to_string(CHECK_JUST(job_desc.symbol_id())), &key);
+  } else {
+    AppendKeyField(std::to_string(job_desc.job_id()), &key);
+    AppendKeyField(PbMessage2DeterministicBinString(job_desc.job_conf()), &key);
+  }
+  if (parallel_desc.symbol_id().IsOk()) {
+    AppendKeyField("symbol " + std::to_string(CHECK_JUST(parallel_desc.symbol_id())), &key);
+  } else {
+    AppendKeyField(PbMessage2DeterministicBinString(parallel_desc.parallel_conf()), &key);
+  }
+  // with the parallel desc, the parallel id determines the machine and device of the call
+  AppendKeyField(std::to_string(parallel_ctx.parallel_id()), &key);
+  AppendKeyField(std::to_string(parallel_ctx.parallel_num()), &key);
+  return key;
+}
+
+std::string EagerKernelCacheKey(
+    const std::string& op_key, const std::string& placement_key,
+    const OpNodeSignatureDesc& op_node_signature, const PbRpf<std::string>& input_bns,
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp) {
+  std::string key(op_key);
+  AppendKeyField(placement_key, &key);
+  // op node signature symbols are interned by content, so the symbol id identifies it
+  AppendKeyField(std::to_string(CHECK_JUST(op_node_signature.symbol_id())), &key);
+  for (const std::string& ibn : input_bns) {
+    const BlobDesc* blob_desc = BlobDesc4BnInOp(ibn);
+    AppendKeyField(ibn, &key);
+    if (blob_desc == nullptr) {
+      AppendKeyField("", &key);
+      continue;
+    }
+    AppendKeyField(blob_desc->shape().ToString(), &key);
+    AppendKeyField(std::to_string(blob_desc->data_type()), &key);
+    AppendKeyField(std::to_string(blob_desc->is_dynamic()), &key);
+    AppendKeyField(std::to_string(blob_desc->is_tensor_list()), &key);
+  }
+  return key;
+}
+
+Maybe<std::shared_ptr<const Kernel>> InferBlobDescsAndGetKernel(
+    EagerKernelCache* cache, const std::string& key, const std::shared_ptr<const JobDesc>& job_desc,
+    const std::vector<std::string>& result_bns,
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+    const std::function<Maybe<std::shared_ptr<const Kernel>>()>& InferAndNewKernel) {
+  if (cache != nullptr) {
+    const auto& cached = cache->Find(key);
+    if (cached) {
+      CHECK_NOTNULL_OR_RETURN(cached->kernel);
+      RestoreBlobDescs(*cached, BlobDesc4BnInOp);
+      return cached->kernel;
+    }
+  }
+  const std::shared_ptr<const Kernel> kernel = *JUST(InferAndNewKernel());
+  if (cache == nullptr) { return kernel; }
+  auto value = std::make_shared<EagerKernelCacheValue>();
+  value->job_desc = job_desc;
+  value->kernel = kernel;
+  SaveBlobDescs(result_bns, BlobDesc4BnInOp, value.get());
+  return cache->Insert(key, value)->kernel;
+}
+
+Maybe<KernelConf> InferBlobDescsAndGetKernelConf(
+    EagerKernelCache* cache, const std::string& key, const std::vector<std::string>& result_bns,
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+    const std::function<Maybe<KernelConf>()>& InferAndGenKernelConf) {
+  if (cache != nullptr) {
+    const auto& cached = cache->Find(key);
+    if (cached) {
+      CHECK_OR_RETURN(!cached->kernel);
+      RestoreBlobDescs(*cached, BlobDesc4BnInOp);
+      return cached->kernel_conf;
+    }
+  }
+  const KernelConf kernel_conf = *JUST(InferAndGenKernelConf());
+  if (cache == nullptr) { return kernel_conf; }
+  auto value = std::make_shared<EagerKernelCacheValue>();
+  value->kernel_conf = kernel_conf;
+  SaveBlobDescs(result_bns, BlobDesc4BnInOp, value.get());
+  return cache->Insert(key, value)->kernel_conf;
+}
+
+}  // namespace eager
+}  // namespace oneflow
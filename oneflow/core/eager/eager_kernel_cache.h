@@ -0,0 +1,118 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EAGER_EAGER_KERNEL_CACHE_H_
+#define ONEFLOW_CORE_EAGER_EAGER_KERNEL_CACHE_H_
+
+#include <list>
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/kernel/kernel.h"
+#include "oneflow/core/operator/operator.h"
+#include "oneflow/core/operator/op_node_signature_desc.h"
+#include "oneflow/core/job/parallel_desc.h"
+
+namespace oneflow {
+namespace eager {
+
+// Op inference result of an eager call: the blob descs inferred for the output and tmp blobs
+// and either the initialized kernel of a user op or the kernel conf of a system op.
+struct EagerKernelCacheValue {
+  // kernels refer to their job desc by raw pointer, so the cache keeps it alive as well
+  std::shared_ptr<const JobDesc> job_desc;
+  std::shared_ptr<const Kernel> kernel;
+  KernelConf kernel_conf;
+  std::vector<std::pair<std::string, BlobDesc>> bn_in_op2blob_desc;
+};
+
+// LRU cache of eager op inference results. Every call of an op with the same conf, input blob
+// descs and placement skips the op inference. User op kernels are not modified after construction
+// and their op kernel states live in the OpKernelObjects, so those calls share a single kernel.
+// Legacy kernels of system ops keep mutable state of their own, e.g. whether ConstantLikeKernel
+// has filled its output, so only their kernel conf is shared.
+class EagerKernelCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(EagerKernelCache);
+  explicit EagerKernelCache(size_t capacity);
+  ~EagerKernelCache();
+
+  // Returns nullptr on a miss. A capacity of 0 disables the cache.
+  std::shared_ptr<const EagerKernelCacheValue> Find(const std::string& key);
+  // Returns the value cached under `key`, which is not `value` if another thread inserted the
+  // same key after our Find.
+  std::shared_ptr<const EagerKernelCacheValue> Insert(
+      const std::string& key, const std::shared_ptr<const EagerKernelCacheValue>& value);
+  // Evicts the least recently used values above the new capacity
+  void SetCapacity(size_t capacity);
+
+  size_t capacity() const;
+  size_t size() const;
+  int64_t hit_cnt() const { return hit_cnt_.load(std::memory_order_relaxed); }
+  int64_t miss_cnt() const { return miss_cnt_.load(std::memory_order_relaxed); }
+
+ private:
+  struct CachedValue {
+    std::string key;
+    std::shared_ptr<const EagerKernelCacheValue> value;
+  };
+  using ValueList = std::list<CachedValue>;
+
+  void EvictAboveCapacity();
+
+  mutable std::mutex mutex_;
+  size_t capacity_;
+  // most recently used first
+  ValueList value_list_;
+  HashMap<std::string, ValueList::iterator> key2value_it_;
+  std::atomic<int64_t> hit_cnt_;
+  std::atomic<int64_t> miss_cnt_;
+};
+
+// The part of the cache key that only depends on the op. Names that differ from call to call
+// without affecting the inference, such as the op name and the lbns of user ops, are left out.
+// It is computed once per OpKernelObject.
+std::string EagerKernelCacheOpKey(const Operator& op);
+
+// The part of the cache key that identifies the job desc and the device of a call. Kernels and
+// their states may hold device resources, so calls on different devices never share a kernel.
+std::string EagerKernelCachePlacementKey(const JobDesc& job_desc, const ParallelDesc& parallel_desc,
+                                         const ParallelContext& parallel_ctx);
+
+// Builds the cache key of a call from the op and placement keys, the op node signature and the
+// blob descs of the inputs.
+std::string EagerKernelCacheKey(
+    const std::string& op_key, const std::string& placement_key,
+    const OpNodeSignatureDesc& op_node_signature, const PbRpf<std::string>& input_bns,
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp);
+
+// Sets the blob descs of result_bns and returns the kernel of a call. Both come from `cache` when
+// an earlier call had the same key, otherwise InferAndNewKernel runs the op inference and builds
+// the kernel, and the result is cached. `cache` may be nullptr.
+Maybe<std::shared_ptr<const Kernel>> InferBlobDescsAndGetKernel(
+    EagerKernelCache* cache, const std::string& key, const std::shared_ptr<const JobDesc>& job_desc,
+    const std::vector<std::string>& result_bns,
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+    const std::function<Maybe<std::shared_ptr<const Kernel>>()>& InferAndNewKernel);
+
+// Like InferBlobDescsAndGetKernel, for the system ops: returns the kernel conf of a call, from
+// which the caller builds a kernel of its own.
+Maybe<KernelConf> InferBlobDescsAndGetKernelConf(
+    EagerKernelCache* cache, const std::string& key, const std::vector<std::string>& result_bns,
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+    const std::function<Maybe<KernelConf>()>& InferAndGenKernelConf);
+
+}  // namespace eager
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EAGER_EAGER_KERNEL_CACHE_H_
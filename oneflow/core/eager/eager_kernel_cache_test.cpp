@@ -0,0 +1,257 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/eager/eager_kernel_cache.h"
+#include "oneflow/core/eager/opkernel_object.h"
+#include "oneflow/core/kernel/kernel_context.h"
+#include "oneflow/core/register/blob.h"
+#include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/operator/op_node_signature_desc.h"
+
+namespace oneflow {
+namespace eager {
+namespace test {
+
+namespace {
+
+std::shared_ptr<const EagerKernelCacheValue> NewValue(int64_t elem_cnt) {
+  auto value = std::make_shared<EagerKernelCacheValue>();
+  value->bn_in_op2blob_desc.emplace_back("out_0", BlobDesc(Shape({elem_cnt}), DataType::kFloat));
+  return value;
+}
+
+Resource GetResource() {
+  Resource ret;
+  ret.set_machine_num(1);
+  ret.set_gpu_device_num(0);
+  ret.set_cpu_device_num(2);
+  return ret;
+}
+
+std::shared_ptr<ParallelDesc> NewParallelDesc(int64_t symbol_id, const std::string& device_tag,
+                                              const std::string& device_name) {
+  ParallelConf parallel_conf;
+  parallel_conf.set_device_tag(device_tag);
+  parallel_conf.add_device_name(device_name);
+  return CHECK_JUST(ParallelDesc::New(symbol_id, parallel_conf));
+}
+
+ParallelContext GetParallelContext(int64_t parallel_id, int64_t parallel_num) {
+  ParallelContext parallel_ctx;
+  parallel_ctx.set_parallel_id(parallel_id);
+  parallel_ctx.set_parallel_num(parallel_num);
+  return parallel_ctx;
+}
+
+}  // namespace
+
+TEST(EagerKernelCache, hit_and_miss) {
+  EagerKernelCache cache(2);
+  ASSERT_EQ(cache.Find("a"), nullptr);
+  const auto& value = NewValue(1);
+  ASSERT_EQ(cache.Insert("a", value), value);
+  ASSERT_EQ(cache.Find("a"), value);
+  // the first value inserted under a key wins
+  ASSERT_EQ(cache.Insert("a", NewValue(2)), value);
+  ASSERT_EQ(cache.Find("b"), nullptr);
+  ASSERT_EQ(cache.hit_cnt(), 1);
+  ASSERT_EQ(cache.miss_cnt(), 2);
+  ASSERT_EQ(cache.size(), 1);
+}
+
+TEST(EagerKernelCache, eviction) {
+  EagerKernelCache cache(2);
+  cache.Insert("a", NewValue(1));
+  cache.Insert("b", NewValue(2));
+  // "a" becomes the most recently used one, so "b" is evicted
+  ASSERT_NE(cache.Find("a"), nullptr);
+  cache.Insert("c", NewValue(3));
+  ASSERT_EQ(cache.size(), 2);
+  ASSERT_EQ(cache.Find("b"), nullptr);
+  ASSERT_NE(cache.Find("c"), nullptr);
+  ASSERT_NE(cache.Find("a"), nullptr);
+  cache.SetCapacity(1);
+  ASSERT_EQ(cache.size(), 1);
+  ASSERT_EQ(cache.Find("c"), nullptr);
+  ASSERT_NE(cache.Find("a"), nullptr);
+  cache.SetCapacity(0);
+  ASSERT_EQ(cache.size(), 0);
+  cache.Insert("a", NewValue(1));
+  ASSERT_EQ(cache.size(), 0);
+  ASSERT_EQ(cache.Find("a"), nullptr);
+}
+
+TEST(EagerKernelCache, different_device_miss) {
+  Global<ResourceDesc, ForSession>::New(GetResource());
+  {
+    const auto& job_desc = CHECK_JUST(JobDesc::New(1, JobConfigProto()));
+    const auto& cpu_0_1 = NewParallelDesc(1, "cpu", "0:0-1");
+    const auto& cpu_0 = NewParallelDesc(2, "cpu", "0:0");
+    const std::string& key0 =
+        EagerKernelCachePlacementKey(*job_desc, *cpu_0_1, GetParallelContext(0, 2));
+    ASSERT_EQ(key0, EagerKernelCachePlacementKey(*job_desc, *cpu_0_1, GetParallelContext(0, 2)));
+    ASSERT_NE(key0, EagerKernelCachePlacementKey(*job_desc, *cpu_0_1, GetParallelContext(1, 2)));
+    ASSERT_NE(key0, EagerKernelCachePlacementKey(*job_desc, *cpu_0, GetParallelContext(0, 1)));
+
+    EagerKernelCache cache(16);
+    BlobDesc out(DataType::kFloat);
+    auto BlobDesc4BnInOp = [&](const std::string& bn_in_op) -> BlobDesc* {
+      return bn_in_op == "out_0" ? &out : nullptr;
+    };
+    int64_t infer_cnt = 0;
+    auto InferAndNewKernel = [&]() -> Maybe<std::shared_ptr<const Kernel>> {
+      ++infer_cnt;
+      out.mut_shape() = Shape({infer_cnt});
+      return std::shared_ptr<const Kernel>();
+    };
+    auto Call = [&](const ParallelDesc& parallel_desc, int64_t parallel_id) {
+      const std::string& key = EagerKernelCachePlacementKey(
+          *job_desc, parallel_desc, GetParallelContext(parallel_id, parallel_desc.parallel_num()));
+      CHECK_JUST(InferBlobDescsAndGetKernel(&cache, key, job_desc, {"out_0"}, BlobDesc4BnInOp,
+                                            InferAndNewKernel));
+    };
+    Call(*cpu_0_1, 0);
+    Call(*cpu_0_1, 0);
+    ASSERT_EQ(infer_cnt, 1);
+    Call(*cpu_0_1, 1);
+    ASSERT_EQ(infer_cnt, 2);
+    Call(*cpu_0, 0);
+    ASSERT_EQ(infer_cnt, 3);
+    // a hit restores the blob descs inferred by the first call with the same key
+    Call(*cpu_0_1, 0);
+    ASSERT_EQ(infer_cnt, 3);
+    ASSERT_EQ(out.shape(), Shape({1}));
+  }
+  Global<ResourceDesc, ForSession>::Delete();
+}
+
+TEST(EagerKernelCache, skip_inference_on_hit) {
+  Global<ResourceDesc, ForSession>::New(GetResource());
+  {
+    const auto& job_desc = CHECK_JUST(JobDesc::New(1, JobConfigProto()));
+    const auto& parallel_desc = NewParallelDesc(1, "cpu", "0:0");
+    const std::string& placement_key =
+        EagerKernelCachePlacementKey(*job_desc, *parallel_desc, GetParallelContext(0, 1));
+    const OpNodeSignatureDesc op_node_signature(1, OpNodeSignature());
+    PbRpf<std::string> input_bns;
+    *input_bns.Add() = "in_0";
+
+    EagerKernelCache cache(16);
+    BlobDesc in(Shape({4}), DataType::kFloat);
+    BlobDesc out(DataType::kFloat);
+    auto BlobDesc4BnInOp = [&](const std::string& bn_in_op) -> BlobDesc* {
+      if (bn_in_op == "in_0") { return &in; }
+      if (bn_in_op == "out_0") { return &out; }
+      return nullptr;
+    };
+    int64_t infer_cnt = 0;
+    auto InferAndNewKernel = [&]() -> Maybe<std::shared_ptr<const Kernel>> {
+      ++infer_cnt;
+      out.mut_shape() = Shape({2 * in.shape().elem_cnt()});
+      out.set_data_type(in.data_type());
+      return std::shared_ptr<const Kernel>();
+    };
+    auto Call = [&]() {
+      const std::string& key = EagerKernelCacheKey("op", placement_key, op_node_signature,
+                                                   input_bns, BlobDesc4BnInOp);
+      CHECK_JUST(InferBlobDescsAndGetKernel(&cache, key, job_desc, {"out_0"}, BlobDesc4BnInOp,
+                                            InferAndNewKernel));
+    };
+    Call();
+    ASSERT_EQ(infer_cnt, 1);
+    out = BlobDesc(DataType::kInt8);
+    Call();
+    ASSERT_EQ(infer_cnt, 1);
+    ASSERT_EQ(out.shape(), Shape({8}));
+    ASSERT_EQ(out.data_type(), DataType::kFloat);
+    // changing the input shape or data type changes the key and runs the inference again
+    in.mut_shape() = Shape({3});
+    Call();
+    ASSERT_EQ(infer_cnt, 2);
+    ASSERT_EQ(out.shape(), Shape({6}));
+    in.set_data_type(DataType::kDouble);
+    Call();
+    ASSERT_EQ(infer_cnt, 3);
+    ASSERT_EQ(out.data_type(), DataType::kDouble);
+    in = BlobDesc(Shape({4}), DataType::kFloat);
+    Call();
+    ASSERT_EQ(infer_cnt, 3);
+    ASSERT_EQ(out.shape(), Shape({8}));
+  }
+  Global<ResourceDesc, ForSession>::Delete();
+}
+
+TEST(EagerKernelCache, system_op_kernels_not_shared) {
+  Global<ResourceDesc, ForSession>::New(GetResource());
+  Global<EagerKernelCache>::New(16);
+  {
+    const auto& job_desc = CHECK_JUST(JobDesc::New(1, JobConfigProto()));
+    const auto& parallel_desc = NewParallelDesc(1, "cpu", "0:0");
+    const ParallelContext parallel_ctx = GetParallelContext(0, 1);
+    const BlobDesc blob_desc(Shape({4}), DataType::kFloat);
+    OpNodeSignature signature;
+    auto* bn_in_op2blob_desc =
+        signature.mutable_logical_blob_desc_signature()->mutable_bn_in_op2blob_desc();
+    blob_desc.ToProto(&(*bn_in_op2blob_desc)["like"]);
+    blob_desc.ToProto(&(*bn_in_op2blob_desc)["out"]);
+    const OpNodeSignatureDesc op_node_signature(1, signature);
+    // ConstantLikeKernel only fills its output on the first call, so two ops sharing a kernel
+    // would leave the output of the second one unfilled
+    auto NewConstantLikeKernelObject = [&](const std::string& op_name) {
+      OperatorConf op_conf;
+      op_conf.set_name(op_name);
+      op_conf.set_device_tag("cpu");
+      auto* conf = op_conf.mutable_constant_like_conf();
+      conf->set_like("x/out");
+      conf->set_out("out");
+      conf->set_int_operand(7);
+      return std::make_shared<SystemOpKernelObject>(op_conf, job_desc, DeviceType::kCPU);
+    };
+    const auto& obj0 = NewConstantLikeKernelObject("constant_like_0");
+    const auto& obj1 = NewConstantLikeKernelObject("constant_like_1");
+    for (const auto& obj : {obj0, obj1}) {
+      BlobDesc like(blob_desc);
+      BlobDesc out(DataType::kFloat);
+      auto BlobDesc4BnInOp = [&](const std::string& bn_in_op) -> BlobDesc* {
+        if (bn_in_op == "like") { return &like; }
+        if (bn_in_op == "out") { return &out; }
+        return nullptr;
+      };
+      CHECK_JUST(obj->ResetKernel(op_node_signature, &parallel_ctx, BlobDesc4BnInOp,
+                                  parallel_desc.get()));
+      ASSERT_EQ(out.shape(), Shape({4}));
+      MemoryCase mem_case;
+      mem_case.mutable_host_mem();
+      const RtBlobDesc rt_blob_desc(out);
+      std::vector<char> header(rt_blob_desc.ByteSizeOfBlobHeader());
+      std::vector<float> body(4, 0);
+      Blob out_blob(mem_case, &rt_blob_desc, header.data(), reinterpret_cast<char*>(body.data()));
+      obj->kernel().SystemForwardDataContent(KernelCtx(), [&](const std::string& bn_in_op) {
+        return bn_in_op == "out" ? &out_blob : nullptr;
+      });
+      ASSERT_EQ(body, std::vector<float>(4, 7));
+    }
+    ASSERT_EQ(Global<EagerKernelCache>::Get()->hit_cnt(), 1);
+    ASSERT_NE(&obj0->kernel(), &obj1->kernel());
+  }
+  Global<EagerKernelCache>::Delete();
+  Global<ResourceDesc, ForSession>::Delete();
+}
+
+}  // namespace test
+}  // namespace eager
+}  // namespace oneflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/vm/vm_util.h"
 #include "oneflow/core/vm/instruction.pb.h"
 #include "oneflow/core/vm/instruction.cfg.h"
+#include "oneflow/core/vm/instruction_stream.h"
 #include "oneflow/core/vm/symbol_storage.h"
 #include "oneflow/core/vm/string_symbol.h"
 #include "oneflow/core/eager/eager_symbol.cfg.h"
@@ -63,12 +64,23 @@ Maybe<void> StorageAdd(const EagerSymbol& symbol) {
 
 }  // namespace
 
+Maybe<void> EagerOneflow::RunPhysicalInstruction(
+    const vm::InstructionStream& instruction_stream, const EagerSymbolList& eager_symbol_list) {
+  for (const auto& eager_symbol : eager_symbol_list.eager_symbol()) {
+    JUST(StorageAdd(eager_symbol));
+  }
+  return vm::Run(instruction_stream);
+}
+
 Maybe<void> EagerOneflow::RunPhysicalInstruction(
     const std::shared_ptr<const ClusterInstructionProto>& cluster_instruction) {
-  const vm::InstructionListProto& instruction_list_proto =
-      cluster_instruction->eager_instruction().instruction_list();
-  const EagerSymbolList& eager_symbol_list =
-      cluster_instruction->eager_instruction().eager_symbol_list();
+  const EagerInstruction& eager_instruction = cluster_instruction->eager_instruction();
+  if (eager_instruction.has_instruction_stream()) {
+    vm::InstructionStream instruction_stream{std::string(eager_instruction.instruction_stream())};
+    return RunPhysicalInstruction(instruction_stream, eager_instruction.eager_symbol_list());
+  }
+  const vm::InstructionListProto& instruction_list_proto = eager_instruction.instruction_list();
+  const EagerSymbolList& eager_symbol_list = eager_instruction.eager_symbol_list();
   for (const auto& eager_symbol : eager_symbol_list.eager_symbol()) {
     JUST(StorageAdd(eager_symbol));
   }
@@ -78,13 +90,12 @@ Maybe<void> EagerOneflow::RunPhysicalInstruction(
 Maybe<void> EagerOneflow::RunPhysicalInstruction(
     const std::shared_ptr<vm::cfg::InstructionListProto>& instruction_list_proto,
     const std::shared_ptr<eager::cfg::EagerSymbolList>& eager_symbol_list) {
-  auto cluster_instruction = std::make_shared<ClusterInstructionProto>();
-  instruction_list_proto->ToProto(
-      cluster_instruction->mutable_eager_instruction()->mutable_instruction_list());
-  eager_symbol_list->ToProto(
-      cluster_instruction->mutable_eager_instruction()->mutable_eager_symbol_list());
-  return RunPhysicalInstruction(
-      std::const_pointer_cast<const ClusterInstructionProto>(cluster_instruction));
+  // encoded straight from the cfg objects built by the InstructionsBuilder, without protobuf
+  vm::InstructionStream instruction_stream;
+  instruction_stream.Append(*instruction_list_proto);
+  EagerSymbolList eager_symbol_list_proto;
+  eager_symbol_list->ToProto(&eager_symbol_list_proto);
+  return RunPhysicalInstruction(instruction_stream, eager_symbol_list_proto);
 }
 
 Maybe<void> EagerOneflow::RunLogicalInstruction(
@@ -98,13 +109,15 @@ Maybe<void> EagerOneflow::RunLogicalInstruction(
 Maybe<void> EagerOneflow::RunLogicalInstruction(
     const std::shared_ptr<vm::cfg::InstructionListProto>& instruction_list_proto,
     const std::shared_ptr<eager::cfg::EagerSymbolList>& eager_symbol_list) {
+  vm::InstructionStream instruction_stream;
+  instruction_stream.Append(*instruction_list_proto);
   auto cluster_instruction = std::make_shared<ClusterInstructionProto>();
-  instruction_list_proto->ToProto(
-      cluster_instruction->mutable_eager_instruction()->mutable_instruction_list());
-  eager_symbol_list->ToProto(
-      cluster_instruction->mutable_eager_instruction()->mutable_eager_symbol_list());
-  return RunLogicalInstruction(
-      std::const_pointer_cast<const ClusterInstructionProto>(cluster_instruction));
+  EagerInstruction* eager_instruction = cluster_instruction->mutable_eager_instruction();
+  eager_instruction->set_instruction_stream(instruction_stream.buffer());
+  eager_symbol_list->ToProto(eager_instruction->mutable_eager_symbol_list());
+  CHECK(Global<MachineCtx>::Get()->IsThisMachineMaster());
+  ClusterInstruction::MasterSendEagerInstruction(*cluster_instruction);
+  return RunPhysicalInstruction(instruction_stream, eager_instruction->eager_symbol_list());
 }
 
 COMMAND(Global<EagerOneflow>::SetAllocated(new EagerOneflow()));
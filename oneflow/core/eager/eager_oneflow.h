@@ -29,6 +29,9 @@ namespace cfg {
 class InstructionListProto;
 
 }  // namespace cfg
+
+class InstructionStream;
+
 }  // namespace vm
 
 namespace eager {
@@ -56,6 +59,10 @@ class EagerOneflow final {
   Maybe<void> RunPhysicalInstruction(
       const std::shared_ptr<vm::cfg::InstructionListProto>& instruction_list_proto,
       const std::shared_ptr<eager::cfg::EagerSymbolList>& eager_symbol_list);
+
+ private:
+  Maybe<void> RunPhysicalInstruction(const vm::InstructionStream& instruction_stream,
+                                     const EagerSymbolList& eager_symbol_list);
 };
 
 }  // namespace eager
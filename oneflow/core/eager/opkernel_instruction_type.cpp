@@ -402,9 +402,8 @@ Maybe<void> OpKernelCompute(OpKernelObject* opkernel_obj, vm::Instruction* instr
       return !(bn_in_op == "tmp_buffer_0" && blob_object.blob_desc().shape() == empty_shape);
     };
     JUST(MakeBlob4BnInOp(instruction, args, &Blob4BnInOp, FilterOutBlob));
-    EagerKernel* eager_kernel = opkernel_obj->mut_kernel();
     const auto& old_state = opkernel_obj->opkernel_state();
-    new_state = eager_kernel->EagerForward(old_state, device_ctx, Blob4BnInOp);
+    new_state = opkernel_obj->kernel().EagerForward(old_state, device_ctx, Blob4BnInOp);
   }
   opkernel_obj->reset_opkernel_state(new_state);
   return Maybe<void>::Ok();
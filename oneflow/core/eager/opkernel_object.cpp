@@ -14,77 +14,92 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/eager/opkernel_object.h"
+#include "oneflow/core/eager/eager_kernel_cache.h"
 
 namespace oneflow {
 namespace eager {
 
-Maybe<void> OpKernelObject::ResetOpAndKernel(
-    const OpNodeSignatureDesc& op_node_signature, const ParallelContext* parallel_ctx,
-    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-    const ParallelDesc* parallel_desc) {
-  auto op = ConstructOp(op_conf_, device_type_, job_desc_.get());
-  std::unique_ptr<OpContext> op_ctx;
-  JUST(InferBlobDescs(*op, BlobDesc4BnInOp, &op_node_signature.sbp_signature(), parallel_ctx,
-                      &op_ctx));
-  NewPartialInitializedKernel(*op, BlobDesc4BnInOp, op_node_signature, parallel_ctx, op_ctx.get(),
-                              parallel_desc);
-  return Maybe<void>::Ok();
-}
+namespace {
 
-Maybe<void> OpKernelObject::InferBlobDescs(
-    const Operator& op, const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-    const SbpSignature* sbp_signature, const ParallelContext* parallel_ctx,
-    std::unique_ptr<OpContext>* op_ctx) {
-  JUST(op.InferBlobDescsIf(BlobDesc4BnInOp, parallel_ctx, sbp_signature,
-                           [op_ctx](OpContext* ctx) { op_ctx->reset(ctx); }));
-  return Maybe<void>::Ok();
+// The EagerKernelCache key of a call and the bns of the blob descs it infers, left empty without
+// a cache
+void GenEagerKernelCacheKey(const Operator& op, const std::string& op_cache_key,
+                            const JobDesc& job_desc, const OpNodeSignatureDesc& op_node_signature,
+                            const ParallelContext* parallel_ctx, const ParallelDesc* parallel_desc,
+                            const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+                            std::string* key, std::vector<std::string>* result_bns) {
+  if (Global<EagerKernelCache>::Get() == nullptr) { return; }
+  *key = EagerKernelCacheKey(
+      op_cache_key, EagerKernelCachePlacementKey(job_desc, *parallel_desc, *parallel_ctx),
+      op_node_signature, op.input_bns(), BlobDesc4BnInOp);
+  result_bns->insert(result_bns->end(), op.output_bns().begin(), op.output_bns().end());
+  result_bns->insert(result_bns->end(), op.tmp_bns().begin(), op.tmp_bns().end());
 }
 
-void OpKernelObject::NewPartialInitializedKernel(
-    const Operator& op, const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-    const OpNodeSignatureDesc& op_node_signature, const ParallelContext* parallel_ctx,
-    OpContext* op_ctx, const ParallelDesc* parallel_desc) {
+// Runs the op inference and generates the kernel conf of the call
+Maybe<KernelConf> InferBlobDescsAndGenKernelConf(
+    const Operator& op, const OpNodeSignatureDesc& op_node_signature,
+    const ParallelContext* parallel_ctx, const ParallelDesc* parallel_desc,
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp) {
+  std::unique_ptr<OpContext> op_ctx;
+  JUST(op.InferBlobDescsIf(BlobDesc4BnInOp, parallel_ctx, &op_node_signature.sbp_signature(),
+                           [&op_ctx](OpContext* ctx) { op_ctx.reset(ctx); }));
   KernelConf kernel_conf;
   auto LogicalBlobDesc4BnInOp = [&](const std::string& bn_in_op) -> const BlobDesc& {
     return CHECK_JUST(op_node_signature.LogicalBlobDesc4BnInOp(bn_in_op));
   };
-  op.GenKernelConf(BlobDesc4BnInOp, parallel_ctx, &kernel_conf, op_ctx, LogicalBlobDesc4BnInOp,
-                   parallel_desc);
-  kernel_.reset(new EagerKernel(job_desc_.get(), kernel_conf));
+  op.GenKernelConf(BlobDesc4BnInOp, parallel_ctx, &kernel_conf, op_ctx.get(),
+                   LogicalBlobDesc4BnInOp, parallel_desc);
+  return kernel_conf;
 }
 
-Maybe<void> SystemOpKernelObject::ResetKernel(
+}  // namespace
+
+Maybe<void> OpKernelObject::ResetOpAndKernel(
     const OpNodeSignatureDesc& op_node_signature, const ParallelContext* parallel_ctx,
     const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
     const ParallelDesc* parallel_desc) {
-  auto op = ConstructOp(op_conf_, device_type_, job_desc_.get());
-  std::unique_ptr<OpContext> op_ctx;
-  JUST(InferBlobDescs(*op, BlobDesc4BnInOp, &op_node_signature.sbp_signature(), parallel_ctx,
-                      &op_ctx));
-  ResetKernel(*op, BlobDesc4BnInOp, op_node_signature, parallel_ctx, op_ctx.get(), parallel_desc);
-  return Maybe<void>::Ok();
-}
-
-Maybe<void> SystemOpKernelObject::InferBlobDescs(
-    const Operator& op, const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-    const SbpSignature* sbp_signature, const ParallelContext* parallel_ctx,
-    std::unique_ptr<OpContext>* op_ctx) {
-  JUST(op.InferBlobDescsIf(BlobDesc4BnInOp, parallel_ctx, sbp_signature,
-                           [op_ctx](OpContext* ctx) { op_ctx->reset(ctx); }));
+  if (!op_) {
+    op_ = ConstructOp(op_conf_, device_type_, job_desc_.get());
+    op_cache_key_ = EagerKernelCacheOpKey(*op_);
+  }
+  std::string key;
+  std::vector<std::string> result_bns;
+  GenEagerKernelCacheKey(*op_, op_cache_key_, *job_desc_, op_node_signature, parallel_ctx,
+                         parallel_desc, BlobDesc4BnInOp, &key, &result_bns);
+  const auto& kernel = *JUST(InferBlobDescsAndGetKernel(
+      Global<EagerKernelCache>::Get(), key, job_desc_, result_bns, BlobDesc4BnInOp,
+      [&]() -> Maybe<std::shared_ptr<const Kernel>> {
+        const KernelConf kernel_conf = *JUST(InferBlobDescsAndGenKernelConf(
+            *op_, op_node_signature, parallel_ctx, parallel_desc, BlobDesc4BnInOp));
+        return std::shared_ptr<const Kernel>(
+            std::make_shared<const EagerKernel>(job_desc_.get(), kernel_conf));
+      }));
+  kernel_ = std::dynamic_pointer_cast<const EagerKernel>(kernel);
+  CHECK_OR_RETURN(kernel_);
   return Maybe<void>::Ok();
 }
 
-void SystemOpKernelObject::ResetKernel(
-    const Operator& op, const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+Maybe<void> SystemOpKernelObject::ResetKernel(
     const OpNodeSignatureDesc& op_node_signature, const ParallelContext* parallel_ctx,
-    OpContext* op_ctx, const ParallelDesc* parallel_desc) {
-  KernelConf kernel_conf;
-  auto LogicalBlobDesc4BnInOp = [&](const std::string& bn_in_op) -> const BlobDesc& {
-    return CHECK_JUST(op_node_signature.LogicalBlobDesc4BnInOp(bn_in_op));
-  };
-  op.GenKernelConf(BlobDesc4BnInOp, parallel_ctx, &kernel_conf, op_ctx, LogicalBlobDesc4BnInOp,
-                   parallel_desc);
+    const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
+    const ParallelDesc* parallel_desc) {
+  if (!op_) {
+    op_ = ConstructOp(op_conf_, device_type_, job_desc_.get());
+    op_cache_key_ = EagerKernelCacheOpKey(*op_);
+  }
+  std::string key;
+  std::vector<std::string> result_bns;
+  GenEagerKernelCacheKey(*op_, op_cache_key_, *job_desc_, op_node_signature, parallel_ctx,
+                         parallel_desc, BlobDesc4BnInOp, &key, &result_bns);
+  // the legacy kernel is built anew, only the op inference and the kernel conf are shared
+  const KernelConf kernel_conf = *JUST(InferBlobDescsAndGetKernelConf(
+      Global<EagerKernelCache>::Get(), key, result_bns, BlobDesc4BnInOp, [&]() {
+        return InferBlobDescsAndGenKernelConf(*op_, op_node_signature, parallel_ctx,
+                                              parallel_desc, BlobDesc4BnInOp);
+      }));
   kernel_ = ConstructKernel(job_desc_.get(), kernel_conf, nullptr);
+  return Maybe<void>::Ok();
 }
 
 }  // namespace eager
@@ -48,12 +48,14 @@ class OpKernelObject : public vm::Object {
   const JobDesc& job_desc() const { return *job_desc_; }
 
   const std::string& op_name() const { return op_conf_.name(); }
-  UserOpConf* mut_user_op_conf() { return op_conf_.mutable_user_conf(); }
+  UserOpConf* mut_user_op_conf() {
+    op_.reset();
+    return op_conf_.mutable_user_conf();
+  }
 
   const std::shared_ptr<user_op::OpKernelState>& opkernel_state() const { return opkernel_state_; }
 
   const EagerKernel& kernel() const { return *kernel_; }
-  EagerKernel* mut_kernel() { return kernel_.get(); }
   void reset_opkernel_state(const std::shared_ptr<user_op::OpKernelState>& opkernel_state) {
     opkernel_state_ = opkernel_state;
   }
@@ -64,19 +66,14 @@ class OpKernelObject : public vm::Object {
                                const ParallelDesc* parallel_desc);
 
  private:
-  Maybe<void> InferBlobDescs(const Operator& op,
-                             const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-                             const SbpSignature* sbp_signature, const ParallelContext* parallel_ctx,
-                             std::unique_ptr<OpContext>* op_ctx);
-  void NewPartialInitializedKernel(
-      const Operator& op, const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-      const OpNodeSignatureDesc& op_node_signature, const ParallelContext* parallel_ctx,
-      OpContext* op_ctx, const ParallelDesc* parallel_desc);
-
   OperatorConf op_conf_;
   std::shared_ptr<const JobDesc> job_desc_;
   DeviceType device_type_;
-  std::unique_ptr<EagerKernel> kernel_;
+  // constructed on the first call and reused by the later ones
+  std::shared_ptr<const Operator> op_;
+  std::string op_cache_key_;
+  // shared with other OpKernelObjects through the EagerKernelCache
+  std::shared_ptr<const EagerKernel> kernel_;
   std::shared_ptr<user_op::OpKernelState> opkernel_state_;
 };
 
@@ -102,20 +99,12 @@ class SystemOpKernelObject : public vm::Object {
                           const ParallelDesc* parallel_desc);
 
  private:
-  Maybe<void> InferBlobDescs(const Operator& op,
-                             const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-                             const SbpSignature* sbp_signature, const ParallelContext* parallel_ctx,
-                             std::unique_ptr<OpContext>* op_ctx);
-  void ResetKernel(const Operator& op,
-                   const std::function<BlobDesc*(const std::string&)>& BlobDesc4BnInOp,
-                   const OpNodeSignatureDesc& op_node_signature,
-                   const ParallelContext* parallel_ctx, OpContext* op_ctx,
-                   const ParallelDesc* parallel_desc);
-
   OperatorConf op_conf_;
   std::shared_ptr<const JobDesc> job_desc_;
   DeviceType device_type_;
-  std::unique_ptr<const Kernel> kernel_;
+  std::shared_ptr<const Operator> op_;
+  std::string op_cache_key_;
+  std::shared_ptr<const Kernel> kernel_;
 };
 
 }  // namespace eager
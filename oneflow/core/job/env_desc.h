@@ -30,6 +30,7 @@ class EnvDesc final {
   const Machine& machine(int32_t idx) const { return env_proto_.machine(idx); }
   int32_t ctrl_port() const { return env_proto_.ctrl_port(); }
   int32_t data_port() const { return env_proto_.data_port(); }
+  int32_t ctrl_tree_fanout() const { return env_proto_.ctrl_tree_fanout(); }
   int64_t GetMachineId(const std::string& addr) const;
 
  private:
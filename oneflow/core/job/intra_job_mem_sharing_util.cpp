@@ -18,8 +18,15 @@ limitations under the License.
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/common/shape.h"
 #include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/job/mem_packing_util.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/operator/operator.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/register/runtime_register_desc.h"
 #include "oneflow/core/thread/thread_pool.h"
+#include <map>
+#include <sstream>
 
 namespace oneflow {
 
@@ -27,6 +34,7 @@ enum MemAllocAlgoType {
   kMemSizeFirstAlgo = 0,
   kMutualExclusionFirstAlgo = 1,
   kTimeLineAlgo = 2,
+  kMemPackingAlgo = 3,
 };
 
 }  // namespace oneflow
@@ -565,6 +573,10 @@ void BfcAllocator::FreeRaw(int64_t offset, int64_t size) {
   MergeFreePieceAndCheckValid();
 }
 
+int64_t GetRegstSize(const RegstDescProto* regst) {
+  return RtRegstDesc(*regst).TotalMainByteSize4AllRegst();
+}
+
 void MemReusedAlgorithm_TimeLineAlgo(
     const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
     const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline, MemBlockResultInfo* result) {
@@ -573,10 +585,6 @@ void MemReusedAlgorithm_TimeLineAlgo(
   int64_t buffer_size = 1;
   BfcAllocator bfc_allocator(buffer_size);
 
-  auto GetRegstSize = [](const RegstDescProto* regst) -> int64_t {
-    return RtRegstDesc(*regst).TotalMainByteSize4AllRegst();
-  };
-
   CHECK_EQ(alloc_regsts_timeline.size(), free_regsts_timeline.size());
   for (int64_t i = 0; i < alloc_regsts_timeline.size(); ++i) {
     for (RegstDescProto* alloc_regst : alloc_regsts_timeline.at(i)) {
@@ -592,11 +600,73 @@ void MemReusedAlgorithm_TimeLineAlgo(
   result->mem_block_size = bfc_allocator.buffer_size();
 }
 
+// The peak of the total size of the regsts alive at the same time, no offsets take less memory.
+// The regsts alive at the first peak go to peak_regsts unless it is nullptr.
+int64_t PeakLiveBytes(const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+                      const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+                      std::vector<RegstDescProto*>* peak_regsts) {
+  HashSet<RegstDescProto*> live_regsts;
+  int64_t live_bytes = 0;
+  int64_t peak_bytes = 0;
+  CHECK_EQ(alloc_regsts_timeline.size(), free_regsts_timeline.size());
+  for (int64_t i = 0; i < alloc_regsts_timeline.size(); ++i) {
+    for (RegstDescProto* alloc_regst : alloc_regsts_timeline.at(i)) {
+      live_bytes += GetRegstSize(alloc_regst);
+      if (peak_regsts != nullptr) { live_regsts.insert(alloc_regst); }
+    }
+    if (live_bytes > peak_bytes) {
+      peak_bytes = live_bytes;
+      if (peak_regsts != nullptr) {
+        peak_regsts->assign(live_regsts.begin(), live_regsts.end());
+      }
+    }
+    for (RegstDescProto* free_regst : free_regsts_timeline.at(i)) {
+      live_bytes -= GetRegstSize(free_regst);
+      if (peak_regsts != nullptr) { live_regsts.erase(free_regst); }
+    }
+  }
+  return peak_bytes;
+}
+
+void MemReusedAlgorithm_MemPackingAlgo(
+    const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+    const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+    const HashMap<RegstDescProto*, HashSet<RegstDescProto*>>& regst2mutual_exclusion_regsts,
+    int64_t search_step_budget, MemBlockResultInfo* result) {
+  std::vector<RegstDescProto*> regsts;
+  for (const auto& pair : regst2mutual_exclusion_regsts) { regsts.push_back(pair.first); }
+  // the packing depends on the order of the regsts, which must not depend on their addresses
+  std::sort(regsts.begin(), regsts.end(), [](RegstDescProto* lhs, RegstDescProto* rhs) {
+    return lhs->regst_desc_id() < rhs->regst_desc_id();
+  });
+  HashMap<RegstDescProto*, int64_t> regst2index;
+  for (int64_t i = 0; i < regsts.size(); ++i) {
+    CHECK(regst2index.emplace(regsts.at(i), i).second);
+  }
+  std::vector<int64_t> sizes(regsts.size());
+  std::vector<std::vector<int64_t>> conflicts(regsts.size());
+  for (int64_t i = 0; i < regsts.size(); ++i) {
+    sizes.at(i) = GetRegstSize(regsts.at(i));
+    for (RegstDescProto* mutual_regst : regst2mutual_exclusion_regsts.at(regsts.at(i))) {
+      conflicts.at(i).push_back(regst2index.at(mutual_regst));
+    }
+    std::sort(conflicts.at(i).begin(), conflicts.at(i).end());
+  }
+  std::vector<int64_t> offsets;
+  result->mem_block_size =
+      PlanMemPacking(sizes, conflicts, PeakLiveBytes(alloc_regsts_timeline, free_regsts_timeline,
+                                                     nullptr),
+                     search_step_budget, &offsets);
+  for (int64_t i = 0; i < regsts.size(); ++i) {
+    CHECK(result->regst_desc2offset.emplace(regsts.at(i), offsets.at(i)).second);
+  }
+}
+
 void SelectAlgorithmGenMemBlockOffset4Regsts(
     MemAllocAlgoType algo_id, const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
     const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
     const HashMap<RegstDescProto*, HashSet<RegstDescProto*>>& regst2mutual_exclusion_regsts,
-    MemBlockResultInfo* result) {
+    int64_t mem_packing_search_step_budget, MemBlockResultInfo* result) {
   CHECK_EQ(result->mem_block_size, 0);
   CHECK(result->regst_desc2offset.empty());
   switch (algo_id) {
@@ -609,6 +679,11 @@ void SelectAlgorithmGenMemBlockOffset4Regsts(
     case kTimeLineAlgo:
       MemReusedAlgorithm_TimeLineAlgo(alloc_regsts_timeline, free_regsts_timeline, result);
       break;
+    case kMemPackingAlgo:
+      MemReusedAlgorithm_MemPackingAlgo(alloc_regsts_timeline, free_regsts_timeline,
+                                        regst2mutual_exclusion_regsts,
+                                        mem_packing_search_step_budget, result);
+      break;
     default: UNIMPLEMENTED();
   }
   CHECK_GT(result->mem_block_size, 0);
@@ -622,6 +697,7 @@ int64_t CountMemAllocAlgoNum() {
   if (mem_alloc_algo_conf.use_mem_size_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_mutual_exclusion_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_time_line_algo()) { ++ret; }
+  if (mem_alloc_algo_conf.use_mem_packing_algo()) { ++ret; }
   CHECK_GE(ret, 0);
   return ret;
 }
@@ -639,6 +715,73 @@ void InitAlgo2Result(HashMap<MemAllocAlgoType, MemBlockResultInfo>* algo2result)
   if (mem_alloc_algo_conf.use_time_line_algo()) {
     CHECK(algo2result->emplace(kTimeLineAlgo, MemBlockResultInfo()).second);
   }
+  if (mem_alloc_algo_conf.use_mem_packing_algo()) {
+    CHECK(algo2result->emplace(kMemPackingAlgo, MemBlockResultInfo()).second);
+  }
+}
+
+const char* MemAllocAlgoName(MemAllocAlgoType algo_id) {
+  switch (algo_id) {
+    case kMemSizeFirstAlgo: return "mem_size_first";
+    case kMutualExclusionFirstAlgo: return "mutual_exclusion_first";
+    case kTimeLineAlgo: return "time_line";
+    case kMemPackingAlgo: return "mem_packing";
+    default: UNIMPLEMENTED();
+  }
+  return "";
+}
+
+// The peak live bytes of a mem chain, the bytes each algorithm plans for it and the largest regsts
+// alive at the peak
+std::string GenMemChainReport(
+    int64_t mem_chain_id, const std::vector<TaskProto*>& sorted_tasks,
+    const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+    const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+    const HashMap<MemAllocAlgoType, MemBlockResultInfo>& algo2result,
+    MemAllocAlgoType best_algo_id) {
+  const int64_t top_regst_num = 10;
+  std::vector<RegstDescProto*> peak_regsts;
+  const int64_t peak_bytes =
+      PeakLiveBytes(alloc_regsts_timeline, free_regsts_timeline, &peak_regsts);
+  const int64_t planned_bytes = algo2result.at(best_algo_id).mem_block_size;
+  HashMap<int64_t, const TaskProto*> task_id2task;
+  for (const TaskProto* task : sorted_tasks) { task_id2task.emplace(task->task_id(), task); }
+  const TaskProto* first_task = sorted_tasks.front();
+  std::stringstream ss;
+  ss << "mem chain " << mem_chain_id << " on machine " << first_task->machine_id() << " device "
+     << Global<IDMgr>::Get()->GetGpuPhyIdFromThrdId(first_task->thrd_id()) << ", "
+     << algo2result.at(best_algo_id).regst_desc2offset.size() << " regsts\n";
+  ss << "  peak live bytes: " << peak_bytes << "\n";
+  ss << "  planned bytes: " << planned_bytes << " (+"
+     << (peak_bytes > 0 ? 100.0 * (planned_bytes - peak_bytes) / peak_bytes : 0.0) << "%) by "
+     << MemAllocAlgoName(best_algo_id) << "\n";
+  std::vector<MemAllocAlgoType> algo_ids;
+  for (const auto& pair : algo2result) { algo_ids.push_back(pair.first); }
+  std::sort(algo_ids.begin(), algo_ids.end());
+  for (MemAllocAlgoType algo_id : algo_ids) {
+    ss << "    " << MemAllocAlgoName(algo_id) << ": " << algo2result.at(algo_id).mem_block_size
+       << "\n";
+  }
+  std::sort(peak_regsts.begin(), peak_regsts.end(), [](RegstDescProto* lhs, RegstDescProto* rhs) {
+    const int64_t lhs_size = GetRegstSize(lhs);
+    const int64_t rhs_size = GetRegstSize(rhs);
+    if (lhs_size != rhs_size) { return lhs_size > rhs_size; }
+    return lhs->regst_desc_id() < rhs->regst_desc_id();
+  });
+  ss << "  largest regsts alive at the peak:\n";
+  for (int64_t i = 0; i < std::min<int64_t>(top_regst_num, peak_regsts.size()); ++i) {
+    const RegstDescProto* regst = peak_regsts.at(i);
+    const TaskProto* producer = task_id2task.at(regst->producer_task_id());
+    std::string name =
+        producer->exec_sequence().exec_node(0).kernel_conf().op_attribute().op_conf().name();
+    const DataRegstDesc& data_regst_desc = regst->regst_desc_type().data_regst_desc();
+    if (data_regst_desc.lbi2blob_desc_size() > 0) {
+      name = GenLogicalBlobName(data_regst_desc.lbi2blob_desc(0).lbi());
+    }
+    ss << "    " << GetRegstSize(regst) << " bytes: " << name << " (regst "
+       << regst->regst_desc_id() << ")\n";
+  }
+  return ss.str();
 }
 
 }  // namespace
@@ -674,6 +817,10 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(Plan* plan,
 
   // step 2: multi-thread run several algorithm for each mem chain
   HashMap<int64_t, HashMap<MemAllocAlgoType, MemBlockResultInfo>> mem_chain2algo2result;
+  const int64_t mem_packing_search_step_budget = GlobalJobDesc()
+                                                     .job_conf()
+                                                     .memory_allocation_algorithm_conf()
+                                                     .mem_packing_algo_search_step_budget();
   {
     int64_t work_size = mem_chain2mem_reused_regsts.size() * CountMemAllocAlgoNum();
     int64_t thread_pool_size = std::min<int64_t>(work_size, std::thread::hardware_concurrency());
@@ -686,11 +833,12 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(Plan* plan,
         MemBlockResultInfo* result = &pair.second;
         thread_pool.AddWork([algo_id, mem_chain_id, &mem_chain2task2alloc_regsts,
                              &mem_chain2task2free_regsts, &mem_chain2regst2mutual_exclusion_regsts,
-                             result, &counter]() {
+                             mem_packing_search_step_budget, result, &counter]() {
           SelectAlgorithmGenMemBlockOffset4Regsts(
               algo_id, mem_chain2task2alloc_regsts.at(mem_chain_id),
               mem_chain2task2free_regsts.at(mem_chain_id),
-              mem_chain2regst2mutual_exclusion_regsts.at(mem_chain_id), result);
+              mem_chain2regst2mutual_exclusion_regsts.at(mem_chain_id),
+              mem_packing_search_step_budget, result);
           counter.Decrease();
         });
       }
@@ -699,14 +847,25 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(Plan* plan,
   }
 
   // step 3: choose best one for each mem chain and set offset for inplace consumer regst
+  const bool enable_mem_report = Global<ResourceDesc, ForSession>::Get()->enable_debug_mode();
+  std::map<int64_t, std::string> mem_chain2report;
   for (const auto& pair : mem_chain2algo2result) {
     const MemBlockResultInfo* best_result = nullptr;
+    MemAllocAlgoType best_algo_id = kMemSizeFirstAlgo;
     for (const auto& algo_result_pair : pair.second) {
       if (!best_result || algo_result_pair.second.mem_block_size < best_result->mem_block_size) {
         best_result = &algo_result_pair.second;
+        best_algo_id = algo_result_pair.first;
       }
     }
     CHECK(best_result != nullptr);
+    if (enable_mem_report) {
+      mem_chain2report.emplace(
+          pair.first, GenMemChainReport(pair.first, mem_chain2sorted_tasks.at(pair.first),
+                                        mem_chain2task2alloc_regsts.at(pair.first),
+                                        mem_chain2task2free_regsts.at(pair.first), pair.second,
+                                        best_algo_id));
+    }
     int64_t mem_block_id = Global<IDMgr>::Get()->NewMemBlockId();
     CHECK_EQ(mem_chain2mem_reused_regsts.at(pair.first).size(),
              (best_result->regst_desc2offset.size()
@@ -728,6 +887,12 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(Plan* plan,
       consumer_regst_desc->set_mem_block_offset(inplaced_regst_desc->mem_block_offset());
     }
   }
+  if (enable_mem_report) {
+    auto report_stream =
+        TeePersistentLogStream::Create(StrCat("mem_report_job", GlobalJobDesc().job_id()));
+    for (const auto& pair : mem_chain2report) { report_stream << pair.second; }
+    report_stream->Flush();
+  }
 }
 
 }  // namespace oneflow
@@ -0,0 +1,221 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/mem_packing_util.h"
+#include <numeric>
+#include <random>
+
+namespace oneflow {
+
+namespace {
+
+// Up to this many blocks are packed by the exhaustive search over the placement orders
+constexpr int64_t kMaxExactPackingBlockNum = 10;
+
+class MemPacker final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MemPacker);
+  MemPacker(const std::vector<int64_t>& sizes, const std::vector<std::vector<int64_t>>& conflicts,
+            int64_t lower_bound, int64_t search_step_budget)
+      : sizes_(sizes),
+        conflicts_(conflicts),
+        lower_bound_(lower_bound),
+        search_step_budget_(search_step_budget),
+        search_step_num_(0),
+        offsets_(sizes.size(), -1),
+        best_size_(GetMaxVal<int64_t>()) {}
+  ~MemPacker() = default;
+
+  int64_t Pack(std::vector<int64_t>* offsets);
+
+ private:
+  // The lowest offset, or with best_fit the offset of the smallest gap, where block fits between
+  // the placed blocks in conflict with it
+  int64_t FindOffset(int64_t block, bool best_fit);
+  // Places the blocks of order[begin, end) one after the other, returns the highest end of them
+  int64_t PlaceInOrder(const std::vector<int64_t>& order, int64_t begin, int64_t end,
+                       bool best_fit);
+  void TryUpdateBest(int64_t mem_block_size);
+  bool Done();
+  void ExactSearch(int64_t placed_num, int64_t mem_block_size);
+  void LocalSearch(std::vector<int64_t>* order);
+
+  const std::vector<int64_t>& sizes_;
+  const std::vector<std::vector<int64_t>>& conflicts_;
+  const int64_t lower_bound_;
+  const int64_t search_step_budget_;
+  int64_t search_step_num_;
+  // -1 for the blocks not placed yet
+  std::vector<int64_t> offsets_;
+  std::vector<std::pair<int64_t, int64_t>> ranges_;
+  int64_t best_size_;
+  std::vector<int64_t> best_offsets_;
+};
+
+int64_t MemPacker::FindOffset(int64_t block, bool best_fit) {
+  search_step_num_ += 1 + conflicts_.at(block).size();
+  const int64_t size = sizes_.at(block);
+  ranges_.clear();
+  for (int64_t other : conflicts_.at(block)) {
+    const int64_t offset = offsets_.at(other);
+    if (offset != -1) { ranges_.emplace_back(offset, offset + sizes_.at(other)); }
+  }
+  std::sort(ranges_.begin(), ranges_.end());
+  int64_t best_offset = -1;
+  int64_t best_gap = GetMaxVal<int64_t>();
+  int64_t free_begin = 0;
+  for (const auto& range : ranges_) {
+    const int64_t gap = range.first - free_begin;
+    if (gap >= size) {
+      if (!best_fit) { return free_begin; }
+      if (gap < best_gap) {
+        best_offset = free_begin;
+        best_gap = gap;
+      }
+    }
+    free_begin = std::max(free_begin, range.second);
+  }
+  return best_offset == -1 ? free_begin : best_offset;
+}
+
+int64_t MemPacker::PlaceInOrder(const std::vector<int64_t>& order, int64_t begin, int64_t end,
+                                bool best_fit) {
+  int64_t mem_block_size = 0;
+  FOR_RANGE(int64_t, i, begin, end) {
+    const int64_t block = order.at(i);
+    offsets_.at(block) = FindOffset(block, best_fit);
+    mem_block_size = std::max(mem_block_size, offsets_.at(block) + sizes_.at(block));
+  }
+  return mem_block_size;
+}
+
+void MemPacker::TryUpdateBest(int64_t mem_block_size) {
+  if (mem_block_size < best_size_) {
+    best_size_ = mem_block_size;
+    best_offsets_ = offsets_;
+  }
+}
+
+bool MemPacker::Done() {
+  return best_size_ <= lower_bound_ || search_step_num_ >= search_step_budget_;
+}
+
+// Placing every block at the lowest offset where it fits, in the order of the offsets of an
+// optimal packing, gives a packing as good as that one, so the search over all the orders is
+// exact when it finishes within the budget
+void MemPacker::ExactSearch(int64_t placed_num, int64_t mem_block_size) {
+  if (placed_num == static_cast<int64_t>(sizes_.size())) {
+    TryUpdateBest(mem_block_size);
+    return;
+  }
+  FOR_RANGE(int64_t, block, 0, sizes_.size()) {
+    if (Done()) { return; }
+    if (offsets_.at(block) != -1) { continue; }
+    const int64_t offset = FindOffset(block, false);
+    const int64_t new_mem_block_size = std::max(mem_block_size, offset + sizes_.at(block));
+    if (new_mem_block_size >= best_size_) { continue; }
+    offsets_.at(block) = offset;
+    ExactSearch(placed_num + 1, new_mem_block_size);
+    offsets_.at(block) = -1;
+  }
+}
+
+// Swaps two blocks of the placement order and places again from the first changed position on,
+// keeping the swap unless the packing grows. One block of the swap is often one at the top of
+// the packing, which has to move for the packing to shrink.
+void MemPacker::LocalSearch(std::vector<int64_t>* order) {
+  const int64_t num = order->size();
+  std::mt19937 gen(num);
+  // prefix_sizes[i] is the highest end of the blocks of order[0, i)
+  std::vector<int64_t> prefix_sizes(num + 1, 0);
+  offsets_.assign(num, -1);
+  FOR_RANGE(int64_t, i, 0, num) {
+    prefix_sizes.at(i + 1) = std::max(prefix_sizes.at(i), PlaceInOrder(*order, i, i + 1, false));
+  }
+  TryUpdateBest(prefix_sizes.at(num));
+  std::vector<int64_t> saved_offsets;
+  std::vector<int64_t> saved_prefix_sizes;
+  while (!Done()) {
+    const int64_t mem_block_size = prefix_sizes.at(num);
+    int64_t j = std::uniform_int_distribution<int64_t>(1, num - 1)(gen);
+    if (gen() % 2 == 0) {
+      // the last block of the order at the top of the packing
+      for (int64_t k = num - 1; k > 0; --k) {
+        const int64_t block = order->at(k);
+        if (offsets_.at(block) + sizes_.at(block) == mem_block_size) {
+          j = k;
+          break;
+        }
+      }
+    }
+    const int64_t i = std::uniform_int_distribution<int64_t>(0, j - 1)(gen);
+    saved_offsets.assign(offsets_.begin(), offsets_.end());
+    saved_prefix_sizes.assign(prefix_sizes.begin() + i + 1, prefix_sizes.end());
+    std::swap(order->at(i), order->at(j));
+    FOR_RANGE(int64_t, k, i, num) { offsets_.at(order->at(k)) = -1; }
+    FOR_RANGE(int64_t, k, i, num) {
+      prefix_sizes.at(k + 1) =
+          std::max(prefix_sizes.at(k), PlaceInOrder(*order, k, k + 1, false));
+    }
+    if (prefix_sizes.at(num) <= mem_block_size) {
+      TryUpdateBest(prefix_sizes.at(num));
+    } else {
+      std::swap(order->at(i), order->at(j));
+      offsets_.swap(saved_offsets);
+      std::copy(saved_prefix_sizes.begin(), saved_prefix_sizes.end(), prefix_sizes.begin() + i + 1);
+    }
+  }
+}
+
+int64_t MemPacker::Pack(std::vector<int64_t>* offsets) {
+  const int64_t num = sizes_.size();
+  std::vector<int64_t> order(num);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int64_t lhs, int64_t rhs) {
+    if (sizes_.at(lhs) != sizes_.at(rhs)) { return sizes_.at(lhs) > sizes_.at(rhs); }
+    if (conflicts_.at(lhs).size() != conflicts_.at(rhs).size()) {
+      return conflicts_.at(lhs).size() > conflicts_.at(rhs).size();
+    }
+    return lhs < rhs;
+  });
+  for (bool best_fit : {true, false}) {
+    offsets_.assign(num, -1);
+    TryUpdateBest(PlaceInOrder(order, 0, num, best_fit));
+  }
+  if (num <= kMaxExactPackingBlockNum) {
+    offsets_.assign(num, -1);
+    ExactSearch(0, 0);
+  } else {
+    LocalSearch(&order);
+  }
+  *offsets = best_offsets_;
+  return best_size_;
+}
+
+}  // namespace
+
+int64_t PlanMemPacking(const std::vector<int64_t>& sizes,
+                       const std::vector<std::vector<int64_t>>& conflicts, int64_t lower_bound,
+                       int64_t search_step_budget, std::vector<int64_t>* offsets) {
+  CHECK_EQ(sizes.size(), conflicts.size());
+  CHECK(!sizes.empty());
+  for (int64_t size : sizes) { CHECK_GE(size, 0); }
+  MemPacker packer(sizes, conflicts, lower_bound, search_step_budget);
+  const int64_t mem_block_size = packer.Pack(offsets);
+  CHECK_GE(mem_block_size, lower_bound);
+  return mem_block_size;
+}
+
+}  // namespace oneflow
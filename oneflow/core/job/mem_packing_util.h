@@ -0,0 +1,39 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_MEM_PACKING_UTIL_H_
+#define ONEFLOW_CORE_JOB_MEM_PACKING_UTIL_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// Places blocks of the given sizes in one memory block, such that two blocks alive at the same
+// time never overlap, i.e. packs the (lifetime x size) rectangles of the blocks into a strip of
+// the lowest height. conflicts[i] lists the blocks alive at the same time as block i, and
+// lower_bound is the peak of the total size of the blocks alive at the same time.
+//
+// A greedy by size best-fit packing is refined by an exhaustive search over the placement orders
+// for a few blocks, or a local search over the placement order otherwise, until the packing
+// reaches lower_bound or the search runs out of search_step_budget. Placing a block costs one
+// step plus one per block in conflict with it, so the result does not depend on the machine.
+// Returns the size of the memory block.
+int64_t PlanMemPacking(const std::vector<int64_t>& sizes,
+                       const std::vector<std::vector<int64_t>>& conflicts, int64_t lower_bound,
+                       int64_t search_step_budget, std::vector<int64_t>* offsets);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_MEM_PACKING_UTIL_H_
@@ -0,0 +1,144 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/mem_packing_util.h"
+#include <iostream>
+#include <numeric>
+#include <random>
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// blocks alive in [begins[i], ends[i]] of a timeline
+struct MemPackingCase {
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> begins;
+  std::vector<int64_t> ends;
+  std::vector<std::vector<int64_t>> conflicts;
+  int64_t lower_bound;
+};
+
+MemPackingCase GenMemPackingCase(int64_t num, int64_t time_num, int64_t max_lifetime,
+                                 uint32_t seed) {
+  std::mt19937 gen(seed);
+  MemPackingCase c;
+  FOR_RANGE(int64_t, i, 0, num) {
+    // a few large blocks and many small ones
+    c.sizes.push_back(gen() % 4 == 0 ? 1024 * (1 + gen() % 64) : 64 * (1 + gen() % 64));
+    c.begins.push_back(gen() % time_num);
+    c.ends.push_back(std::min<int64_t>(time_num - 1, c.begins.back() + gen() % max_lifetime));
+  }
+  c.conflicts.resize(num);
+  FOR_RANGE(int64_t, i, 0, num) {
+    FOR_RANGE(int64_t, j, 0, num) {
+      if (i != j && c.begins.at(i) <= c.ends.at(j) && c.begins.at(j) <= c.ends.at(i)) {
+        c.conflicts.at(i).push_back(j);
+      }
+    }
+  }
+  c.lower_bound = 0;
+  FOR_RANGE(int64_t, t, 0, time_num) {
+    int64_t live = 0;
+    FOR_RANGE(int64_t, i, 0, num) {
+      if (c.begins.at(i) <= t && t <= c.ends.at(i)) { live += c.sizes.at(i); }
+    }
+    c.lower_bound = std::max(c.lower_bound, live);
+  }
+  return c;
+}
+
+void CheckPacking(const MemPackingCase& c, int64_t mem_block_size,
+                  const std::vector<int64_t>& offsets) {
+  ASSERT_EQ(offsets.size(), c.sizes.size());
+  ASSERT_GE(mem_block_size, c.lower_bound);
+  FOR_RANGE(size_t, i, 0, c.sizes.size()) {
+    ASSERT_GE(offsets.at(i), 0);
+    ASSERT_LE(offsets.at(i) + c.sizes.at(i), mem_block_size);
+    for (int64_t j : c.conflicts.at(i)) {
+      ASSERT_TRUE(offsets.at(i) + c.sizes.at(i) <= offsets.at(j)
+                  || offsets.at(j) + c.sizes.at(j) <= offsets.at(i));
+    }
+  }
+}
+
+// the lowest packing placing the blocks at their lowest offsets in any order
+int64_t BruteForceMemPacking(const MemPackingCase& c) {
+  std::vector<int64_t> order(c.sizes.size());
+  std::iota(order.begin(), order.end(), 0);
+  int64_t best = GetMaxVal<int64_t>();
+  do {
+    std::vector<int64_t> offsets(order.size(), -1);
+    int64_t mem_block_size = 0;
+    for (int64_t block : order) {
+      std::vector<std::pair<int64_t, int64_t>> ranges;
+      for (int64_t other : c.conflicts.at(block)) {
+        if (offsets.at(other) != -1) {
+          ranges.emplace_back(offsets.at(other), offsets.at(other) + c.sizes.at(other));
+        }
+      }
+      std::sort(ranges.begin(), ranges.end());
+      int64_t offset = 0;
+      for (const auto& range : ranges) {
+        if (range.first - offset >= c.sizes.at(block)) { break; }
+        offset = std::max(offset, range.second);
+      }
+      offsets.at(block) = offset;
+      mem_block_size = std::max(mem_block_size, offset + c.sizes.at(block));
+    }
+    best = std::min(best, mem_block_size);
+  } while (std::next_permutation(order.begin(), order.end()));
+  return best;
+}
+
+}  // namespace
+
+TEST(MemPacking, exact) {
+  FOR_RANGE(uint32_t, seed, 0, 20) {
+    const MemPackingCase c = GenMemPackingCase(7, 8, 4, seed);
+    std::vector<int64_t> offsets;
+    const int64_t mem_block_size =
+        PlanMemPacking(c.sizes, c.conflicts, c.lower_bound, GetMaxVal<int64_t>(), &offsets);
+    CheckPacking(c, mem_block_size, offsets);
+    ASSERT_EQ(mem_block_size, BruteForceMemPacking(c));
+  }
+}
+
+TEST(MemPacking, large) {
+  const MemPackingCase c = GenMemPackingCase(300, 60, 20, 0);
+  std::vector<int64_t> quick_offsets;
+  const int64_t quick_size =
+      PlanMemPacking(c.sizes, c.conflicts, c.lower_bound, 0, &quick_offsets);
+  CheckPacking(c, quick_size, quick_offsets);
+  const int64_t budget = 300000;
+  std::vector<int64_t> offsets;
+  const int64_t mem_block_size =
+      PlanMemPacking(c.sizes, c.conflicts, c.lower_bound, budget, &offsets);
+  CheckPacking(c, mem_block_size, offsets);
+  ASSERT_LE(mem_block_size, quick_size);
+  // the same budget gives the same packing
+  std::vector<int64_t> same_offsets;
+  ASSERT_EQ(PlanMemPacking(c.sizes, c.conflicts, c.lower_bound, budget, &same_offsets),
+            mem_block_size);
+  ASSERT_EQ(same_offsets, offsets);
+  std::cout << "300 blocks, peak live bytes " << c.lower_bound << ", quick packing " << quick_size
+            << ", refined packing " << mem_block_size << std::endl;
+}
+
+}  // namespace test
+
+}  // namespace oneflow
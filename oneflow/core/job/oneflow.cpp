@@ -41,6 +41,9 @@ limitations under the License.
 #include "oneflow/core/graph/plan_task_graph.h"
 #include "oneflow/core/graph/boxing/collective_boxing_util.h"
 #include "oneflow/core/profiler/profiler.h"
+#include "oneflow/core/job/plan_cache.h"
+#include "oneflow/core/job/plan_distribution.h"
+#include "oneflow/core/profiler/metrics.h"
 
 namespace std {
 
@@ -85,6 +88,10 @@ std::string block7chunk_key(const std::string& plan_name, int64_t machine_id) {
 }
 
 void PushPlan(const std::string& plan_name, const Plan& plan) {
+  if (Global<ResourceDesc, ForSession>::Get()->enable_compact_plan_distribution()) {
+    PushCompactPlan(plan_name, plan);
+    return;
+  }
   HashMap<int64_t, std::set<int64_t>> machine_id2thrd_id_set;
   HashMap<std::pair<int64_t, int64_t>, std::vector<TaskProto>> mchn_thrd_id2task_protos;
   HashMap<int64_t, MemBlockAndChunkList> machine_id2block7chunk;
@@ -103,13 +110,17 @@ void PushPlan(const std::string& plan_name, const Plan& plan) {
 
   ClusterThrdIds cluster_thrd_ids;
   *(cluster_thrd_ids.mutable_machine_id2thrd_ids()) = HashMap2PbMap(machine_id2thrd_ids);
-  Global<CtrlClient>::Get()->PushKV(cluster_thrd_ids_key(plan_name), cluster_thrd_ids);
+  const int64_t machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
+  Global<CtrlClient>::Get()->PushBroadcastKV(cluster_thrd_ids_key(plan_name), machine_num,
+                                             cluster_thrd_ids);
 
+  std::vector<std::string> keys;
+  std::vector<std::string> vals;
   for (const auto& pair : mchn_thrd_id2task_protos) {
     SubPlan sub_plan;
     *(sub_plan.mutable_task()) = StdVec2PbRpf(pair.second);
-    Global<CtrlClient>::Get()->PushKV(sub_plan_key(plan_name, pair.first.first, pair.first.second),
-                                      sub_plan);
+    keys.push_back(sub_plan_key(plan_name, pair.first.first, pair.first.second));
+    vals.emplace_back(sub_plan.SerializeAsString());
   }
 
   for (const auto& mem_block : plan.block_chunk_list().mem_block()) {
@@ -119,18 +130,28 @@ void PushPlan(const std::string& plan_name, const Plan& plan) {
     *machine_id2block7chunk[chunk.machine_id()].add_chunk() = chunk;
   }
   for (const auto& pair : machine_id2block7chunk) {
-    Global<CtrlClient>::Get()->PushKV(block7chunk_key(plan_name, pair.first), pair.second);
+    keys.push_back(block7chunk_key(plan_name, pair.first));
+    vals.emplace_back(pair.second.SerializeAsString());
   }
-
-  Global<CtrlClient>::Get()->PushKV(net_topo_key(plan_name), plan.net_topo());
-  Global<CtrlClient>::Get()->PushKV(job_id2job_conf(plan_name), plan.job_confs());
-  Global<CtrlClient>::Get()->PushKV(GetCollectiveBoxingPlanKey(plan_name),
-                                    plan.collective_boxing_plan());
+  Global<CtrlClient>::Get()->PushKVs(keys, vals);
+
+  Global<CtrlClient>::Get()->PushBroadcastKV(net_topo_key(plan_name), machine_num,
+                                             plan.net_topo());
+  Global<CtrlClient>::Get()->PushBroadcastKV(job_id2job_conf(plan_name), machine_num,
+                                             plan.job_confs());
+  Global<CtrlClient>::Get()->PushBroadcastKV(GetCollectiveBoxingPlanKey(plan_name), machine_num,
+                                             plan.collective_boxing_plan());
 }
 
 void PullPlan(const std::string& plan_name, Plan* plan) {
+  if (Global<ResourceDesc, ForSession>::Get()->enable_compact_plan_distribution()) {
+    PullCompactPlan(plan_name, plan);
+    return;
+  }
+  const int64_t machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
   ClusterThrdIds cluster_thrd_ids;
-  Global<CtrlClient>::Get()->PullKV(cluster_thrd_ids_key(plan_name), &cluster_thrd_ids);
+  Global<CtrlClient>::Get()->PullBroadcastKV(cluster_thrd_ids_key(plan_name), machine_num,
+                                             &cluster_thrd_ids);
   PrintProtoToTextFile(cluster_thrd_ids, JoinPath(FLAGS_log_dir, cluster_thrd_ids_key(plan_name)));
   HashMap<int64_t, ThrdIds> machine_id2thrd_ids;
   machine_id2thrd_ids = PbMap2HashMap(cluster_thrd_ids.machine_id2thrd_ids());
@@ -138,21 +159,29 @@ void PullPlan(const std::string& plan_name, Plan* plan) {
   auto thrd_ids_it = machine_id2thrd_ids.find(machine_id);
   CHECK(thrd_ids_it != machine_id2thrd_ids.end());
   std::vector<int64_t> thrd_id_vec = PbRf2StdVec(thrd_ids_it->second.thrd_id());
-  for (auto thrd_id : thrd_id_vec) {
-    SubPlan sub_plan;
-    Global<CtrlClient>::Get()->PullKV(sub_plan_key(plan_name, machine_id, thrd_id), &sub_plan);
-    plan->mutable_task()->MergeFrom(sub_plan.task());
-  }
+  std::vector<std::string> keys;
+  for (auto thrd_id : thrd_id_vec) { keys.push_back(sub_plan_key(plan_name, machine_id, thrd_id)); }
+  keys.push_back(block7chunk_key(plan_name, machine_id));
+  // the sub plans are pulled while the broadcast values are relayed down the ctrl tree
+  std::vector<std::string> vals;
+  Global<CtrlClient>::Get()->AsyncPullKVs(
+      keys, [&](const std::vector<std::string>& pulled_vals) { vals = pulled_vals; });
   NetTopo net_topo;
-  Global<CtrlClient>::Get()->PullKV(net_topo_key(plan_name), &net_topo);
+  Global<CtrlClient>::Get()->PullBroadcastKV(net_topo_key(plan_name), machine_num, &net_topo);
   *(plan->mutable_net_topo()) = net_topo;
   JobConfs job_confs;
-  Global<CtrlClient>::Get()->PullKV(job_id2job_conf(plan_name), &job_confs);
+  Global<CtrlClient>::Get()->PullBroadcastKV(job_id2job_conf(plan_name), machine_num, &job_confs);
   *(plan->mutable_job_confs()) = job_confs;
-  Global<CtrlClient>::Get()->PullKV(GetCollectiveBoxingPlanKey(plan_name),
-                                    plan->mutable_collective_boxing_plan());
+  Global<CtrlClient>::Get()->PullBroadcastKV(GetCollectiveBoxingPlanKey(plan_name), machine_num,
+                                             plan->mutable_collective_boxing_plan());
+  Global<CtrlClient>::Get()->WaitAsyncKVs();
+  FOR_RANGE(size_t, i, 0, thrd_id_vec.size()) {
+    SubPlan sub_plan;
+    CHECK(sub_plan.ParseFromString(vals.at(i)));
+    plan->mutable_task()->MergeFrom(sub_plan.task());
+  }
   MemBlockAndChunkList block7chunk;
-  Global<CtrlClient>::Get()->PullKV(block7chunk_key(plan_name, machine_id), &block7chunk);
+  CHECK(block7chunk.ParseFromString(vals.back()));
   plan->mutable_block_chunk_list()->CopyFrom(block7chunk);
 }
 
@@ -948,12 +977,14 @@ Maybe<void> CompileAndMergePlanOnMaster(const PbRpf<Job>& conf_jobs, Plan* plan)
       jobs.emplace_back(pull_job);
     }
   }
+  double compile_start = GetCurTime();
   std::vector<Plan> sub_plans(jobs.size());
   FOR_RANGE(int64_t, i, 0, jobs.size()) {
     AddJobName2JobId(jobs.at(i)->job_conf().job_name(), i);
     auto scope = std::make_unique<GlobalJobDescScope>(jobs.at(i)->job_conf(), i);
     JUST(CompileCurJobOnMaster(jobs.at(i).get(), &sub_plans.at(i), true));
   }
+  LOG(INFO) << "compile " << jobs.size() << " jobs, time: " << GetCurTime() - compile_start;
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()) {
     MergeSubPlanWithoutGenNetTopo(plan, sub_plans);
     InterJobMemSharingUtil::MergeMemReusedChunkBetweenUserJobs(function_jobs, plan);
@@ -986,13 +1017,59 @@ Maybe<void> CompileAndMergePlanOnMaster(const PbRpf<Job>& conf_jobs, Plan* plan)
   return Maybe<void>::Ok();
 }
 
+const std::string kPlanCacheHitKey = "plan_cache_hit";
+
+// The master looks the plan up and tells the workers whether it hit, so that on a hit nobody
+// compiles and the workers only pull the merged plan, and on a miss all of them compile as usual.
+bool TryLoadCachedPlan(const PlanCache* plan_cache, Plan* plan) {
+  bool hit = false;
+  if (Global<MachineCtx>::Get()->IsThisMachineMaster()) {
+    double start = GetCurTime();
+    hit = plan_cache->TryLoad(plan);
+    if (hit) {
+      LOG(INFO) << "plan cache hit: " << plan_cache->path()
+                << ", load time: " << GetCurTime() - start;
+    } else {
+      LOG(INFO) << "plan cache miss: " << plan_cache->path();
+    }
+    Global<CtrlClient>::Get()->PushKV(kPlanCacheHitKey, hit ? "1" : "0");
+  } else {
+    std::string hit_str;
+    Global<CtrlClient>::Get()->PullKV(kPlanCacheHitKey, &hit_str);
+    hit = hit_str == "1";
+  }
+  if (!hit) { return false; }
+  if (Global<MachineCtx>::Get()->IsThisMachineMaster()) {
+    if (Global<ResourceDesc, ForSession>::Get()->enable_debug_mode()) {
+      TeePersistentLogStream::Create("merged_plan")->Write(*plan);
+    }
+    PushPlan("merged_plan", *plan);
+  } else {
+    PullPlan("merged_plan", plan);
+  }
+  OF_SESSION_BARRIER();
+  return true;
+}
+
 }  // namespace
 
 Maybe<void> Oneflow::Init(const oneflow::JobSet& job_set) {
   OF_PROFILER_RANGE_GUARD("Oneflow::Init");
   // Runtime
   OF_PROFILER_RANGE_PUSH("CompileAndMergePlanOnMaster");
-  JUST(CompileAndMergePlanOnMaster(job_set.job(), &plan_));
+  std::unique_ptr<PlanCache> plan_cache;
+  const std::string& plan_cache_dir = Global<ResourceDesc, ForSession>::Get()->plan_cache_dir();
+  const bool use_plan_cache = !plan_cache_dir.empty();
+  if (use_plan_cache && Global<MachineCtx>::Get()->IsThisMachineMaster()) {
+    plan_cache.reset(new PlanCache(plan_cache_dir, job_set));
+  }
+  const bool plan_cache_hit = use_plan_cache && TryLoadCachedPlan(plan_cache.get(), &plan_);
+  if (!plan_cache_hit) {
+    JUST(CompileAndMergePlanOnMaster(job_set.job(), &plan_));
+    if (plan_cache) { plan_cache->Store(plan_); }
+  }
+  // every worker has read the flag before the last session barrier of either path
+  if (plan_cache) { Global<CtrlClient>::Get()->ClearKV(kPlanCacheHitKey); }
   OF_PROFILER_RANGE_POP();  // CompileAndMergePlanOnMaster
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()) {
     runtime_buffers_scope_.reset(new RuntimeBuffersScope(plan_));
@@ -1000,6 +1077,12 @@ Maybe<void> Oneflow::Init(const oneflow::JobSet& job_set) {
   OF_PROFILER_RANGE_PUSH("new Runtime");
   runtime_.reset(new Runtime(plan_, GetMaxVal<size_t>(), false));
   OF_PROFILER_RANGE_POP();  // new Runtime
+  if (plan_cache && Global<profiler::MetricsRegistry>::Get() != nullptr) {
+    Global<profiler::MetricsRegistry>::Get()
+        ->MutCounter("plan_cache_lookup_cnt",
+                     profiler::MetricsLabel("result", plan_cache_hit ? "hit" : "miss"))
+        ->Add(1);
+  }
   return Maybe<void>::Ok();
 }
 
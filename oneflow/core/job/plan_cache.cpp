@@ -0,0 +1,152 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/plan_cache.h"
+#include "oneflow/core/job/plan_cache.pb.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/common/data_type.h"
+#include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/available_memory_desc.pb.h"
+#include "oneflow/core/job/inter_user_job_info.pb.h"
+#include "oneflow/core/job/version.h"
+#include "oneflow/core/persistence/file_system.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace oneflow {
+
+namespace {
+
+void AppendDeterministicSerialized(const PbMessage& msg, std::string* out) {
+  const std::string serialized = PbMessage2DeterministicBinString(msg);
+  out->append(std::to_string(serialized.size()));
+  out->append(":");
+  out->append(serialized);
+}
+
+// Identifies the build of the library holding this code, which is rewritten whenever any of its
+// translation units is rebuilt. Empty when the library can not be found.
+std::string BuildFingerprint() {
+  Dl_info dl_info;
+  if (dladdr(reinterpret_cast<void*>(&BuildFingerprint), &dl_info) == 0
+      || dl_info.dli_fname == nullptr) {
+    return "";
+  }
+  struct stat lib_stat;
+  if (stat(dl_info.dli_fname, &lib_stat) != 0) { return ""; }
+  std::string fingerprint = std::string(dl_info.dli_fname) + " " + std::to_string(lib_stat.st_size)
+                            + " " + std::to_string(lib_stat.st_mtim.tv_sec) + "."
+                            + std::to_string(lib_stat.st_mtim.tv_nsec);
+#ifdef WITH_GIT_VERSION
+  fingerprint += std::string(" ") + GetOneFlowGitVersion();
+#endif  // WITH_GIT_VERSION
+  return fingerprint;
+}
+
+std::string MakeFingerprint(const std::string& build_fingerprint, const JobSet& job_set) {
+  std::string fingerprint = build_fingerprint + "\n";
+  Resource resource = Global<ResourceDesc, ForSession>::Get()->resource();
+  // options that do not change the compiled plan
+  resource.clear_plan_cache_dir();
+  resource.clear_actor_construction_thread_pool_size();
+  resource.clear_enable_async_vm_schedule();
+  resource.clear_eager_kernel_cache_size();
+  AppendDeterministicSerialized(resource, &fingerprint);
+  AppendDeterministicSerialized(*Global<const IOConf>::Get(), &fingerprint);
+  AppendDeterministicSerialized(*Global<AvailableMemDesc>::Get(), &fingerprint);
+  AppendDeterministicSerialized(job_set, &fingerprint);
+  return fingerprint;
+}
+
+std::string ToHexString(uint64_t val) {
+  static const char* kDigits = "0123456789abcdef";
+  std::string ret(16, '0');
+  FOR_RANGE(int32_t, i, 0, 16) { ret[15 - i] = kDigits[(val >> (i * 4)) & 0xF]; }
+  return ret;
+}
+
+}  // namespace
+
+PlanCache::PlanCache(const std::string& cache_dir, const JobSet& job_set) {
+  const std::string build_fingerprint = BuildFingerprint();
+  if (build_fingerprint.empty()) {
+    LOG(WARNING) << "plan cache disabled, the build of OneFlow can not be identified";
+    return;
+  }
+  fingerprint_ = MakeFingerprint(build_fingerprint, job_set);
+  path_ = JoinPath(cache_dir, "plan_" + ToHexString(std::hash<std::string>()(fingerprint_)));
+}
+
+bool PlanCache::TryLoad(Plan* plan) const {
+  if (!enabled()) { return false; }
+  std::ifstream in_stream(path_, std::ios::in | std::ios::binary);
+  if (!in_stream.is_open()) { return false; }
+  PlanCacheEntry entry;
+  {
+    google::protobuf::io::IstreamInputStream istream_input(&in_stream);
+    google::protobuf::io::CodedInputStream coded_input(&istream_input);
+    // merged plans easily exceed the default 64MB limit
+    coded_input.SetTotalBytesLimit(GetMaxVal<int32_t>());
+    if (!entry.ParsePartialFromCodedStream(&coded_input) || !entry.has_fingerprint()
+        || !entry.has_plan()) {
+      LOG(WARNING) << "ignore corrupted plan cache " << path_;
+      return false;
+    }
+  }
+  if (entry.fingerprint() != fingerprint_) {
+    LOG(WARNING) << "ignore plan cache " << path_ << " whose fingerprint does not match";
+    return false;
+  }
+  auto* job_name2job_id = Global<JobName2JobId>::Get();
+  CHECK(job_name2job_id->empty());
+  for (const auto& pair : entry.job_name2job_id()) {
+    CHECK(job_name2job_id->emplace(pair.first, pair.second).second);
+  }
+  Global<InterUserJobInfo>::Get()->CopyFrom(entry.inter_user_job_info());
+  plan->Swap(entry.mutable_plan());
+  return true;
+}
+
+void PlanCache::Store(const Plan& plan) const {
+  if (!enabled()) { return; }
+  PlanCacheEntry entry;
+  entry.set_fingerprint(fingerprint_);
+  *entry.mutable_plan() = plan;
+  for (const auto& pair : *Global<JobName2JobId>::Get()) {
+    (*entry.mutable_job_name2job_id())[pair.first] = pair.second;
+  }
+  *entry.mutable_inter_user_job_info() = *Global<InterUserJobInfo>::Get();
+  LocalFS()->RecursivelyCreateDirIfNotExist(Dirname(path_));
+  // write to a temporary file first so that a concurrently starting process never loads a
+  // partially written entry
+  const std::string tmp_path = path_ + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream out_stream(tmp_path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!out_stream.is_open() || !entry.SerializePartialToOstream(&out_stream)) {
+      LOG(WARNING) << "failed to write plan cache " << tmp_path;
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+    LOG(WARNING) << "failed to rename plan cache " << tmp_path << " to " << path_;
+  }
+}
+
+}  // namespace oneflow
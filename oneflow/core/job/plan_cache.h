@@ -0,0 +1,49 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_PLAN_CACHE_H_
+#define ONEFLOW_CORE_JOB_PLAN_CACHE_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/job_set.pb.h"
+#include "oneflow/core/job/plan.pb.h"
+
+namespace oneflow {
+
+// On-disk cache of merged plans. An entry is keyed by the serialized JobSet, the session
+// resource, io conf and available memory of the cluster, and the build of the OneFlow library
+// (its path, size and modification time), so any change of them misses the cache. The cache is
+// disabled when the library can not be identified. Besides the plan, an entry keeps the session
+// globals that compiling the plan fills (JobName2JobId and InterUserJobInfo) and restores them
+// on a hit.
+class PlanCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(PlanCache);
+  PlanCache(const std::string& cache_dir, const JobSet& job_set);
+  ~PlanCache() = default;
+
+  bool TryLoad(Plan* plan) const;
+  void Store(const Plan& plan) const;
+  bool enabled() const { return !fingerprint_.empty(); }
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string fingerprint_;
+  std::string path_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_PLAN_CACHE_H_
@@ -0,0 +1,252 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/plan_distribution.h"
+#include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/control/ctrl_client.h"
+#include "oneflow/core/job/machine_context.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include <zlib.h>
+
+namespace oneflow {
+
+namespace {
+
+const size_t kPayloadChunkSize = 8 * 1024 * 1024;
+
+std::string compact_meta_key(const std::string& plan_name, int64_t machine_id) {
+  return plan_name + "_compact_" + std::to_string(machine_id) + "_meta";
+}
+
+std::string compact_sub_plan_key(const std::string& plan_name, int64_t machine_id,
+                                 int64_t thrd_id) {
+  return plan_name + "_compact_" + std::to_string(machine_id) + "_" + std::to_string(thrd_id);
+}
+
+std::string compact_op_attribute_list_key(const std::string& plan_name, int64_t machine_id) {
+  return plan_name + "_compact_" + std::to_string(machine_id) + "_op_attribute_list";
+}
+
+std::string compact_block7chunk_key(const std::string& plan_name, int64_t machine_id) {
+  return plan_name + "_compact_" + std::to_string(machine_id) + "_block7chunk";
+}
+
+std::string compact_net_topo_key(const std::string& plan_name) {
+  return plan_name + "_compact_net_topo";
+}
+
+std::string compact_job_confs_key(const std::string& plan_name) {
+  return plan_name + "_compact_job_confs";
+}
+
+std::string compact_collective_boxing_plan_key(const std::string& plan_name) {
+  return plan_name + "_compact_collective_boxing_plan";
+}
+
+std::string chunk_key(const std::string& payload_key, int64_t chunk_idx) {
+  return payload_key + "_" + std::to_string(chunk_idx);
+}
+
+void PushPayload(const std::string& key, const PbMessage& msg, CompressedPayloadMeta* meta) {
+  std::vector<std::string> chunks;
+  CompressToChunks(PbMessage2DeterministicBinString(msg), kPayloadChunkSize, meta, &chunks);
+  std::vector<std::string> keys;
+  FOR_RANGE(int64_t, i, 0, chunks.size()) { keys.push_back(chunk_key(key, i)); }
+  Global<CtrlClient>::Get()->PushKVs(keys, chunks);
+}
+
+void PullPayload(const std::string& key, const CompressedPayloadMeta& meta, PbMessage* msg) {
+  std::vector<std::string> keys;
+  FOR_RANGE(int64_t, i, 0, meta.chunk_num()) { keys.push_back(chunk_key(key, i)); }
+  std::vector<std::string> chunks;
+  Global<CtrlClient>::Get()->PullKVs(keys, &chunks);
+  std::string raw;
+  DecompressFromChunks(meta, chunks, &raw);
+  CHECK(msg->ParsePartialFromString(raw));
+}
+
+int64_t DistributionThreadPoolSize(int64_t work_num) {
+  return std::max<int64_t>(
+      std::min<int64_t>(work_num, std::thread::hardware_concurrency()), int64_t(1));
+}
+
+void PushCompactMachinePlan(const std::string& plan_name, int64_t machine_id,
+                            const std::vector<const TaskProto*>& tasks,
+                            const MemBlockAndChunkList& block7chunk) {
+  HashMap<int64_t, CompactSubPlan> thrd_id2sub_plan;
+  OpAttributeList op_attribute_list;
+  EncodeCompactSubPlans(tasks, &thrd_id2sub_plan, &op_attribute_list);
+  CompactMachinePlanMeta meta;
+  PushPayload(compact_op_attribute_list_key(plan_name, machine_id), op_attribute_list,
+              meta.mutable_op_attribute_list());
+  PushPayload(compact_block7chunk_key(plan_name, machine_id), block7chunk,
+              meta.mutable_block7chunk());
+  for (const auto& pair : thrd_id2sub_plan) {
+    PushPayload(compact_sub_plan_key(plan_name, machine_id, pair.first), pair.second,
+                &(*meta.mutable_thrd_id2sub_plan())[pair.first]);
+  }
+  // workers block on the meta, so it goes last
+  Global<CtrlClient>::Get()->PushKV(compact_meta_key(plan_name, machine_id), meta);
+}
+
+}  // namespace
+
+void CompressToChunks(const std::string& raw, size_t chunk_size, CompressedPayloadMeta* meta,
+                      std::vector<std::string>* chunks) {
+  CHECK_GT(chunk_size, 0);
+  uLongf compressed_size = compressBound(raw.size());
+  std::string compressed(compressed_size, '\0');
+  CHECK_EQ(compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+                     reinterpret_cast<const Bytef*>(raw.data()), raw.size(), Z_BEST_SPEED),
+           Z_OK);
+  compressed.resize(compressed_size);
+  chunks->clear();
+  for (size_t offset = 0; offset < compressed.size(); offset += chunk_size) {
+    chunks->emplace_back(compressed.substr(offset, chunk_size));
+  }
+  meta->set_raw_size(raw.size());
+  meta->set_chunk_num(chunks->size());
+}
+
+void DecompressFromChunks(const CompressedPayloadMeta& meta, const std::vector<std::string>& chunks,
+                          std::string* raw) {
+  CHECK_EQ(chunks.size(), meta.chunk_num());
+  std::string compressed;
+  for (const std::string& chunk : chunks) { compressed.append(chunk); }
+  raw->resize(meta.raw_size());
+  uLongf raw_size = meta.raw_size();
+  CHECK_EQ(uncompress(reinterpret_cast<Bytef*>(&(*raw)[0]), &raw_size,
+                      reinterpret_cast<const Bytef*>(compressed.data()), compressed.size()),
+           Z_OK);
+  CHECK_EQ(raw_size, meta.raw_size());
+}
+
+void EncodeCompactSubPlans(const std::vector<const TaskProto*>& tasks,
+                           HashMap<int64_t, CompactSubPlan>* thrd_id2sub_plan,
+                           OpAttributeList* op_attribute_list) {
+  HashMap<std::string, int64_t> serialized2op_attribute_id;
+  for (const TaskProto* task : tasks) {
+    CompactSubPlan* sub_plan = &(*thrd_id2sub_plan)[task->thrd_id()];
+    TaskProto* compact_task = sub_plan->mutable_task()->Add();
+    *compact_task = *task;
+    for (auto& exec_node : *compact_task->mutable_exec_sequence()->mutable_exec_node()) {
+      OpAttribute* op_attribute = exec_node.mutable_kernel_conf()->mutable_op_attribute();
+      const std::string serialized = PbMessage2DeterministicBinString(*op_attribute);
+      auto it = serialized2op_attribute_id.find(serialized);
+      if (it == serialized2op_attribute_id.end()) {
+        it = serialized2op_attribute_id.emplace(serialized, op_attribute_list->op_attribute_size())
+                 .first;
+        op_attribute_list->mutable_op_attribute()->Add()->Swap(op_attribute);
+      }
+      op_attribute->Clear();
+      sub_plan->add_op_attribute_id(it->second);
+    }
+  }
+}
+
+void DecodeCompactSubPlan(const OpAttributeList& op_attribute_list, CompactSubPlan* sub_plan) {
+  int64_t exec_node_idx = 0;
+  for (TaskProto& task : *sub_plan->mutable_task()) {
+    for (auto& exec_node : *task.mutable_exec_sequence()->mutable_exec_node()) {
+      *exec_node.mutable_kernel_conf()->mutable_op_attribute() =
+          op_attribute_list.op_attribute(sub_plan->op_attribute_id(exec_node_idx));
+      exec_node_idx += 1;
+    }
+  }
+  CHECK_EQ(exec_node_idx, sub_plan->op_attribute_id_size());
+  sub_plan->clear_op_attribute_id();
+}
+
+void PushCompactPlan(const std::string& plan_name, const Plan& plan) {
+  HashMap<int64_t, std::vector<const TaskProto*>> machine_id2tasks;
+  HashMap<int64_t, MemBlockAndChunkList> machine_id2block7chunk;
+  for (const auto& task : plan.task()) { machine_id2tasks[task.machine_id()].push_back(&task); }
+  for (const auto& mem_block : plan.block_chunk_list().mem_block()) {
+    *machine_id2block7chunk[mem_block.machine_id()].add_mem_block() = mem_block;
+  }
+  for (const auto& chunk : plan.block_chunk_list().chunk()) {
+    *machine_id2block7chunk[chunk.machine_id()].add_chunk() = chunk;
+  }
+  // the master keeps the whole plan, only the other machines pull
+  const int64_t machine_num = Global<ResourceDesc, ForSession>::Get()->TotalMachineNum();
+  std::vector<int64_t> worker_machine_ids;
+  FOR_RANGE(int64_t, machine_id, 0, machine_num) {
+    if (machine_id == Global<MachineCtx>::Get()->this_machine_id()) { continue; }
+    worker_machine_ids.push_back(machine_id);
+    machine_id2tasks[machine_id];
+    machine_id2block7chunk[machine_id];
+  }
+  {
+    BlockingCounter counter(worker_machine_ids.size());
+    ThreadPool thread_pool(DistributionThreadPoolSize(worker_machine_ids.size()));
+    for (int64_t machine_id : worker_machine_ids) {
+      thread_pool.AddWork([&, machine_id]() {
+        PushCompactMachinePlan(plan_name, machine_id, machine_id2tasks.at(machine_id),
+                               machine_id2block7chunk.at(machine_id));
+        counter.Decrease();
+      });
+    }
+    counter.WaitUntilCntEqualZero();
+  }
+  Global<CtrlClient>::Get()->PushKV(compact_net_topo_key(plan_name), plan.net_topo());
+  Global<CtrlClient>::Get()->PushKV(compact_job_confs_key(plan_name), plan.job_confs());
+  Global<CtrlClient>::Get()->PushKV(compact_collective_boxing_plan_key(plan_name),
+                                    plan.collective_boxing_plan());
+}
+
+void PullCompactPlan(const std::string& plan_name, Plan* plan) {
+  const int64_t machine_id = Global<MachineCtx>::Get()->this_machine_id();
+  CompactMachinePlanMeta meta;
+  Global<CtrlClient>::Get()->PullKV(compact_meta_key(plan_name, machine_id), &meta);
+  std::vector<int64_t> thrd_ids;
+  for (const auto& pair : meta.thrd_id2sub_plan()) { thrd_ids.push_back(pair.first); }
+  std::sort(thrd_ids.begin(), thrd_ids.end());
+  std::vector<CompactSubPlan> sub_plans(thrd_ids.size());
+  OpAttributeList op_attribute_list;
+  {
+    // sub plans are fetched and parsed concurrently, the OpAttributes they refer to are restored
+    // as soon as the shared list has arrived
+    BlockingCounter op_attribute_list_ready(1);
+    BlockingCounter counter(thrd_ids.size());
+    ThreadPool thread_pool(DistributionThreadPoolSize(thrd_ids.size()));
+    FOR_RANGE(int64_t, i, 0, thrd_ids.size()) {
+      thread_pool.AddWork([&, i]() {
+        PullPayload(compact_sub_plan_key(plan_name, machine_id, thrd_ids.at(i)),
+                    meta.thrd_id2sub_plan().at(thrd_ids.at(i)), &sub_plans.at(i));
+        op_attribute_list_ready.WaitUntilCntEqualZero();
+        DecodeCompactSubPlan(op_attribute_list, &sub_plans.at(i));
+        counter.Decrease();
+      });
+    }
+    PullPayload(compact_op_attribute_list_key(plan_name, machine_id), meta.op_attribute_list(),
+                &op_attribute_list);
+    op_attribute_list_ready.Decrease();
+    PullPayload(compact_block7chunk_key(plan_name, machine_id), meta.block7chunk(),
+                plan->mutable_block_chunk_list());
+    counter.WaitUntilCntEqualZero();
+  }
+  for (CompactSubPlan& sub_plan : sub_plans) {
+    for (TaskProto& task : *sub_plan.mutable_task()) { plan->mutable_task()->Add()->Swap(&task); }
+  }
+  Global<CtrlClient>::Get()->PullKV(compact_net_topo_key(plan_name), plan->mutable_net_topo());
+  Global<CtrlClient>::Get()->PullKV(compact_job_confs_key(plan_name), plan->mutable_job_confs());
+  Global<CtrlClient>::Get()->PullKV(compact_collective_boxing_plan_key(plan_name),
+                                    plan->mutable_collective_boxing_plan());
+}
+
+}  // namespace oneflow
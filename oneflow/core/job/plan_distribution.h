@@ -0,0 +1,44 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_PLAN_DISTRIBUTION_H_
+#define ONEFLOW_CORE_JOB_PLAN_DISTRIBUTION_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/plan.pb.h"
+#include "oneflow/core/job/sub_plan.pb.h"
+#include "oneflow/core/operator/op_attribute.pb.h"
+
+namespace oneflow {
+
+// Compact plan distribution. The master pushes, for every machine, one zlib compressed payload
+// per thread plus the machine's deduplicated OpAttributes and mem blocks, each split into chunks
+// so that they spread over all ctrl servers. Workers fetch and decode the payloads concurrently.
+void PushCompactPlan(const std::string& plan_name, const Plan& plan);
+void PullCompactPlan(const std::string& plan_name, Plan* plan);
+
+// building blocks, exposed for testing
+void CompressToChunks(const std::string& raw, size_t chunk_size, CompressedPayloadMeta* meta,
+                      std::vector<std::string>* chunks);
+void DecompressFromChunks(const CompressedPayloadMeta& meta, const std::vector<std::string>& chunks,
+                          std::string* raw);
+void EncodeCompactSubPlans(const std::vector<const TaskProto*>& tasks,
+                           HashMap<int64_t, CompactSubPlan>* thrd_id2sub_plan,
+                           OpAttributeList* op_attribute_list);
+void DecodeCompactSubPlan(const OpAttributeList& op_attribute_list, CompactSubPlan* sub_plan);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_PLAN_DISTRIBUTION_H_
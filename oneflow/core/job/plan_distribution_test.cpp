@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/plan_distribution.h"
+#include "oneflow/core/common/protobuf.h"
+
+namespace oneflow {
+
+namespace {
+
+TaskProto NewTask(int64_t task_id, int64_t thrd_id, const std::vector<std::string>& op_names) {
+  TaskProto task;
+  task.set_task_id(task_id);
+  task.set_thrd_id(thrd_id);
+  for (const std::string& op_name : op_names) {
+    KernelConf* kernel_conf = task.mutable_exec_sequence()->add_exec_node()->mutable_kernel_conf();
+    kernel_conf->mutable_op_attribute()->mutable_op_conf()->set_name(op_name);
+  }
+  return task;
+}
+
+}  // namespace
+
+TEST(PlanDistribution, compress_to_chunks) {
+  std::string raw;
+  FOR_RANGE(int32_t, i, 0, 100000) { raw += std::to_string(i % 97); }
+  CompressedPayloadMeta meta;
+  std::vector<std::string> chunks;
+  CompressToChunks(raw, 1024, &meta, &chunks);
+  ASSERT_EQ(meta.raw_size(), raw.size());
+  ASSERT_EQ(meta.chunk_num(), chunks.size());
+  ASSERT_GT(chunks.size(), 1);
+  for (const auto& chunk : chunks) { ASSERT_LE(chunk.size(), 1024); }
+  std::string decompressed;
+  DecompressFromChunks(meta, chunks, &decompressed);
+  ASSERT_EQ(decompressed, raw);
+}
+
+TEST(PlanDistribution, dedup_op_attribute) {
+  std::vector<TaskProto> tasks{NewTask(0, 0, {"a", "b"}), NewTask(1, 1, {"a"}),
+                               NewTask(2, 1, {"b", "c"})};
+  std::vector<const TaskProto*> task_ptrs;
+  for (const auto& task : tasks) { task_ptrs.push_back(&task); }
+  HashMap<int64_t, CompactSubPlan> thrd_id2sub_plan;
+  OpAttributeList op_attribute_list;
+  EncodeCompactSubPlans(task_ptrs, &thrd_id2sub_plan, &op_attribute_list);
+  ASSERT_EQ(op_attribute_list.op_attribute_size(), 3);
+  ASSERT_EQ(thrd_id2sub_plan.size(), 2);
+  ASSERT_EQ(thrd_id2sub_plan.at(1).task_size(), 2);
+  for (auto& pair : thrd_id2sub_plan) {
+    CompactSubPlan* sub_plan = &pair.second;
+    DecodeCompactSubPlan(op_attribute_list, sub_plan);
+    for (const TaskProto& task : sub_plan->task()) {
+      ASSERT_EQ(PbMessage2DeterministicBinString(task),
+                PbMessage2DeterministicBinString(tasks.at(task.task_id())));
+    }
+  }
+}
+
+}  // namespace oneflow
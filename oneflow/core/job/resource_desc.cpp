@@ -38,6 +38,20 @@ int32_t ResourceDesc::ComputeThreadPoolSize() const {
   }
 }
 
+int32_t ResourceDesc::ActorConstructionThreadPoolSize() const {
+  if (resource_.has_actor_construction_thread_pool_size()) {
+    CHECK_GT(resource_.actor_construction_thread_pool_size(), 0);
+    return resource_.actor_construction_thread_pool_size();
+  } else {
+    return std::max<int32_t>(std::thread::hardware_concurrency() / 2, 1);
+  }
+}
+
+int64_t ResourceDesc::EagerKernelCacheSize() const {
+  CHECK_GE(resource_.eager_kernel_cache_size(), 0);
+  return resource_.eager_kernel_cache_size();
+}
+
 bool ResourceDesc::enable_debug_mode() const {
   return std::getenv("ONEFLOW_DEBUG_MODE") != nullptr || resource_.enable_debug_mode();
 }
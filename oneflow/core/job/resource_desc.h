@@ -51,6 +51,12 @@ class ResourceDesc final {
   bool enable_thread_local_cache() const { return resource_.enable_thread_local_cache(); }
   size_t thread_local_cache_max_size() const { return resource_.thread_local_cache_max_size(); }
   int32_t ComputeThreadPoolSize() const;
+  int32_t ActorConstructionThreadPoolSize() const;
+  int64_t EagerKernelCacheSize() const;
+  const std::string& plan_cache_dir() const { return resource_.plan_cache_dir(); }
+  bool enable_compact_plan_distribution() const {
+    return resource_.enable_compact_plan_distribution();
+  }
   bool enable_debug_mode() const;
   CollectiveBoxingConf collective_boxing_conf() const;
 
@@ -31,6 +31,8 @@ limitations under the License.
 #include "oneflow/user/summary/events_writer.h"
 #include "oneflow/core/job/collective_boxing_executor.h"
 #include "oneflow/core/job/collective_boxing_device_ctx_poller.h"
+#include "oneflow/core/profiler/metrics.h"
+#include "oneflow/core/common/str_util.h"
 
 namespace oneflow {
 
@@ -58,10 +60,34 @@ bool HasNonCtrlConsumedRegstDescId(const TaskProto& task) {
   return false;
 }
 
+void NewMetricsRegistryIfNeed() {
+  const ProfilerConf& profiler_conf = *Global<const ProfilerConf>::Get();
+  if (!profiler_conf.collect_runtime_metrics()) { return; }
+  std::string dump_path;
+  if (profiler_conf.has_runtime_metrics_dump_path()) {
+    dump_path = profiler_conf.runtime_metrics_dump_path();
+  } else {
+    dump_path = JoinPath(FLAGS_log_dir, "runtime_metrics.txt");
+  }
+  Global<profiler::MetricsRegistry>::New(dump_path,
+                                         profiler_conf.runtime_metrics_dump_interval_ms());
+}
+
+void CollectStartupMetrics(const std::string& phase, double start_time) {
+  const int64_t elapsed_us = static_cast<int64_t>((GetCurTime() - start_time) / 1000);
+  LOG(INFO) << "runtime startup phase " << phase << " time: " << elapsed_us << "us";
+  auto* registry = Global<profiler::MetricsRegistry>::Get();
+  if (registry == nullptr) { return; }
+  registry->MutGauge("runtime_startup_time_us", profiler::MetricsLabel("phase", phase))
+      ->Set(elapsed_us);
+}
+
 }  // namespace
 
 Runtime::Runtime(const Plan& plan, size_t total_piece_num, bool is_experiment_phase) {
+  const double start_time = GetCurTime();
   NewAllGlobal(plan, total_piece_num, is_experiment_phase);
+  CollectStartupMetrics("new_all_global", start_time);
   std::vector<const TaskProto*> source_tasks;
   std::vector<const TaskProto*> other_tasks;
   int64_t this_machine_task_num = 0;
@@ -76,16 +102,19 @@ Runtime::Runtime(const Plan& plan, size_t total_piece_num, bool is_experiment_ph
   }
   RuntimeCtx* runtime_ctx = Global<RuntimeCtx>::Get();
   runtime_ctx->NewCounter("constructing_actor_cnt", this_machine_task_num);
+  const double construct_actor_start_time = GetCurTime();
   HandoutTasks(source_tasks);
   HandoutTasks(other_tasks);
   runtime_ctx->WaitUntilCntEqualZero("constructing_actor_cnt");
   LOG(INFO) << "Actors on this machine constructed";
+  CollectStartupMetrics("construct_actor", construct_actor_start_time);
   OF_SESSION_BARRIER();
   LOG(INFO) << "Actors on every machine constructed";
   if (Global<CommNet>::Get()) { Global<CommNet>::Get()->RegisterMemoryDone(); }
   OF_SESSION_BARRIER();
   runtime_ctx->NewCounter("running_actor_cnt", this_machine_task_num);
   SendCmdMsg(source_tasks, ActorCmd::kStart);
+  CollectStartupMetrics("total", start_time);
 }
 
 Runtime::~Runtime() {
@@ -96,6 +125,7 @@ Runtime::~Runtime() {
 
 void Runtime::NewAllGlobal(const Plan& plan, size_t total_piece_num, bool is_experiment_phase) {
   Global<RuntimeCtx>::New(total_piece_num, is_experiment_phase);
+  NewMetricsRegistryIfNeed();
   if (Global<MachineCtx>::Get()->IsThisMachineMaster()
       && Global<RuntimeCtx>::Get()->NeedCollectActEvent()) {
     Global<ActEventLogger>::New(is_experiment_phase);
@@ -169,6 +199,7 @@ void Runtime::DeleteAllGlobal() {
   Global<ActEventLogger>::Delete();
   Global<RuntimeCtx>::Delete();
   Global<summary::EventsWriter>::Delete();
+  Global<profiler::MetricsRegistry>::Delete();
 }
 
 }  // namespace oneflow
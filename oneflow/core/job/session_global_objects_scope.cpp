@@ -35,6 +35,7 @@ limitations under the License.
 #include "oneflow/core/framework/load_library.h"
 #include "oneflow/core/job/version.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/eager/eager_kernel_cache.h"
 
 namespace oneflow {
 
@@ -65,6 +66,13 @@ AvailableMemDesc PullAvailableMemDesc() {
   return ret;
 }
 
+void ResetEagerKernelCacheSize() {
+  auto* cache = Global<eager::EagerKernelCache>::Get();
+  if (cache != nullptr) {
+    cache->SetCapacity(Global<ResourceDesc, ForSession>::Get()->EagerKernelCacheSize());
+  }
+}
+
 }  // namespace
 
 SessionGlobalObjectsScope::SessionGlobalObjectsScope() {}
@@ -74,6 +82,7 @@ Maybe<void> SessionGlobalObjectsScope::Init(const ConfigProto& config_proto) {
   Global<ResourceDesc, ForSession>::Delete();
   DumpVersionInfo();
   Global<ResourceDesc, ForSession>::New(config_proto.resource());
+  ResetEagerKernelCacheSize();
   Global<const IOConf>::New(config_proto.io_conf());
   Global<const IOConf>::SessionNew(config_proto.session_id(), config_proto.io_conf());
   Global<const ProfilerConf>::New(config_proto.profiler_conf());
@@ -114,6 +123,7 @@ SessionGlobalObjectsScope::~SessionGlobalObjectsScope() {
   Global<const IOConf>::SessionDelete(session_id_);
   Global<ResourceDesc, ForSession>::Delete();
   Global<ResourceDesc, ForSession>::New(Global<ResourceDesc, ForEnv>::Get()->resource());
+  ResetEagerKernelCacheSize();
 }
 
 }  // namespace oneflow
@@ -0,0 +1,227 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/auto_checkpointing_util.h"
+#include <functional>
+#include <numeric>
+
+namespace oneflow {
+
+namespace {
+
+// Only the recomputable ops producing the largest blobs live at the peak are tried every step
+constexpr int64_t kMaxCandidateNumPerStep = 64;
+
+int64_t TotalExcess(const std::vector<AutoCheckpointingPeak>& peaks) {
+  int64_t excess = 0;
+  for (const auto& peak : peaks) { excess += peak.excess; }
+  return excess;
+}
+
+int64_t FindRoot(std::vector<int64_t>* parents, int64_t i) {
+  while (parents->at(i) != i) {
+    parents->at(i) = parents->at(parents->at(i));
+    i = parents->at(i);
+  }
+  return i;
+}
+
+// subgraph_of_ops[i] is the subgraph of the recomputed op i, or -1 for the other ops, and
+// recompute_times[s] is the half step subgraph s runs again, or -1 when no backward op consumes it
+void GenRecomputedSubgraphs(const AutoCheckpointingProblem& problem,
+                            const std::vector<bool>& recomputed,
+                            std::vector<int64_t>* subgraph_of_ops,
+                            std::vector<int64_t>* recompute_times) {
+  const int64_t op_num = problem.ops.size();
+  std::vector<int64_t> parents(op_num);
+  std::iota(parents.begin(), parents.end(), 0);
+  for (const auto& blob : problem.blobs) {
+    if (!recomputed.at(blob.producer)) { continue; }
+    for (int64_t consumer : blob.consumers) {
+      if (recomputed.at(consumer)
+          && problem.ops.at(consumer).group == problem.ops.at(blob.producer).group) {
+        parents.at(FindRoot(&parents, consumer)) = FindRoot(&parents, blob.producer);
+      }
+    }
+  }
+  subgraph_of_ops->assign(op_num, -1);
+  std::vector<int64_t> subgraph_of_roots(op_num, -1);
+  int64_t subgraph_num = 0;
+  FOR_RANGE(int64_t, i, 0, op_num) {
+    if (!recomputed.at(i)) { continue; }
+    const int64_t root = FindRoot(&parents, i);
+    if (subgraph_of_roots.at(root) == -1) { subgraph_of_roots.at(root) = subgraph_num++; }
+    subgraph_of_ops->at(i) = subgraph_of_roots.at(root);
+  }
+  recompute_times->assign(subgraph_num, -1);
+  for (const auto& blob : problem.blobs) {
+    const int64_t subgraph = subgraph_of_ops->at(blob.producer);
+    if (subgraph == -1) { continue; }
+    for (int64_t consumer : blob.consumers) {
+      if (!problem.ops.at(consumer).is_backward) { continue; }
+      int64_t* recompute_time = &recompute_times->at(subgraph);
+      if (*recompute_time == -1 || 2 * consumer - 1 < *recompute_time) {
+        *recompute_time = 2 * consumer - 1;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+std::vector<AutoCheckpointingPeak> EstimateAutoCheckpointingPeaks(
+    const AutoCheckpointingProblem& problem, const std::vector<bool>& recomputed,
+    int64_t memory_budget) {
+  CHECK_EQ(recomputed.size(), problem.ops.size());
+  std::vector<int64_t> subgraph_of_ops;
+  std::vector<int64_t> recompute_times;
+  GenRecomputedSubgraphs(problem, recomputed, &subgraph_of_ops, &recompute_times);
+  auto RecomputeTime4Op = [&](int64_t op) -> int64_t {
+    const int64_t subgraph = subgraph_of_ops.at(op);
+    return subgraph == -1 ? -1 : recompute_times.at(subgraph);
+  };
+  // (half step, bytes) pairs, the bytes of a blob alive in [begin, end] come at begin and go at
+  // end + 1
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> group2events(problem.group_num);
+  auto AddLifetime = [&](int64_t group, int64_t begin, int64_t end, int64_t size) {
+    group2events.at(group).emplace_back(begin, size);
+    group2events.at(group).emplace_back(end + 1, -size);
+  };
+  for (const auto& blob : problem.blobs) {
+    const int64_t group = problem.ops.at(blob.producer).group;
+    const int64_t recompute_time = RecomputeTime4Op(blob.producer);
+    int64_t end = 2 * blob.producer;
+    int64_t copy_end = recompute_time;
+    for (int64_t consumer : blob.consumers) {
+      if (recompute_time != -1 && problem.ops.at(consumer).is_backward) {
+        // served by the recomputed copy
+        copy_end = std::max(copy_end, 2 * consumer);
+        continue;
+      }
+      end = std::max(end, 2 * consumer);
+      // the blob is an input of another recomputed subgraph, which reads it once more
+      const int64_t consumer_recompute_time = RecomputeTime4Op(consumer);
+      if (consumer_recompute_time != -1
+          && subgraph_of_ops.at(consumer) != subgraph_of_ops.at(blob.producer)) {
+        end = std::max(end, consumer_recompute_time);
+      }
+    }
+    AddLifetime(group, 2 * blob.producer, end, blob.size);
+    if (recompute_time != -1) { AddLifetime(group, recompute_time, copy_end, blob.size); }
+  }
+  std::vector<AutoCheckpointingPeak> peaks(problem.group_num);
+  FOR_RANGE(int64_t, group, 0, problem.group_num) {
+    std::vector<std::pair<int64_t, int64_t>>* events = &group2events.at(group);
+    std::sort(events->begin(), events->end());
+    AutoCheckpointingPeak* peak = &peaks.at(group);
+    peak->peak_bytes = 0;
+    peak->peak_time = 0;
+    peak->excess = 0;
+    int64_t live_bytes = 0;
+    for (size_t i = 0; i < events->size(); ++i) {
+      live_bytes += events->at(i).second;
+      const int64_t time = events->at(i).first;
+      if (i + 1 < events->size() && events->at(i + 1).first == time) { continue; }
+      // live_bytes are alive from time on to the next event
+      if (live_bytes > peak->peak_bytes) {
+        peak->peak_bytes = live_bytes;
+        peak->peak_time = time;
+      }
+      if (i + 1 < events->size() && live_bytes > memory_budget) {
+        peak->excess += (live_bytes - memory_budget) * (events->at(i + 1).first - time);
+      }
+    }
+    CHECK_EQ(live_bytes, 0);
+  }
+  return peaks;
+}
+
+AutoCheckpointingPlan PlanAutoCheckpointing(const AutoCheckpointingProblem& problem,
+                                            const std::vector<bool>& recomputed,
+                                            int64_t memory_budget) {
+  AutoCheckpointingPlan plan;
+  plan.recomputed = recomputed;
+  std::vector<AutoCheckpointingPeak> peaks =
+      EstimateAutoCheckpointingPeaks(problem, plan.recomputed, memory_budget);
+  for (const auto& peak : peaks) { plan.peak_bytes_before.push_back(peak.peak_bytes); }
+  while (true) {
+    int64_t group = -1;
+    FOR_RANGE(int64_t, i, 0, problem.group_num) {
+      if (peaks.at(i).peak_bytes > memory_budget
+          && (group == -1 || peaks.at(i).peak_bytes > peaks.at(group).peak_bytes)) {
+        group = i;
+      }
+    }
+    if (group == -1) { break; }
+    // the recomputable producers of the blobs of the placement alive at its peak without any
+    // recomputation. Recomputing one more of them, or no longer recomputing one picked before,
+    // which splits a recomputed subgraph, are the moves tried.
+    const int64_t peak_time = peaks.at(group).peak_time;
+    HashMap<int64_t, int64_t> candidate2bytes;
+    for (const auto& blob : problem.blobs) {
+      const int64_t producer = blob.producer;
+      const auto& op = problem.ops.at(producer);
+      if (op.group != group || !op.recomputable || recomputed.at(producer)) { continue; }
+      int64_t end = 2 * producer;
+      for (int64_t consumer : blob.consumers) { end = std::max(end, 2 * consumer); }
+      if (2 * producer <= peak_time && peak_time <= end) {
+        candidate2bytes[producer] += blob.size;
+      }
+    }
+    std::vector<std::pair<int64_t, int64_t>> candidates;
+    for (const auto& pair : candidate2bytes) { candidates.emplace_back(pair.second, pair.first); }
+    std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<int64_t, int64_t>>());
+    if (static_cast<int64_t>(candidates.size()) > kMaxCandidateNumPerStep) {
+      candidates.resize(kMaxCandidateNumPerStep);
+    }
+    int64_t best_op = -1;
+    double best_score = 0;
+    std::vector<AutoCheckpointingPeak> best_peaks;
+    for (const auto& candidate : candidates) {
+      const int64_t op = candidate.second;
+      const bool was_recomputed = plan.recomputed.at(op);
+      plan.recomputed.at(op) = !was_recomputed;
+      std::vector<AutoCheckpointingPeak> new_peaks =
+          EstimateAutoCheckpointingPeaks(problem, plan.recomputed, memory_budget);
+      plan.recomputed.at(op) = was_recomputed;
+      // a placement may read the blobs of another one, so the excess of all of them is compared.
+      // Every move lowers it, hence the search ends.
+      const int64_t gain = TotalExcess(peaks) - TotalExcess(new_peaks);
+      if (gain <= 0) { continue; }
+      const int64_t added_cost = was_recomputed ? 0 : problem.ops.at(op).cost;
+      const double score = static_cast<double>(gain) / (added_cost + 1);
+      if (best_op == -1 || score > best_score) {
+        best_op = op;
+        best_score = score;
+        best_peaks = new_peaks;
+      }
+    }
+    if (best_op == -1) { break; }
+    plan.recomputed.at(best_op) = !plan.recomputed.at(best_op);
+    peaks = best_peaks;
+  }
+  plan.added_cost = 0;
+  plan.fits = true;
+  FOR_RANGE(int64_t, i, 0, problem.ops.size()) {
+    if (plan.recomputed.at(i)) { plan.added_cost += problem.ops.at(i).cost; }
+  }
+  for (const auto& peak : peaks) {
+    plan.peak_bytes_after.push_back(peak.peak_bytes);
+    if (peak.peak_bytes > memory_budget) { plan.fits = false; }
+  }
+  return plan;
+}
+
+}  // namespace oneflow
@@ -0,0 +1,81 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_REWRITER_AUTO_CHECKPOINTING_UTIL_H_
+#define ONEFLOW_CORE_JOB_REWRITER_AUTO_CHECKPOINTING_UTIL_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// The ops of a training job in topological order and the blobs between them, as seen by the
+// planner of the forward ops to recompute in the backward pass
+struct AutoCheckpointingProblem {
+  struct Op {
+    bool is_backward;
+    // a forward op which may be recomputed in the backward pass
+    bool recomputable;
+    // the estimated cost of running the op once more
+    int64_t cost;
+    // the placement of the op, the memory of every placement is accounted on its own
+    int64_t group;
+  };
+  struct Blob {
+    int64_t producer;
+    std::vector<int64_t> consumers;
+    // bytes on every device of the placement of the producer
+    int64_t size;
+  };
+  std::vector<Op> ops;
+  std::vector<Blob> blobs;
+  int64_t group_num;
+};
+
+struct AutoCheckpointingPeak {
+  int64_t peak_bytes;
+  // the topological position of the peak, in half steps
+  int64_t peak_time;
+  // the sum over the half steps of the live bytes above the budget
+  int64_t excess;
+};
+
+// Estimates the live bytes of every placement over the topological order when the ops marked in
+// recomputed are recomputed in the backward pass the way CheckpointingPass does it: the ops
+// connected by their blobs on the same placement form a subgraph, which runs again just before
+// its first backward consumer. Its blobs then live until their last forward consumer, and from
+// the recomputation to their last backward consumer.
+std::vector<AutoCheckpointingPeak> EstimateAutoCheckpointingPeaks(
+    const AutoCheckpointingProblem& problem, const std::vector<bool>& recomputed,
+    int64_t memory_budget);
+
+struct AutoCheckpointingPlan {
+  std::vector<bool> recomputed;
+  std::vector<int64_t> peak_bytes_before;
+  std::vector<int64_t> peak_bytes_after;
+  int64_t added_cost;
+  bool fits;
+};
+
+// Greedily recomputes one more op, or stops recomputing one picked before, whichever removes the
+// most bytes above memory_budget per unit of added cost, among the ops with a blob live at the peak
+// of the placement furthest above the budget, until every placement fits or no move helps any
+// more. The ops of recomputed, e.g. those of user checkpointing scopes, are recomputed anyway.
+AutoCheckpointingPlan PlanAutoCheckpointing(const AutoCheckpointingProblem& problem,
+                                            const std::vector<bool>& recomputed,
+                                            int64_t memory_budget);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_REWRITER_AUTO_CHECKPOINTING_UTIL_H_
@@ -0,0 +1,146 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/auto_checkpointing_util.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// A data op, layer_num forward layers each producing an activation of activation_size bytes read
+// by the next layer and by its backward layer, then the backward layers in the reverse order
+// each passing a gradient of grad_size bytes to the one before
+AutoCheckpointingProblem GenChainProblem(int64_t layer_num, int64_t activation_size,
+                                         int64_t grad_size) {
+  AutoCheckpointingProblem problem;
+  problem.group_num = 1;
+  problem.ops.push_back({false, false, 1, 0});
+  FOR_RANGE(int64_t, i, 0, layer_num) { problem.ops.push_back({false, true, 10, 0}); }
+  FOR_RANGE(int64_t, i, 0, layer_num) { problem.ops.push_back({true, false, 1, 0}); }
+  auto Backward4Layer = [&](int64_t i) { return 2 * layer_num - i; };
+  problem.blobs.push_back({0, {1}, activation_size});
+  FOR_RANGE(int64_t, i, 0, layer_num) {
+    std::vector<int64_t> consumers{Backward4Layer(i)};
+    if (i + 1 < layer_num) { consumers.push_back(i + 2); }
+    problem.blobs.push_back({i + 1, consumers, activation_size});
+  }
+  FOR_RANGE(int64_t, i, 0, layer_num) {
+    std::vector<int64_t> consumers;
+    if (i > 0) { consumers.push_back(Backward4Layer(i - 1)); }
+    problem.blobs.push_back({Backward4Layer(i), consumers, grad_size});
+  }
+  return problem;
+}
+
+}  // namespace
+
+TEST(AutoCheckpointing, estimate) {
+  const AutoCheckpointingProblem problem = GenChainProblem(3, 100, 10);
+  std::vector<bool> recomputed(problem.ops.size(), false);
+  std::vector<AutoCheckpointingPeak> peaks =
+      EstimateAutoCheckpointingPeaks(problem, recomputed, GetMaxVal<int64_t>());
+  ASSERT_EQ(peaks.size(), 1);
+  // all the activations and the first gradient when the last backward layer runs
+  ASSERT_EQ(peaks.at(0).peak_bytes, 310);
+  ASSERT_EQ(peaks.at(0).peak_time, 8);
+  ASSERT_EQ(peaks.at(0).excess, 0);
+  // the activation of the second layer is freed after the third layer and produced again just
+  // before its backward layer
+  recomputed.at(2) = true;
+  peaks = EstimateAutoCheckpointingPeaks(problem, recomputed, 200);
+  ASSERT_EQ(peaks.at(0).peak_bytes, 300);
+  ASSERT_EQ(peaks.at(0).peak_time, 6);
+  ASSERT_EQ(peaks.at(0).excess, 100 + 10 * 2 + 20);
+}
+
+TEST(AutoCheckpointing, plan) {
+  const AutoCheckpointingProblem problem = GenChainProblem(32, 1000, 10);
+  const std::vector<bool> recomputed(problem.ops.size(), false);
+  const AutoCheckpointingPlan loose_plan =
+      PlanAutoCheckpointing(problem, recomputed, GetMaxVal<int64_t>());
+  ASSERT_TRUE(loose_plan.fits);
+  ASSERT_EQ(loose_plan.added_cost, 0);
+  ASSERT_EQ(loose_plan.peak_bytes_before.at(0), loose_plan.peak_bytes_after.at(0));
+  ASSERT_GE(loose_plan.peak_bytes_before.at(0), 32 * 1000);
+
+  const int64_t budget = 10 * 1000;
+  const AutoCheckpointingPlan plan = PlanAutoCheckpointing(problem, recomputed, budget);
+  ASSERT_TRUE(plan.fits);
+  ASSERT_LE(plan.peak_bytes_after.at(0), budget);
+  ASSERT_FALSE(plan.recomputed.at(0));
+  int64_t added_cost = 0;
+  FOR_RANGE(size_t, i, 0, problem.ops.size()) {
+    if (plan.recomputed.at(i)) {
+      ASSERT_TRUE(problem.ops.at(i).recomputable);
+      added_cost += problem.ops.at(i).cost;
+    }
+  }
+  ASSERT_EQ(plan.added_cost, added_cost);
+  ASSERT_GT(added_cost, 0);
+  ASSERT_EQ(EstimateAutoCheckpointingPeaks(problem, plan.recomputed, budget).at(0).peak_bytes,
+            plan.peak_bytes_after.at(0));
+
+  const AutoCheckpointingPlan tight_plan = PlanAutoCheckpointing(problem, recomputed, 1);
+  ASSERT_FALSE(tight_plan.fits);
+  ASSERT_LT(tight_plan.peak_bytes_after.at(0), tight_plan.peak_bytes_before.at(0));
+}
+
+TEST(AutoCheckpointing, unrecomputable) {
+  // the cheapest layers to recompute are those of e.g. a random or a stateful op, so the plan has
+  // to go around them
+  AutoCheckpointingProblem problem = GenChainProblem(32, 1000, 10);
+  FOR_RANGE(int64_t, i, 1, 33) {
+    if (i % 2 == 0) {
+      problem.ops.at(i).recomputable = false;
+      problem.ops.at(i).cost = 1;
+    }
+  }
+  const AutoCheckpointingPlan plan =
+      PlanAutoCheckpointing(problem, std::vector<bool>(problem.ops.size(), false), 24 * 1000);
+  ASSERT_TRUE(plan.fits);
+  ASSERT_GT(plan.added_cost, 0);
+  FOR_RANGE(size_t, i, 0, problem.ops.size()) {
+    if (!problem.ops.at(i).recomputable) { ASSERT_FALSE(plan.recomputed.at(i)); }
+  }
+}
+
+TEST(AutoCheckpointing, placements) {
+  // two chains on two placements, only the second one is above the budget
+  AutoCheckpointingProblem problem = GenChainProblem(4, 1000, 10);
+  const AutoCheckpointingProblem other = GenChainProblem(8, 1000, 10);
+  const int64_t offset = problem.ops.size();
+  for (auto op : other.ops) {
+    op.group = 1;
+    problem.ops.push_back(op);
+  }
+  for (auto blob : other.blobs) {
+    blob.producer += offset;
+    for (int64_t& consumer : blob.consumers) { consumer += offset; }
+    problem.blobs.push_back(blob);
+  }
+  problem.group_num = 2;
+  const AutoCheckpointingPlan plan =
+      PlanAutoCheckpointing(problem, std::vector<bool>(problem.ops.size(), false), 6000);
+  ASSERT_TRUE(plan.fits);
+  FOR_RANGE(int64_t, i, 0, offset) { ASSERT_FALSE(plan.recomputed.at(i)); }
+  ASSERT_EQ(plan.peak_bytes_before.at(0), plan.peak_bytes_after.at(0));
+  ASSERT_LE(plan.peak_bytes_after.at(1), 6000);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
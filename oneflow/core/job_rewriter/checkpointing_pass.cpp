@@ -17,6 +17,8 @@ limitations under the License.
 #include "oneflow/core/job/job.pb.h"
 #include "oneflow/core/job/scope.h"
 #include "oneflow/core/job_rewriter/calculation_pass.h"
+#include "oneflow/core/job_rewriter/auto_checkpointing_util.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/vm/symbol_storage.h"
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/operator/operator.h"
@@ -36,12 +38,13 @@ class CheckpointingPass final : public JobPass {
     if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
     const OpGraph op_graph(*job);
     JobBuilder job_builder(job);
-    return Apply(op_graph, &job_builder);
+    return Apply(op_graph, &job_builder, ctx->job_desc());
   }
 
   bool IsEnabled(const JobPassCtx& ctx) const { return ctx.job_desc().IsTrain(); }
 
-  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                    const JobDesc& job_desc) const;
 };
 
 const std::string kCheckpointingFakeOpNamePrefix = "OneFlow-System-Checkpointing-Fake-Fw-Op_";
@@ -61,27 +64,199 @@ bool IsForwardPass7CheckpointingScope(const Scope& scope) {
   return IsForwardPassScope(scope) && scope.Bool("checkpointing");
 }
 
-void CollectAllCheckpointingOpsInForwardPass(
-    const OpGraph& op_graph, HashMap<std::string, const OpNode*>* checkpointing_op_name2op_node) {
+bool IsIgnoredCheckpointingOp(const OperatorConf& op_conf) {
   // NOTE(chengcheng):
   //   ignore batch_norm ops because of recompute bn will repeat the calculation of 'm' and 'v'.
   //   in the future, we need to support the recomputation version of batch_norm which do NOT
   //   update forward variables.
-  HashSet<std::string> ignore_op_type_names = {"normalization", "normalization_add_relu",
-                                               "cudnn_fused_normalization_add_relu"};
+  static const HashSet<std::string> ignore_op_type_names = {
+      "normalization", "normalization_add_relu", "cudnn_fused_normalization_add_relu"};
+  return ignore_op_type_names.find(op_conf.user_conf().op_type_name())
+         != ignore_op_type_names.end();
+}
+
+void CollectAllCheckpointingOpsInForwardPass(
+    const OpGraph& op_graph, HashMap<std::string, const OpNode*>* checkpointing_op_name2op_node) {
   op_graph.ForEachNode([&](const OpNode* op_node) {
     const OperatorConf& op_conf = op_node->op().op_conf();
     if (!op_conf.has_user_conf()) { return; }
-    if (ignore_op_type_names.find(op_conf.user_conf().op_type_name())
-        != ignore_op_type_names.end()) {
-      return;
-    }
+    if (IsIgnoredCheckpointingOp(op_conf)) { return; }
     if (IsForwardPass7CheckpointingScope(Scope4OpNode(op_node))) {
       CHECK(checkpointing_op_name2op_node->emplace(op_conf.name(), op_node).second);
     }
   });
 }
 
+bool IsForwardPassOpNode(const OpNode* op_node) {
+  return op_node->op().op_conf().has_scope_symbol_id()
+         && IsForwardPassScope(Scope4OpNode(op_node));
+}
+
+bool IsBackwardPassOpNode(const OpNode* op_node) {
+  return op_node->op().op_conf().has_scope_symbol_id()
+         && !IsForwardPassScope(Scope4OpNode(op_node));
+}
+
+// A recomputation of these ops would not reproduce the blobs of the forward pass: the readers and
+// decoders move on to the next samples, the random ops draw again and the pack and unpack kernels
+// move on to the next piece. The states of the other kernels, e.g. of conv and pool, only cache
+// what is derived from the attrs and the shapes.
+bool IsUnrepeatableOp(const OperatorConf& op_conf) {
+  static const HashSet<std::string> unrepeatable_op_type_names = {
+      "OFRecordReader",
+      "OneRecReader",
+      "COCOReader",
+      "ofrecord_image_decoder_random_crop",
+      "image_decode_crop_resize_mirror_normalize",
+      "image_random_crop",
+      "coin_flip",
+      "generate_random_batch_permutation_indices",
+      "random_mask_like",
+      "pack",
+      "unpack"};
+  if (unrepeatable_op_type_names.find(op_conf.user_conf().op_type_name())
+      != unrepeatable_op_type_names.end()) {
+    return true;
+  }
+  for (const auto& pair : op_conf.user_conf().attr()) {
+    const std::string& attr_name = pair.first;
+    if (attr_name.find("seed") != std::string::npos || attr_name.find("random") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Only the forward user ops computing their blobs from data inputs, the same way every time
+bool IsAutoCheckpointingCandidate(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  if (!op_conf.has_user_conf() || IsIgnoredCheckpointingOp(op_conf)) { return false; }
+  if (op_node->op().input_bns().empty() || IsUnrepeatableOp(op_conf)) { return false; }
+  return IsForwardPassOpNode(op_node);
+}
+
+// The multiply-adds of the matmuls and convolutions, the elements read and written by the other ops
+int64_t EstimateRecomputationCost(const OpNode* op_node) {
+  const user_op::UserOpConfWrapper user_op_conf(op_node->op().op_conf());
+  const std::string& op_type_name = user_op_conf.op_type_name();
+  auto Shape4Lbn = [&](const std::string& lbn) -> const Shape& {
+    return op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(lbn)).shape();
+  };
+  if (op_type_name == "matmul" || op_type_name == "batch_matmul") {
+    const Shape& a_shape = Shape4Lbn(user_op_conf.input("a", 0));
+    const int64_t k = user_op_conf.attr<bool>("transpose_a") ? a_shape.At(a_shape.NumAxes() - 2)
+                                                             : a_shape.At(a_shape.NumAxes() - 1);
+    return Shape4Lbn(user_op_conf.output("out", 0)).elem_cnt() * k;
+  }
+  if (op_type_name == "conv1d" || op_type_name == "conv2d" || op_type_name == "conv3d") {
+    const Shape& weight_shape = Shape4Lbn(user_op_conf.input("weight", 0));
+    return Shape4Lbn(user_op_conf.output("out", 0)).elem_cnt()
+           * (weight_shape.elem_cnt() / weight_shape.At(0));
+  }
+  const Operator& op = op_node->op();
+  int64_t cost = 0;
+  for (const std::string& ibn : op.input_bns()) {
+    cost += op_node->LogicalBlobDesc4Lbi(op.BnInOp2Lbi(ibn)).shape().elem_cnt();
+  }
+  for (const std::string& obn : op.output_bns()) {
+    cost += op_node->LogicalBlobDesc4Lbi(op.BnInOp2Lbi(obn)).shape().elem_cnt();
+  }
+  return cost;
+}
+
+// Adds the forward ops picked by PlanAutoCheckpointing to keep the peak of the live blobs of every
+// placement under the budget of the job, and reports the plan
+void CollectAutoCheckpointingOps(
+    const OpGraph& op_graph, const JobDesc& job_desc,
+    HashMap<std::string, const OpNode*>* checkpointing_op_name2op_node) {
+  const int64_t memory_budget =
+      job_desc.job_conf().auto_checkpointing_memory_budget_mbyte() * 1024 * 1024;
+  AutoCheckpointingProblem problem;
+  std::vector<const OpNode*> op_nodes;
+  HashMap<const OpNode*, int64_t> op_node2index;
+  std::vector<const ParallelDesc*> parallel_descs;
+  std::vector<bool> recomputed;
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    CHECK(op_node2index.emplace(op_node, op_nodes.size()).second);
+    op_nodes.push_back(op_node);
+    AutoCheckpointingProblem::Op op;
+    op.is_backward = IsBackwardPassOpNode(op_node);
+    op.recomputable = IsAutoCheckpointingCandidate(op_node);
+    op.cost = op.recomputable ? EstimateRecomputationCost(op_node) : 0;
+    op.group = std::find_if(parallel_descs.begin(), parallel_descs.end(),
+                            [&](const ParallelDesc* parallel_desc) {
+                              return *parallel_desc == op_node->parallel_desc();
+                            })
+               - parallel_descs.begin();
+    if (op.group == static_cast<int64_t>(parallel_descs.size())) {
+      parallel_descs.push_back(&op_node->parallel_desc());
+    }
+    problem.ops.push_back(op);
+    recomputed.push_back(checkpointing_op_name2op_node->find(op_node->op().op_name())
+                         != checkpointing_op_name2op_node->end());
+  });
+  problem.group_num = parallel_descs.size();
+  // the variables are not shared with other blobs, like in the memory report of the plan
+  HashMap<LogicalBlobId, int64_t> lbi2blob_index;
+  for (const OpNode* op_node : op_nodes) {
+    const Operator& op = op_node->op();
+    if (op.op_conf().has_variable_conf()) { continue; }
+    for (const std::string& obn : op.output_bns()) {
+      const LogicalBlobId& lbi = op.BnInOp2Lbi(obn);
+      const BlobDesc& blob_desc = op_node->LogicalBlobDesc4Lbi(lbi);
+      AutoCheckpointingProblem::Blob blob;
+      blob.producer = op_node2index.at(op_node);
+      blob.size = blob_desc.shape().elem_cnt() * GetSizeOfDataType(blob_desc.data_type());
+      if (op_node->SbpParallel4Lbi(lbi).has_split_parallel()) {
+        blob.size = RoundUp(blob.size, op_node->parallel_desc().parallel_num())
+                    / op_node->parallel_desc().parallel_num();
+      }
+      CHECK(lbi2blob_index.emplace(lbi, problem.blobs.size()).second);
+      problem.blobs.push_back(blob);
+    }
+  }
+  for (const OpNode* op_node : op_nodes) {
+    for (const OpEdge* edge : op_node->out_edges()) {
+      for (const LogicalBlobId& lbi : edge->lbis()) {
+        const auto it = lbi2blob_index.find(lbi);
+        if (it == lbi2blob_index.end()) { continue; }
+        problem.blobs.at(it->second).consumers.push_back(op_node2index.at(edge->dst_node()));
+      }
+    }
+  }
+
+  const AutoCheckpointingPlan plan = PlanAutoCheckpointing(problem, recomputed, memory_budget);
+  auto log_stream =
+      TeePersistentLogStream::Create("auto_checkpointing_job" + std::to_string(job_desc.job_id()));
+  (*log_stream) << "memory budget: " << std::to_string(memory_budget) << " bytes\n";
+  (*log_stream) << "the peaks are estimates of the live blobs in topological order\n";
+  FOR_RANGE(int64_t, group, 0, problem.group_num) {
+    (*log_stream) << "placement " << std::to_string(group) << ": "
+                  << parallel_descs.at(group)->parallel_conf().DebugString()
+                  << "  estimated peak: " << std::to_string(plan.peak_bytes_before.at(group))
+                  << " -> " << std::to_string(plan.peak_bytes_after.at(group)) << " bytes\n";
+  }
+  (*log_stream) << "recomputed op\tplacement\tcost\n";
+  int64_t auto_op_num = 0;
+  FOR_RANGE(int64_t, i, 0, problem.ops.size()) {
+    if (!plan.recomputed.at(i) || recomputed.at(i)) { continue; }
+    const OpNode* op_node = op_nodes.at(i);
+    CHECK(checkpointing_op_name2op_node->emplace(op_node->op().op_name(), op_node).second);
+    (*log_stream) << op_node->op().op_name() << "\t" << std::to_string(problem.ops.at(i).group)
+                  << "\t" << std::to_string(problem.ops.at(i).cost) << "\n";
+    auto_op_num += 1;
+  }
+  const int64_t max_peak_bytes =
+      *std::max_element(plan.peak_bytes_after.begin(), plan.peak_bytes_after.end());
+  LOG(INFO) << "auto checkpointing of job " << job_desc.job_id() << " recomputes " << auto_op_num
+            << " more ops, estimated peak " << max_peak_bytes << " bytes, budget " << memory_budget
+            << " bytes";
+  if (!plan.fits) {
+    LOG(WARNING) << "auto checkpointing of job " << job_desc.job_id()
+                 << " can not fit the memory budget of " << memory_budget << " bytes";
+  }
+}
+
 void GenConnectedCheckpointingSubgraphs(
     const HashMap<std::string, const OpNode*>& checkpointing_op_name2op_node,
     std::vector<HashSet<const OpNode*>>* checkpointing_subgraphs) {
@@ -119,10 +294,14 @@ void GenConnectedCheckpointingSubgraphs(
   }
 }
 
-Maybe<void> CheckpointingPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+Maybe<void> CheckpointingPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                                     const JobDesc& job_desc) const {
   // step 1. collect all checkpointing ops in forwardpass.
   HashMap<std::string, const OpNode*> checkpointing_op_name2op_node;
   CollectAllCheckpointingOpsInForwardPass(op_graph, &checkpointing_op_name2op_node);
+  if (job_desc.job_conf().auto_checkpointing_memory_budget_mbyte() > 0) {
+    CollectAutoCheckpointingOps(op_graph, job_desc, &checkpointing_op_name2op_node);
+  }
   if (checkpointing_op_name2op_node.empty()) { return Maybe<void>::Ok(); }
 
   // step 2. get all connected subgraphs in checkpointing ops.
@@ -0,0 +1,112 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/gather_kernel_util.h"
+#include "oneflow/core/kernel/unsorted_segment_sum_kernel_util.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+DEFINE_int64(vocab_size, 200000, "number of rows of the embedding table.");
+DEFINE_int64(embedding_size, 64, "number of floats of every row.");
+DEFINE_int64(num_ids, 262144, "number of ids looked up.");
+DEFINE_int32(thread_num, 8, "size of the thread pool of the second run of each case.");
+DEFINE_int32(iter_num, 10, "number of runs of each case.");
+
+namespace oneflow {
+
+namespace {
+
+// ids of an embedding lookup, a few hot ids and a long tail, following Zipf's law
+template<typename K>
+std::vector<K> ZipfIds(int64_t num_ids, int64_t vocab_size, double exponent) {
+  std::vector<double> cdf(vocab_size);
+  double sum = 0;
+  FOR_RANGE(int64_t, i, 0, vocab_size) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+    cdf.at(i) = sum;
+  }
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> dis(0, sum);
+  std::vector<K> ids(num_ids);
+  for (K& id : ids) {
+    id = std::min<int64_t>(std::lower_bound(cdf.begin(), cdf.end(), dis(gen)) - cdf.begin(),
+                           vocab_size - 1);
+  }
+  return ids;
+}
+
+// Runs Case on the calling thread, then on a thread pool
+void RunWithAndWithoutThreadPool(const std::string& name, const std::function<void()>& Case) {
+  auto Run = [&](const std::string& threads) {
+    const auto start = std::chrono::steady_clock::now();
+    FOR_RANGE(int32_t, i, 0, FLAGS_iter_num) { Case(); }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ", " << threads << ": " << seconds * 1e3 / FLAGS_iter_num << " ms"
+              << std::endl;
+  };
+  Run("1 thread");
+  Global<ThreadPool>::New(FLAGS_thread_num);
+  Run(std::to_string(FLAGS_thread_num) + " threads");
+  Global<ThreadPool>::Delete();
+}
+
+void BenchmarkEmbeddingLookup() {
+  std::vector<float> table(FLAGS_vocab_size * FLAGS_embedding_size, 1);
+  const std::vector<int64_t> ids = ZipfIds<int64_t>(FLAGS_num_ids, FLAGS_vocab_size, 1.05);
+  std::vector<float> out(FLAGS_num_ids * FLAGS_embedding_size);
+  RunWithAndWithoutThreadPool(
+      "gather " + std::to_string(FLAGS_num_ids) + " rows of "
+          + std::to_string(FLAGS_embedding_size) + " floats",
+      [&]() {
+        GatherKernelUtilImpl<DeviceType::kCPU, float, int64_t>::Forward(
+            nullptr, ids.data(), FLAGS_num_ids, table.data(),
+            Shape({1, FLAGS_vocab_size, FLAGS_embedding_size}), out.data(), 0);
+      });
+  CHECK_EQ(out.back(), 1);
+}
+
+void BenchmarkEmbeddingGradient() {
+  const std::vector<int32_t> ids = ZipfIds<int32_t>(FLAGS_num_ids, FLAGS_vocab_size, 1.05);
+  std::vector<float> data(FLAGS_num_ids * FLAGS_embedding_size, 1);
+  std::vector<float> out(FLAGS_vocab_size * FLAGS_embedding_size);
+  RunWithAndWithoutThreadPool(
+      "sum " + std::to_string(FLAGS_num_ids) + " rows of " + std::to_string(FLAGS_embedding_size)
+          + " floats into " + std::to_string(FLAGS_vocab_size) + " segments",
+      [&]() {
+        std::fill(out.begin(), out.end(), 0);
+        UnsortedSegmentSumKernelUtil<DeviceType::kCPU, float, int32_t, float>::UnsortedSegmentSum(
+            nullptr, ids.data(), data.data(), FLAGS_num_ids, FLAGS_vocab_size, 1,
+            FLAGS_embedding_size, 0, out.data());
+      });
+  CHECK_EQ(out.at(ids.front() * FLAGS_embedding_size),
+           static_cast<float>(std::count(ids.begin(), ids.end(), ids.front())));
+}
+
+}  // namespace
+
+}  // namespace oneflow
+
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  BenchmarkEmbeddingLookup();
+  BenchmarkEmbeddingGradient();
+  return 0;
+}
@@ -14,11 +14,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/gather_kernel_util.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
 namespace {
 
+// A gather writing at least this many bytes per thread is split over the thread pool
+constexpr int64_t kParallelGatherMinBytesPerThread = 1 << 20;
+
 Shape GetFlatShape(const ShapeView& shape, int64_t axis) {
   CHECK_GT(shape.NumAxes(), 0);
   CHECK_GE(axis, 0);
@@ -76,18 +82,33 @@ void GatherKernelUtilImpl<DeviceType::kCPU, T, K>::Forward(DeviceCtx* ctx, const
   const int64_t outer_dim_size = flat_in_shape.At(0);
   const int64_t gather_dim_size = flat_in_shape.At(1);
   const int64_t inner_dim_size = flat_in_shape.At(2);
-  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
-    FOR_RANGE(int64_t, i, 0, num_indices) {
+  const int64_t row_num = outer_dim_size * num_indices;
+  const int64_t row_bytes = inner_dim_size * sizeof(T);
+  // out row r is the in row of indices[r % num_indices] in the outer slice r / num_indices
+  auto GatherRows = [&](int64_t row_begin, int64_t row_end) {
+    FOR_RANGE(int64_t, row, row_begin, row_end) {
+      const int64_t outer_idx = row / num_indices;
+      const int64_t i = row - outer_idx * num_indices;
       CHECK_GE(indices[i], 0);
       const int64_t idx = indices[i] - offset;
-      T* to = out + outer_idx * num_indices * inner_dim_size + i * inner_dim_size;
+      T* to = out + row * inner_dim_size;
       if (idx >= 0 && idx < gather_dim_size) {
-        const T* from = in + outer_idx * gather_dim_size * inner_dim_size + idx * inner_dim_size;
-        std::copy(from, from + inner_dim_size, to);
+        std::memcpy(to, in + (outer_idx * gather_dim_size + idx) * inner_dim_size, row_bytes);
       } else {
-        std::memset(to, 0, inner_dim_size * sizeof(K));
+        std::memset(to, 0, row_bytes);
       }
     }
+  };
+  int64_t part_num = 1;
+  if (Global<ThreadPool>::Get() != nullptr) {
+    part_num = std::min<int64_t>(row_num * row_bytes / kParallelGatherMinBytesPerThread,
+                                 Global<ThreadPool>::Get()->thread_num());
+  }
+  if (part_num <= 1) {
+    GatherRows(0, row_num);
+  } else {
+    BalancedSplitter bs(row_num, part_num);
+    MultiThreadLoop(part_num, [&](size_t i) { GatherRows(bs.At(i).begin(), bs.At(i).end()); });
   }
 }
 
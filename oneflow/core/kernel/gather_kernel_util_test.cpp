@@ -0,0 +1,87 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/gather_kernel_util.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include <cmath>
+#include <random>
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// ids of an embedding lookup, a few hot ids and a long tail, following Zipf's law
+std::vector<int64_t> ZipfIds(int64_t num_ids, int64_t vocab_size, double exponent) {
+  std::vector<double> cdf(vocab_size);
+  double sum = 0;
+  FOR_RANGE(int64_t, i, 0, vocab_size) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+    cdf.at(i) = sum;
+  }
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> dis(0, sum);
+  std::vector<int64_t> ids(num_ids);
+  for (int64_t& id : ids) {
+    id = std::min<int64_t>(std::lower_bound(cdf.begin(), cdf.end(), dis(gen)) - cdf.begin(),
+                           vocab_size - 1);
+  }
+  return ids;
+}
+
+void TestGather(int64_t outer_dim_size, int64_t gather_dim_size, int64_t inner_dim_size,
+                int64_t num_indices, int64_t offset) {
+  std::vector<float> in(outer_dim_size * gather_dim_size * inner_dim_size);
+  FOR_RANGE(size_t, i, 0, in.size()) { in.at(i) = static_cast<float>(i % 1009); }
+  // ids of the whole table, this part holds [offset, offset + gather_dim_size)
+  std::vector<int64_t> indices = ZipfIds(num_indices, gather_dim_size * 2, 1.05);
+  std::vector<float> out(outer_dim_size * num_indices * inner_dim_size, -1);
+  GatherKernelUtilImpl<DeviceType::kCPU, float, int64_t>::Forward(
+      nullptr, indices.data(), num_indices, in.data(),
+      Shape({outer_dim_size, gather_dim_size, inner_dim_size}), out.data(), offset);
+  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
+    FOR_RANGE(int64_t, i, 0, num_indices) {
+      const int64_t idx = indices.at(i) - offset;
+      FOR_RANGE(int64_t, j, 0, inner_dim_size) {
+        const float expected =
+            idx >= 0 && idx < gather_dim_size
+                ? in.at((outer_idx * gather_dim_size + idx) * inner_dim_size + j)
+                : 0;
+        ASSERT_EQ(out.at((outer_idx * num_indices + i) * inner_dim_size + j), expected);
+      }
+    }
+  }
+}
+
+void TestGatherAllCases() {
+  TestGather(1, 100, 16, 1000, 0);
+  TestGather(3, 100, 7, 1000, 50);
+  TestGather(1, 1000, 64, 20000, 0);
+  TestGather(4, 1000, 64, 5000, 300);
+}
+
+}  // namespace
+
+TEST(GatherKernelUtilImpl, cpu_gather) {
+  TestGatherAllCases();
+  Global<ThreadPool>::New(4);
+  TestGatherAllCases();
+  Global<ThreadPool>::Delete();
+}
+
+}  // namespace test
+
+}  // namespace oneflow
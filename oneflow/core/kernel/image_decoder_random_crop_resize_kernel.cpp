@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/common/channel.h"
 #include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/user/image/random_crop_generator.h"
+#include "oneflow/user/image/jpeg_decoder.h"
 #include <opencv2/opencv.hpp>
 
 #if defined(WITH_CUDA) && CUDA_VERSION >= 10020
@@ -99,20 +100,28 @@ void CpuDecodeHandle::DecodeRandomCropResize(const unsigned char* data, size_t l
                                              unsigned char* workspace, size_t workspace_size,
                                              unsigned char* dst, int target_width,
                                              int target_height) {
+  cv::Mat dst_mat(target_height, target_width, CV_8UC3, dst, cv::Mat::AUTO_STEP);
+  cv::Mat partial;
+  CropWindow crop;
+  if (JpegPartialDecodeRandomCropImage(data, length, crop_generator, &crop, "RGB", target_width,
+                                       target_height, &partial)) {
+    cv::resize(partial, dst_mat, cv::Size(target_width, target_height), 0, 0, cv::INTER_LINEAR);
+    return;
+  }
   cv::Mat image =
       cv::imdecode(cv::Mat(1, length, CV_8UC1, const_cast<unsigned char*>(data)), cv::IMREAD_COLOR);
   cv::Mat cropped;
   if (crop_generator) {
-    cv::Rect roi;
-    GenerateRandomCropRoi(crop_generator, image.cols, image.rows, &roi.x, &roi.y, &roi.width,
-                          &roi.height);
+    if (crop.shape.elem_cnt() == 0) {
+      crop_generator->GenerateCropWindow({image.rows, image.cols}, &crop);
+    }
+    const cv::Rect roi(crop.anchor.At(1), crop.anchor.At(0), crop.shape.At(1), crop.shape.At(0));
     image(roi).copyTo(cropped);
   } else {
     cropped = image;
   }
   cv::Mat resized;
   cv::resize(cropped, resized, cv::Size(target_width, target_height), 0, 0, cv::INTER_LINEAR);
-  cv::Mat dst_mat(target_height, target_width, CV_8UC3, dst, cv::Mat::AUTO_STEP);
   cv::cvtColor(resized, dst_mat, cv::COLOR_BGR2RGB);
 }
 
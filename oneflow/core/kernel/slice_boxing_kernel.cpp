@@ -32,10 +32,9 @@ class SliceBoxingKernel : public KernelIf<device_type> {
   virtual const SliceBoxingConf& GetCustomizedBoxingConf() const = 0;
   MemoryCopier* memory_copier() const;
   const std::vector<std::shared_ptr<TensorSliceCopier>>& tensor_slice_copier_vec() const;
-
- private:
   void VirtualKernelInit() override;
 
+ private:
   std::vector<std::shared_ptr<TensorSliceCopier>> tensor_slice_copier_vec_;
   std::unique_ptr<MemoryCopier> memory_copier_;
 };
@@ -62,8 +61,11 @@ class SliceBoxingAddKernel final : public SliceBoxingKernel<device_type, T> {
 
  private:
   virtual const SliceBoxingConf& GetCustomizedBoxingConf() const;
+  void VirtualKernelInit() override;
   void ForwardDataContent(const KernelCtx&,
                           std::function<Blob*(const std::string&)>) const override;
+
+  std::unique_ptr<SliceBoxingCpuAddN> cpu_add_n_;
 };
 
 template<DeviceType device_type, typename T>
@@ -109,10 +111,32 @@ const SliceBoxingConf& SliceBoxingAddKernel<device_type, T>::GetCustomizedBoxing
   return this->op_conf().slice_boxing_add_conf().slice_boxing_conf();
 }
 
+template<DeviceType device_type, typename T>
+void SliceBoxingAddKernel<device_type, T>::VirtualKernelInit() {
+  SliceBoxingKernel<device_type, T>::VirtualKernelInit();
+  if (device_type != DeviceType::kCPU) { return; }
+  const SliceBoxingConf& conf = GetCustomizedBoxingConf();
+  const TensorSliceView out_slice(conf.out_slice());
+  std::vector<TensorSliceView> in_slices;
+  for (const TensorSliceViewProto& in_slice_proto : conf.in_slice()) {
+    in_slices.emplace_back(in_slice_proto);
+    if (!in_slices.back().Contains(out_slice)) { return; }
+  }
+  cpu_add_n_.reset(new SliceBoxingCpuAddN(out_slice, in_slices));
+}
+
 template<DeviceType device_type, typename T>
 void SliceBoxingAddKernel<device_type, T>::ForwardDataContent(
     const KernelCtx& ctx, std::function<Blob*(const std::string&)> BnInOp2Blob) const {
   Blob* out = BnInOp2Blob("out");
+  if (cpu_add_n_) {
+    std::vector<const T*> ins;
+    FOR_RANGE(int64_t, i, 0, this->op_attribute().input_bns().size()) {
+      ins.push_back(BnInOp2Blob(GenRepeatedBn("in", i))->dptr<T>());
+    }
+    cpu_add_n_->Compute<T>(ins, out->mut_dptr<T>());
+    return;
+  }
   FOR_RANGE(int64_t, i, 0, this->op_attribute().input_bns().size()) {
     const Blob* in_i = BnInOp2Blob(GenRepeatedBn("in", i));
     if (i == 0) {
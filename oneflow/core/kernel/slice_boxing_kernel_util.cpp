@@ -14,9 +14,89 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/slice_boxing_kernel_util.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/thread/thread_pool.h"
+#if defined(__AVX__) && defined(__F16C__)
+#include <immintrin.h>
+#endif
 
 namespace oneflow {
 
+namespace {
+
+// The partial out of a block stays in L1 while the inputs are streamed over it
+constexpr int64_t kAddNBlockSize = 2048;
+// A sum reading and writing at least this many bytes per thread is split over the thread pool
+constexpr int64_t kParallelAddNMinBytesPerThread = 4 << 20;
+
+template<typename T>
+void AddNRow(const T* const* ins, int64_t in_num, int64_t n, T* out) {
+  for (int64_t begin = 0; begin < n; begin += kAddNBlockSize) {
+    const int64_t len = std::min(kAddNBlockSize, n - begin);
+    T* out_block = out + begin;
+    const T* in_0 = ins[0] + begin;
+    if (in_num == 1) {
+      std::copy(in_0, in_0 + len, out_block);
+      continue;
+    }
+    const T* in_1 = ins[1] + begin;
+    for (int64_t i = 0; i < len; ++i) { out_block[i] = in_0[i] + in_1[i]; }
+    for (int64_t k = 2; k < in_num; ++k) {
+      const T* in_k = ins[k] + begin;
+      for (int64_t i = 0; i < len; ++i) { out_block[i] += in_k[i]; }
+    }
+  }
+}
+
+void HalfToFloat(const float16* in, int64_t n, float* out) {
+  int64_t i = 0;
+#if defined(__AVX__) && defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(out + i,
+                     _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+  }
+#endif
+  for (; i < n; ++i) { out[i] = static_cast<float>(in[i]); }
+}
+
+void AddHalfToFloat(const float16* in, int64_t n, float* out) {
+  int64_t i = 0;
+#if defined(__AVX__) && defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    const __m256 in_i =
+        _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+    _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), in_i));
+  }
+#endif
+  for (; i < n; ++i) { out[i] += static_cast<float>(in[i]); }
+}
+
+void FloatToHalf(const float* in, int64_t n, float16* out) {
+  int64_t i = 0;
+#if defined(__AVX__) && defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+  }
+#endif
+  for (; i < n; ++i) { out[i] = static_cast<float16>(in[i]); }
+}
+
+// float16 is summed in float and rounded once
+template<>
+void AddNRow<float16>(const float16* const* ins, int64_t in_num, int64_t n, float16* out) {
+  float acc[kAddNBlockSize];
+  for (int64_t begin = 0; begin < n; begin += kAddNBlockSize) {
+    const int64_t len = std::min(kAddNBlockSize, n - begin);
+    HalfToFloat(ins[0] + begin, len, acc);
+    for (int64_t k = 1; k < in_num; ++k) { AddHalfToFloat(ins[k] + begin, len, acc); }
+    FloatToHalf(acc, len, out + begin);
+  }
+}
+
+}  // namespace
+
 template<typename T>
 struct SliceBoxingKernelUtil<DeviceType::kCPU, T> {
   static void Add(DeviceCtx* ctx, int64_t n, const T* a, const T* b, T* out) {
@@ -24,8 +104,98 @@ struct SliceBoxingKernelUtil<DeviceType::kCPU, T> {
   }
 };
 
+SliceBoxingCpuAddN::SliceBoxingCpuAddN(const TensorSliceView& out_view,
+                                       const std::vector<TensorSliceView>& in_views) {
+  CHECK(!in_views.empty());
+  const int64_t num_axes = out_view.NumAxes();
+  for (const TensorSliceView& in_view : in_views) {
+    CHECK_EQ(in_view.NumAxes(), num_axes);
+    CHECK(in_view.Contains(out_view));
+  }
+  // trailing axes covered by every input are merged into the rows
+  int64_t row_begin_axis = num_axes - 1;
+  while (row_begin_axis > 0
+         && std::all_of(in_views.cbegin(), in_views.cend(), [&](const TensorSliceView& in_view) {
+              return in_view.At(row_begin_axis) == out_view.At(row_begin_axis);
+            })) {
+    row_begin_axis -= 1;
+  }
+  row_size_ = out_view.shape().Count(row_begin_axis);
+  row_num_ = out_view.shape().Count(0, row_begin_axis);
+  outer_extent_.assign(out_view.shape().dim_vec().cbegin(),
+                       out_view.shape().dim_vec().cbegin() + row_begin_axis);
+  for (const TensorSliceView& in_view : in_views) {
+    const NdIndex offset = out_view.OffsetTo(in_view);
+    int64_t in_offset = 0;
+    FOR_RANGE(int64_t, i, 0, num_axes) {
+      in_offset += offset.At(i) * in_view.shape().Count(i + 1);
+    }
+    in_offsets_.push_back(in_offset);
+    std::vector<int64_t> strides;
+    FOR_RANGE(int64_t, i, 0, row_begin_axis) { strides.push_back(in_view.shape().Count(i + 1)); }
+    in_outer_strides_.push_back(strides);
+  }
+}
+
+template<typename T>
+void SliceBoxingCpuAddN::Compute(const std::vector<const T*>& ins, T* out) const {
+  CHECK_EQ(ins.size(), in_offsets_.size());
+  int64_t part_num = 1;
+  if (Global<ThreadPool>::Get() != nullptr) {
+    const int64_t byte_size = row_num_ * row_size_ * sizeof(T) * (ins.size() + 1);
+    part_num = std::min<int64_t>(byte_size / kParallelAddNMinBytesPerThread,
+                                 Global<ThreadPool>::Get()->thread_num());
+  }
+  if (part_num <= 1) {
+    ComputeRows(ins, out, 0, row_num_, 0, row_size_);
+  } else if (row_num_ >= part_num) {
+    BalancedSplitter bs(row_num_, part_num);
+    MultiThreadLoop(part_num, [&](size_t i) {
+      ComputeRows(ins, out, bs.At(i).begin(), bs.At(i).end(), 0, row_size_);
+    });
+  } else {
+    BalancedSplitter bs(row_size_, part_num);
+    MultiThreadLoop(part_num, [&](size_t i) {
+      ComputeRows(ins, out, 0, row_num_, bs.At(i).begin(), bs.At(i).end());
+    });
+  }
+}
+
+template<typename T>
+void SliceBoxingCpuAddN::ComputeRows(const std::vector<const T*>& ins, T* out, int64_t row_begin,
+                                     int64_t row_end, int64_t col_begin, int64_t col_end) const {
+  const int64_t in_num = ins.size();
+  const int64_t outer_num_axes = outer_extent_.size();
+  std::vector<int64_t> idx(outer_num_axes);
+  std::vector<const T*> in_rows(in_num);
+  int64_t remaining = row_begin;
+  for (int64_t i = outer_num_axes - 1; i >= 0; --i) {
+    idx[i] = remaining % outer_extent_[i];
+    remaining /= outer_extent_[i];
+  }
+  FOR_RANGE(int64_t, k, 0, in_num) {
+    in_rows[k] = ins[k] + in_offsets_[k] + col_begin;
+    FOR_RANGE(int64_t, i, 0, outer_num_axes) { in_rows[k] += idx[i] * in_outer_strides_[k][i]; }
+  }
+  T* out_row = out + row_begin * row_size_ + col_begin;
+  for (int64_t row = row_begin; row < row_end; ++row) {
+    AddNRow<T>(in_rows.data(), in_num, col_end - col_begin, out_row);
+    out_row += row_size_;
+    for (int64_t i = outer_num_axes - 1; i >= 0; --i) {
+      FOR_RANGE(int64_t, k, 0, in_num) { in_rows[k] += in_outer_strides_[k][i]; }
+      if (++idx[i] < outer_extent_[i]) { break; }
+      FOR_RANGE(int64_t, k, 0, in_num) {
+        in_rows[k] -= in_outer_strides_[k][i] * outer_extent_[i];
+      }
+      idx[i] = 0;
+    }
+  }
+}
+
 #define INSTANTIATE_SLICE_BOXING_KERNEL_UTIL_CPU(type_cpp, type_proto) \
-  template struct SliceBoxingKernelUtil<DeviceType::kCPU, type_cpp>;
+  template struct SliceBoxingKernelUtil<DeviceType::kCPU, type_cpp>;  \
+  template void SliceBoxingCpuAddN::Compute<type_cpp>(const std::vector<const type_cpp*>& ins, \
+                                                       type_cpp* out) const;
 OF_PP_FOR_EACH_TUPLE(INSTANTIATE_SLICE_BOXING_KERNEL_UTIL_CPU,
                      ARITHMETIC_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ);
 #undef INSTANTIATE_SLICE_BOXING_KERNEL_UTIL_CPU
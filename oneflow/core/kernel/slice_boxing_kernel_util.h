@@ -17,6 +17,7 @@ limitations under the License.
 #define ONEFLOW_CORE_KERNEL_SLICE_BOXING_KERNEL_UTIL_H_
 
 #include "oneflow/core/kernel/kernel_util.h"
+#include "oneflow/core/register/tensor_slice_view.h"
 
 namespace oneflow {
 
@@ -25,6 +26,31 @@ struct SliceBoxingKernelUtil {
   static void Add(DeviceCtx* ctx, int64_t n, const T* a, const T* b, T* out);
 };
 
+// Sums all inputs of a cpu slice boxing add into the out slice in one pass, instead of one add
+// per input which rereads the partial out. Every input slice must contain the out slice
+class SliceBoxingCpuAddN final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SliceBoxingCpuAddN);
+  SliceBoxingCpuAddN(const TensorSliceView& out_view, const std::vector<TensorSliceView>& in_views);
+  ~SliceBoxingCpuAddN() = default;
+
+  template<typename T>
+  void Compute(const std::vector<const T*>& ins, T* out) const;
+
+ private:
+  template<typename T>
+  void ComputeRows(const std::vector<const T*>& ins, T* out, int64_t row_begin, int64_t row_end,
+                   int64_t col_begin, int64_t col_end) const;
+
+  // out is walked by rows, a row is contiguous in out and in every input
+  int64_t row_size_;
+  int64_t row_num_;
+  std::vector<int64_t> outer_extent_;
+  // offset of the out slice in each input and the strides of its outer axes, in elements
+  std::vector<int64_t> in_offsets_;
+  std::vector<std::vector<int64_t>> in_outer_strides_;
+};
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CORE_KERNEL_SLICE_BOXING_KERNEL_UTIL_H_
@@ -0,0 +1,44 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/slice_boxing_kernel_util.h"
+
+#include <chrono>
+#include <iostream>
+
+DEFINE_int32(in_num, 8, "number of partial sum inputs.");
+DEFINE_int32(iter_num, 20, "number of sums.");
+
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // the partial sums of 8 devices, each summed into the split of one of them
+  const TensorSliceView in_view({Range(0, 1024), Range(0, 4096)});
+  const TensorSliceView out_view({Range(0, 1024), Range(0, 512)});
+  std::vector<std::vector<float>> ins(FLAGS_in_num,
+                                      std::vector<float>(in_view.shape().elem_cnt(), 1));
+  std::vector<const float*> in_ptrs;
+  for (const auto& in : ins) { in_ptrs.push_back(in.data()); }
+  std::vector<float> out(out_view.shape().elem_cnt());
+  SliceBoxingCpuAddN add_n(out_view, std::vector<TensorSliceView>(FLAGS_in_num, in_view));
+  const auto start = std::chrono::steady_clock::now();
+  FOR_RANGE(int32_t, i, 0, FLAGS_iter_num) { add_n.Compute<float>(in_ptrs, out.data()); }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CHECK_EQ(out.front(), FLAGS_in_num);
+  std::cout << "add " << FLAGS_in_num << " inputs of " << out.size() * sizeof(float)
+            << " bytes: " << seconds * 1e3 / FLAGS_iter_num << " ms" << std::endl;
+  return 0;
+}
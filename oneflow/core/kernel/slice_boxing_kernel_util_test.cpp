@@ -0,0 +1,95 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/slice_boxing_kernel_util.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+int64_t OffsetInView(const TensorSliceView& view, const std::vector<int64_t>& global_idx) {
+  int64_t offset = 0;
+  FOR_RANGE(int64_t, i, 0, view.NumAxes()) {
+    offset = offset * view.At(i).size() + global_idx.at(i) - view.At(i).begin();
+  }
+  return offset;
+}
+
+template<typename T>
+void TestAddN(const TensorSliceView& out_view, const std::vector<TensorSliceView>& in_views) {
+  std::vector<std::vector<T>> ins;
+  std::vector<const T*> in_ptrs;
+  FOR_RANGE(size_t, k, 0, in_views.size()) {
+    ins.emplace_back(in_views.at(k).shape().elem_cnt());
+    FOR_RANGE(size_t, i, 0, ins.back().size()) {
+      ins.back().at(i) = static_cast<T>(static_cast<float>((i * 7 + k * 3) % 11));
+    }
+    in_ptrs.push_back(ins.back().data());
+  }
+  std::vector<T> out(out_view.shape().elem_cnt());
+  SliceBoxingCpuAddN(out_view, in_views).Compute<T>(in_ptrs, out.data());
+  const Shape& out_shape = out_view.shape();
+  FOR_RANGE(int64_t, i, 0, out_shape.elem_cnt()) {
+    std::vector<int64_t> global_idx(out_shape.NumAxes());
+    int64_t remaining = i;
+    for (int64_t axis = out_shape.NumAxes() - 1; axis >= 0; --axis) {
+      global_idx.at(axis) = out_view.At(axis).begin() + remaining % out_shape.At(axis);
+      remaining /= out_shape.At(axis);
+    }
+    float expected = 0;
+    FOR_RANGE(size_t, k, 0, in_views.size()) {
+      expected += static_cast<float>(ins.at(k).at(OffsetInView(in_views.at(k), global_idx)));
+    }
+    ASSERT_EQ(static_cast<float>(out.at(i)), expected);
+  }
+}
+
+template<typename T>
+void TestAddNAllCases() {
+  // partial sum to broadcast
+  TestAddN<T>(TensorSliceView({Range(0, 4), Range(0, 6), Range(0, 5)}),
+              std::vector<TensorSliceView>(3, TensorSliceView({Range(0, 4), Range(0, 6),
+                                                                Range(0, 5)})));
+  // partial sum to split on axis 1
+  TestAddN<T>(TensorSliceView({Range(0, 4), Range(2, 5), Range(0, 5)}),
+              std::vector<TensorSliceView>(4, TensorSliceView({Range(0, 4), Range(0, 6),
+                                                                Range(0, 5)})));
+  // partial sum to split on the last axis, mixed with inputs of the exact out slice
+  TestAddN<T>(TensorSliceView({Range(0, 4), Range(0, 6), Range(1, 3)}),
+              {TensorSliceView({Range(0, 4), Range(0, 6), Range(0, 5)}),
+               TensorSliceView({Range(0, 4), Range(0, 6), Range(1, 3)}),
+               TensorSliceView({Range(0, 4), Range(0, 6), Range(1, 4)})});
+  // one input
+  TestAddN<T>(TensorSliceView({Range(1, 3), Range(0, 6)}),
+              {TensorSliceView({Range(0, 4), Range(0, 6)})});
+  // rows longer than a block
+  TestAddN<T>(TensorSliceView({Range(0, 2), Range(0, 5000)}),
+              std::vector<TensorSliceView>(2, TensorSliceView({Range(0, 3), Range(0, 5000)})));
+}
+
+}  // namespace
+
+TEST(SliceBoxingCpuAddN, add_n) {
+  TestAddNAllCases<float>();
+  TestAddNAllCases<double>();
+  TestAddNAllCases<int32_t>();
+  TestAddNAllCases<float16>();
+}
+
+}  // namespace test
+
+}  // namespace oneflow
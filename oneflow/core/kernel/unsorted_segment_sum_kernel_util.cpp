@@ -14,9 +14,68 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/kernel/unsorted_segment_sum_kernel_util.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
+namespace {
+
+// A sum reading and writing at least this many bytes per thread is split over the thread pool
+constexpr int64_t kParallelSegmentSumMinBytesPerThread = 1 << 20;
+// The segments are cut into this many buckets per part to balance skewed ids over the parts
+constexpr int64_t kSegmentBucketNumPerPart = 64;
+
+template<typename T>
+void AddRow(const T* in, int64_t n, T* out) {
+  for (int64_t i = 0; i < n; ++i) { out[i] += in[i]; }
+}
+
+// Splits the segments into part_num contiguous ranges holding about as many ids each, and lists
+// the positions of the ids of part p, in increasing order, in
+// part_ids[part_id_offsets[p], part_id_offsets[p + 1]). Ids out of the segments are dropped.
+template<typename K>
+void PartitionSegmentIds(const K* segment_ids, int64_t num_segment_ids, int64_t num_segments,
+                         int64_t segment_id_offset, int64_t part_num,
+                         std::vector<int64_t>* part_id_offsets, std::vector<int64_t>* part_ids) {
+  const int64_t bucket_num = std::min(num_segments, part_num * kSegmentBucketNumPerPart);
+  const int64_t bucket_size = (num_segments + bucket_num - 1) / bucket_num;
+  std::vector<int32_t> bucket_of_ids(num_segment_ids, -1);
+  std::vector<int64_t> bucket_id_cnt(bucket_num, 0);
+  int64_t num_valid_ids = 0;
+  FOR_RANGE(int64_t, i, 0, num_segment_ids) {
+    const int64_t idx = segment_ids[i] - segment_id_offset;
+    if (idx < 0 || idx >= num_segments) { continue; }
+    bucket_of_ids.at(i) = idx / bucket_size;
+    bucket_id_cnt.at(idx / bucket_size) += 1;
+    num_valid_ids += 1;
+  }
+  // assigns the buckets in order, moving to the next part once a part has its share of the ids
+  std::vector<int32_t> part_of_buckets(bucket_num);
+  std::vector<int64_t> part_id_cnt(part_num, 0);
+  int64_t part = 0;
+  int64_t assigned = 0;
+  FOR_RANGE(int64_t, b, 0, bucket_num) {
+    part_of_buckets.at(b) = part;
+    part_id_cnt.at(part) += bucket_id_cnt.at(b);
+    assigned += bucket_id_cnt.at(b);
+    if (part + 1 < part_num && assigned * part_num >= num_valid_ids * (part + 1)) { part += 1; }
+  }
+  part_id_offsets->assign(part_num + 1, 0);
+  FOR_RANGE(int64_t, p, 0, part_num) {
+    part_id_offsets->at(p + 1) = part_id_offsets->at(p) + part_id_cnt.at(p);
+  }
+  part_ids->resize(num_valid_ids);
+  std::vector<int64_t> part_pos(part_id_offsets->begin(), part_id_offsets->end() - 1);
+  FOR_RANGE(int64_t, i, 0, num_segment_ids) {
+    if (bucket_of_ids.at(i) == -1) { continue; }
+    part_ids->at(part_pos.at(part_of_buckets.at(bucket_of_ids.at(i)))++) = i;
+  }
+}
+
+}  // namespace
+
 template<typename T, typename K>
 struct UnsortedSegmentSumKernelUtil<DeviceType::kCPU, T, K, T> final {
   static void UnsortedSegmentSum(DeviceCtx* ctx, const K* segment_ids, const T* data,
@@ -30,18 +89,48 @@ void UnsortedSegmentSumKernelUtil<DeviceType::kCPU, T, K, T>::UnsortedSegmentSum
     DeviceCtx* ctx, const K* segment_ids, const T* data, int64_t num_segment_ids,
     int64_t num_segments, int64_t outer_dim_size, int64_t inner_dim_size, int64_t segment_id_offset,
     T* out) {
-  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
-    FOR_RANGE(int64_t, i, 0, num_segment_ids) {
-      CHECK_GE(segment_ids[i], 0);
-      const int64_t idx = segment_ids[i] - segment_id_offset;
-      T* to = out + outer_idx * num_segments * inner_dim_size + idx * inner_dim_size;
-      if (idx >= 0 && idx < num_segments) {
-        const T* from = data + outer_idx * num_segment_ids * inner_dim_size + i * inner_dim_size;
-        std::transform(from, from + inner_dim_size, to, to, std::plus<T>());
+  FOR_RANGE(int64_t, i, 0, num_segment_ids) { CHECK_GE(segment_ids[i], 0); }
+  if (num_segments == 0) { return; }
+  // adds the data rows of ids[0, num_ids) of the outer slices [outer_begin, outer_end), every out
+  // row gets its data rows in the order of segment_ids whatever the split, so the sum is stable
+  auto SumRows = [&](const int64_t* ids, int64_t num_ids, int64_t outer_begin, int64_t outer_end) {
+    FOR_RANGE(int64_t, outer_idx, outer_begin, outer_end) {
+      const T* outer_data = data + outer_idx * num_segment_ids * inner_dim_size;
+      T* outer_out = out + outer_idx * num_segments * inner_dim_size;
+      FOR_RANGE(int64_t, j, 0, num_ids) {
+        const int64_t i = ids == nullptr ? j : ids[j];
+        const int64_t idx = segment_ids[i] - segment_id_offset;
+        if (idx < 0 || idx >= num_segments) { continue; }
+        AddRow(outer_data + i * inner_dim_size, inner_dim_size, outer_out + idx * inner_dim_size);
       }
     }
+  };
+  int64_t part_num = 1;
+  if (Global<ThreadPool>::Get() != nullptr) {
+    const int64_t byte_size = outer_dim_size * num_segment_ids * inner_dim_size * sizeof(T) * 2;
+    part_num = std::min<int64_t>(byte_size / kParallelSegmentSumMinBytesPerThread,
+                                 Global<ThreadPool>::Get()->thread_num());
+  }
+  if (part_num <= 1) {
+    SumRows(nullptr, num_segment_ids, 0, outer_dim_size);
+  } else if (outer_dim_size >= part_num) {
+    BalancedSplitter bs(outer_dim_size, part_num);
+    MultiThreadLoop(part_num, [&](size_t i) {
+      SumRows(nullptr, num_segment_ids, bs.At(i).begin(), bs.At(i).end());
+    });
+  } else {
+    // every thread owns a range of out rows, so no two threads ever add to the same row
+    std::vector<int64_t> part_id_offsets;
+    std::vector<int64_t> part_ids;
+    PartitionSegmentIds(segment_ids, num_segment_ids, num_segments, segment_id_offset, part_num,
+                        &part_id_offsets, &part_ids);
+    MultiThreadLoop(part_num, [&](size_t i) {
+      SumRows(part_ids.data() + part_id_offsets.at(i),
+              part_id_offsets.at(i + 1) - part_id_offsets.at(i), 0, outer_dim_size);
+    });
   }
 }
+
 #define INITIATE_UNSORTED_SEGMENT_SUM_KERNEL_UTIL_CPU(in_type_pair, index_type_pair)             \
   template struct UnsortedSegmentSumKernelUtil<DeviceType::kCPU, OF_PP_PAIR_FIRST(in_type_pair), \
                                                OF_PP_PAIR_FIRST(index_type_pair),                \
@@ -0,0 +1,92 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/unsorted_segment_sum_kernel_util.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include <cmath>
+#include <random>
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// ids of an embedding lookup, a few hot ids and a long tail, following Zipf's law
+std::vector<int32_t> ZipfIds(int64_t num_ids, int64_t vocab_size, double exponent) {
+  std::vector<double> cdf(vocab_size);
+  double sum = 0;
+  FOR_RANGE(int64_t, i, 0, vocab_size) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+    cdf.at(i) = sum;
+  }
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> dis(0, sum);
+  std::vector<int32_t> ids(num_ids);
+  for (int32_t& id : ids) {
+    id = std::min<int64_t>(std::lower_bound(cdf.begin(), cdf.end(), dis(gen)) - cdf.begin(),
+                           vocab_size - 1);
+  }
+  return ids;
+}
+
+void TestUnsortedSegmentSum(int64_t outer_dim_size, int64_t num_segments, int64_t inner_dim_size,
+                            int64_t num_segment_ids, int64_t offset) {
+  // ids of the whole table, this part holds [offset, offset + num_segments)
+  const std::vector<int32_t> segment_ids = ZipfIds(num_segment_ids, num_segments * 2, 1.05);
+  std::vector<float> data(outer_dim_size * num_segment_ids * inner_dim_size);
+  FOR_RANGE(size_t, i, 0, data.size()) { data.at(i) = static_cast<float>(i % 1009) / 7; }
+  std::vector<float> out(outer_dim_size * num_segments * inner_dim_size, 0);
+  UnsortedSegmentSumKernelUtil<DeviceType::kCPU, float, int32_t, float>::UnsortedSegmentSum(
+      nullptr, segment_ids.data(), data.data(), num_segment_ids, num_segments, outer_dim_size,
+      inner_dim_size, offset, out.data());
+  // adding in the order of the ids gives the same bits whatever the split
+  std::vector<float> expected(out.size(), 0);
+  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
+    FOR_RANGE(int64_t, i, 0, num_segment_ids) {
+      const int64_t idx = segment_ids.at(i) - offset;
+      if (idx < 0 || idx >= num_segments) { continue; }
+      FOR_RANGE(int64_t, j, 0, inner_dim_size) {
+        expected.at((outer_idx * num_segments + idx) * inner_dim_size + j) +=
+            data.at((outer_idx * num_segment_ids + i) * inner_dim_size + j);
+      }
+    }
+  }
+  ASSERT_EQ(out, expected);
+}
+
+void TestUnsortedSegmentSumAllCases() {
+  TestUnsortedSegmentSum(1, 100, 16, 1000, 0);
+  TestUnsortedSegmentSum(3, 100, 7, 1000, 50);
+  // split by out rows
+  TestUnsortedSegmentSum(1, 1000, 64, 20000, 0);
+  TestUnsortedSegmentSum(1, 3, 64, 20000, 2);
+  TestUnsortedSegmentSum(2, 1000, 64, 20000, 300);
+  // split by outer slices
+  TestUnsortedSegmentSum(8, 1000, 64, 5000, 0);
+}
+
+}  // namespace
+
+TEST(UnsortedSegmentSumKernelUtil, cpu_unsorted_segment_sum) {
+  TestUnsortedSegmentSumAllCases();
+  Global<ThreadPool>::New(4);
+  TestUnsortedSegmentSumAllCases();
+  Global<ThreadPool>::Delete();
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -21,9 +21,57 @@ limitations under the License.
 #include "oneflow/core/register/blob.h"
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/record/record.pb.h"
+#include "oneflow/core/profiler/metrics.h"
+#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/common/balanced_splitter.h"
 
 namespace oneflow {
 
+namespace {
+
+std::string MemZoneName(const MemoryCase& mem_case) {
+  if (mem_case.has_host_mem()) {
+    if (mem_case.host_mem().has_cuda_pinned_mem()) {
+      const int64_t device_id = mem_case.host_mem().cuda_pinned_mem().device_id();
+      return "cuda_pinned_host_" + std::to_string(device_id);
+    } else {
+      return "host";
+    }
+  } else if (mem_case.has_device_cuda_mem()) {
+    return "gpu_" + std::to_string(mem_case.device_cuda_mem().device_id());
+  } else {
+    UNIMPLEMENTED();
+    return "";
+  }
+}
+
+void CollectAllocationMetrics(const MemoryCase& mem_case, std::size_t size) {
+  auto* registry = Global<profiler::MetricsRegistry>::Get();
+  if (registry == nullptr) { return; }
+  const std::string labels = profiler::MetricsLabel("mem_zone", MemZoneName(mem_case));
+  registry->MutCounter("memory_allocator_allocated_bytes", labels)->Add(size);
+  registry->MutCounter("memory_allocator_allocation_cnt", labels)->Add(1);
+}
+
+// Pinned memory is already touched by cudaMallocHost, so zeroing a large chunk is split over the
+// compute thread pool instead of being done by a single memset.
+void MemsetPinnedHostMem(char* dptr, int value, size_t size) {
+  const size_t kParallelMemsetMinSize = 64 << 20;
+  if (size < kParallelMemsetMinSize || Global<ThreadPool>::Get() == nullptr) {
+    memset(dptr, value, size);
+    return;
+  }
+  const int64_t part_num =
+      std::min<int64_t>(size / kParallelMemsetMinSize, Global<ThreadPool>::Get()->thread_num());
+  BalancedSplitter bs(size, part_num);
+  MultiThreadLoop(part_num, [&](size_t i) {
+    const Range range = bs.At(i);
+    memset(dptr + range.begin(), value, range.size());
+  });
+}
+
+}  // namespace
+
 void* MemoryAllocatorImpl::Allocate(MemoryCase mem_case, size_t size) {
   void* ptr = nullptr;
   if (mem_case.has_host_mem()) {
@@ -91,20 +139,32 @@ MemoryAllocator::~MemoryAllocator() {
 
 char* MemoryAllocator::Allocate(MemoryCase mem_case, std::size_t size) {
   const int memset_val = 0;
-  char* dptr = static_cast<char*>(MemoryAllocatorImpl::Allocate(mem_case, size));
-  if (mem_case.has_host_mem()) {
-    memset(dptr, memset_val, size);
-  } else if (mem_case.has_device_cuda_mem()) {
+  char* dptr = nullptr;
+  if (mem_case.has_host_mem() && !mem_case.host_mem().has_cuda_pinned_mem()) {
+    // large blocks are mmapped by calloc and the kernel hands out zero pages on first touch, so
+    // the memory is neither zeroed eagerly nor faulted in by this thread, but by its users
+    dptr = static_cast<char*>(calloc(size, 1));
+    CHECK_NOTNULL(dptr);
+  } else {
+    dptr = static_cast<char*>(MemoryAllocatorImpl::Allocate(mem_case, size));
+    if (mem_case.has_host_mem()) {
+      MemsetPinnedHostMem(dptr, memset_val, size);
+    } else if (mem_case.has_device_cuda_mem()) {
 #ifdef WITH_CUDA
-    CudaCurrentDeviceGuard guard(mem_case.device_cuda_mem().device_id());
-    OF_CUDA_CHECK(cudaMemset(dptr, memset_val, size));
+      CudaCurrentDeviceGuard guard(mem_case.device_cuda_mem().device_id());
+      OF_CUDA_CHECK(cudaMemset(dptr, memset_val, size));
 #else
-    UNIMPLEMENTED();
+      UNIMPLEMENTED();
 #endif
-  } else {
-    UNIMPLEMENTED();
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock(deleters_mutex_);
+    deleters_.push_front(std::bind(&MemoryAllocator::Deallocate, this, dptr, mem_case));
   }
-  deleters_.push_front(std::bind(&MemoryAllocator::Deallocate, this, dptr, mem_case));
+  CollectAllocationMetrics(mem_case, size);
   return dptr;
 }
 
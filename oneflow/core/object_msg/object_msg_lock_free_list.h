@@ -0,0 +1,258 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_OBJECT_MSG_LOCK_FREE_LIST_H_
+#define ONEFLOW_CORE_OBJECT_MSG_LOCK_FREE_LIST_H_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "oneflow/core/object_msg/object_msg_list.h"
+#include "oneflow/core/object_msg/object_msg_condition_list.h"
+
+namespace oneflow {
+
+#define OBJECT_MSG_DEFINE_LOCK_FREE_LIST_HEAD(elem_type, elem_field_name, field_name)           \
+  static_assert(__is_object_message_type__, "this struct is not a object message");             \
+  static_assert(!std::is_same<self_type, elem_type>::value, "self loop link is not supported"); \
+  OF_PRIVATE INCREASE_STATIC_COUNTER(field_counter);                                            \
+  _OBJECT_MSG_DEFINE_LOCK_FREE_LIST_HEAD(STATIC_COUNTER(field_counter), elem_type,              \
+                                         elem_field_name, field_name);
+
+#define OBJECT_MSG_LOCK_FREE_LIST(obj_msg_type, obj_msg_field)                              \
+  ObjectMsgLockFreeList<StructField<OBJECT_MSG_TYPE_CHECK(obj_msg_type), EmbeddedListLink, \
+                                    OBJECT_MSG_TYPE_CHECK(obj_msg_type)::OF_PP_CAT(        \
+                                        obj_msg_field, _kDssFieldOffset)>>
+
+// details
+
+#define _OBJECT_MSG_DEFINE_LOCK_FREE_LIST_HEAD(field_counter, elem_type, elem_field_name,      \
+                                               field_name)                                     \
+  _OBJECT_MSG_DEFINE_LOCK_FREE_LIST_HEAD_FIELD(elem_type, elem_field_name, field_name)         \
+  OBJECT_MSG_DEFINE_LOCK_FREE_LIST_ELEM_STRUCT(field_counter, elem_type, elem_field_name,      \
+                                               field_name);                                    \
+  OBJECT_MSG_DEFINE_LOCK_FREE_LIST_LINK_EDGES(field_counter, elem_type, elem_field_name,       \
+                                              field_name);                                     \
+  OBJECT_MSG_OVERLOAD_INIT(field_counter, ObjectMsgEmbeddedLockFreeListHeadInit);              \
+  OBJECT_MSG_OVERLOAD_DELETE(field_counter, ObjectMsgEmbeddedLockFreeListHeadDelete);          \
+  DSS_DEFINE_FIELD(field_counter, "object message", OF_PP_CAT(field_name, _ObjectMsgListType), \
+                   OF_PP_CAT(field_name, _));
+
+#define _OBJECT_MSG_DEFINE_LOCK_FREE_LIST_HEAD_FIELD(elem_type, elem_field_name, field_name)   \
+ public:                                                                                       \
+  using OF_PP_CAT(field_name, _ObjectMsgListType) = TrivialObjectMsgLockFreeList<StructField< \
+      OBJECT_MSG_TYPE_CHECK(elem_type), EmbeddedListLink,                                      \
+      OBJECT_MSG_TYPE_CHECK(elem_type)::OF_PP_CAT(elem_field_name, _kDssFieldOffset)>>;        \
+  const OF_PP_CAT(field_name, _ObjectMsgListType) & field_name() const {                       \
+    return OF_PP_CAT(field_name, _);                                                           \
+  }                                                                                            \
+  OF_PP_CAT(field_name, _ObjectMsgListType) * OF_PP_CAT(mut_, field_name)() {                  \
+    return &OF_PP_CAT(field_name, _);                                                          \
+  }                                                                                            \
+  OF_PP_CAT(field_name, _ObjectMsgListType) * OF_PP_CAT(mutable_, field_name)() {              \
+    return &OF_PP_CAT(field_name, _);                                                          \
+  }                                                                                            \
+                                                                                               \
+ private:                                                                                      \
+  OF_PP_CAT(field_name, _ObjectMsgListType) OF_PP_CAT(field_name, _);
+
+#define OBJECT_MSG_DEFINE_LOCK_FREE_LIST_ELEM_STRUCT(field_counter, elem_type, elem_field_name, \
+                                                     field_name)                                \
+ public:                                                                                        \
+  template<typename Enabled>                                                                    \
+  struct ContainerElemStruct<field_counter, Enabled> final {                                    \
+    using type = elem_type;                                                                     \
+  };
+
+#define OBJECT_MSG_DEFINE_LOCK_FREE_LIST_LINK_EDGES(field_counter, elem_type, elem_field_name, \
+                                                    field_name)                                \
+ public:                                                                                       \
+  template<typename Enable>                                                                    \
+  struct LinkEdgesGetter<field_counter, Enable> final {                                        \
+    static void Call(std::set<ObjectMsgContainerLinkEdge>* edges) {                            \
+      ObjectMsgContainerLinkEdge edge;                                                         \
+      edge.container_type_name = typeid(self_type).name();                                     \
+      edge.container_field_name = OF_PP_STRINGIZE(field_name) "_";                             \
+      edge.elem_type_name = typeid(elem_type).name();                                          \
+      edge.elem_link_name = OF_PP_STRINGIZE(elem_field_name) "_";                              \
+      edges->insert(edge);                                                                     \
+    }                                                                                          \
+  };
+
+template<typename WalkCtxType, typename PtrFieldType>
+struct ObjectMsgEmbeddedLockFreeListHeadInit {
+  static void Call(WalkCtxType* ctx, PtrFieldType* field) { field->__Init__(); }
+};
+
+template<typename WalkCtxType, typename PtrFieldType>
+struct ObjectMsgEmbeddedLockFreeListHeadDelete {
+  static void Call(WalkCtxType* ctx, PtrFieldType* field) { field->__Delete__(); }
+};
+
+// Multi-producer single-consumer list. Producers push elements onto a lock-free stack chained
+// through the next pointers of their list links, the consumer takes the whole stack at once and
+// restores the FIFO order. An empty consumer spins for a while before parking on a condition
+// variable, and producers only touch the mutex when the consumer is parked.
+template<typename LinkField>
+class TrivialObjectMsgLockFreeList {
+ public:
+  using value_type = typename LinkField::struct_type;
+
+  void __Init__() {
+    new (&top_) std::atomic<EmbeddedListLink*>(nullptr);
+    new (&is_parked_) std::atomic<bool>(false);
+    new (&is_closed_) std::atomic<bool>(false);
+    new (mutex_buff_) std::mutex();
+    new (cond_buff_) std::condition_variable();
+  }
+
+  bool Empty() const { return top_.load() == nullptr; }
+
+  ObjectMsgConditionListStatus EmplaceBack(ObjectMsgPtr<value_type>&& ptr) {
+    if (is_closed_.load()) { return kObjectMsgConditionListStatusErrorClosed; }
+    value_type* raw_ptr = nullptr;
+    ptr.__UnsafeMoveTo__(&raw_ptr);
+    EmbeddedListLink* link = LinkField::FieldPtr4StructPtr(raw_ptr);
+    Push(link, link);
+    return kObjectMsgConditionListStatusSuccess;
+  }
+  ObjectMsgConditionListStatus PushBack(value_type* ptr) {
+    return EmplaceBack(ObjectMsgPtr<value_type>(ptr));
+  }
+
+  ObjectMsgConditionListStatus MoveFrom(
+      TrivialObjectMsgList<kDisableSelfLoopLink, LinkField>* src) {
+    if (is_closed_.load()) { return kObjectMsgConditionListStatusErrorClosed; }
+    if (src->empty()) { return kObjectMsgConditionListStatusSuccess; }
+    // chain the elements of src newest first, the oldest one is linked to the stack top in Push
+    EmbeddedListLink* first = nullptr;
+    EmbeddedListLink* last = nullptr;
+    while (!src->empty()) {
+      value_type* raw_ptr = nullptr;
+      src->PopFront().__UnsafeMoveTo__(&raw_ptr);
+      EmbeddedListLink* link = LinkField::FieldPtr4StructPtr(raw_ptr);
+      if (first == nullptr) {
+        first = link;
+      } else {
+        link->set_next(last);
+      }
+      last = link;
+    }
+    Push(first, last);
+    return kObjectMsgConditionListStatusSuccess;
+  }
+
+  ObjectMsgConditionListStatus MoveTo(TrivialObjectMsgList<kDisableSelfLoopLink, LinkField>* dst) {
+    for (int64_t i = 0; Empty() && !is_closed_.load(); ++i) {
+      if (i >= kSpinCount) { Park(); }
+    }
+    if (Empty()) { return kObjectMsgConditionListStatusErrorClosed; }
+    PopAllToDstBack(dst);
+    return kObjectMsgConditionListStatusSuccess;
+  }
+
+  ObjectMsgConditionListStatus TryMoveTo(
+      TrivialObjectMsgList<kDisableSelfLoopLink, LinkField>* dst) {
+    PopAllToDstBack(dst);
+    return kObjectMsgConditionListStatusSuccess;
+  }
+
+  void Close() {
+    is_closed_.store(true);
+    std::unique_lock<std::mutex> lock(*mut_mutex());
+    mut_cond()->notify_all();
+  }
+
+  void __Delete__() {
+    EmbeddedListLink* link = top_.exchange(nullptr);
+    while (link != nullptr) {
+      EmbeddedListLink* next = link->next();
+      link->Clear();
+      ObjectMsgPtrUtil::ReleaseRef(LinkField::StructPtr4FieldPtr(link));
+      link = next;
+    }
+    using namespace std;
+    mut_mutex()->mutex::~mutex();
+    mut_cond()->condition_variable::~condition_variable();
+  }
+
+ private:
+  static const int64_t kSpinCount = 2048;
+
+  // first is the oldest element of the pushed chain and last the newest one
+  void Push(EmbeddedListLink* first, EmbeddedListLink* last) {
+    EmbeddedListLink* top = top_.load();
+    do { first->set_next(top); } while (!top_.compare_exchange_weak(top, last));
+    if (is_parked_.load()) {
+      std::unique_lock<std::mutex> lock(*mut_mutex());
+      mut_cond()->notify_one();
+    }
+  }
+
+  void Park() {
+    std::unique_lock<std::mutex> lock(*mut_mutex());
+    is_parked_.store(true);
+    mut_cond()->wait(lock, [this]() { return !Empty() || is_closed_.load(); });
+    is_parked_.store(false);
+  }
+
+  void PopAllToDstBack(TrivialObjectMsgList<kDisableSelfLoopLink, LinkField>* dst) {
+    EmbeddedListLink* link = top_.exchange(nullptr);
+    // reverse the stack into arrival order
+    EmbeddedListLink* oldest = nullptr;
+    while (link != nullptr) {
+      EmbeddedListLink* next = link->next();
+      link->set_next(oldest);
+      oldest = link;
+      link = next;
+    }
+    while (oldest != nullptr) {
+      EmbeddedListLink* next = oldest->next();
+      oldest->Clear();
+      dst->EmplaceBack(
+          ObjectMsgPtr<value_type>::__UnsafeMove__(LinkField::StructPtr4FieldPtr(oldest)));
+      oldest = next;
+    }
+  }
+
+  std::mutex* mut_mutex() { return reinterpret_cast<std::mutex*>(&mutex_buff_[0]); }
+  std::condition_variable* mut_cond() {
+    return reinterpret_cast<std::condition_variable*>(&cond_buff_[0]);
+  }
+
+  std::atomic<EmbeddedListLink*> top_;
+  std::atomic<bool> is_parked_;
+  std::atomic<bool> is_closed_;
+  union {
+    char mutex_buff_[sizeof(std::mutex)];
+    int64_t mutex_buff_align_;
+  };
+  union {
+    char cond_buff_[sizeof(std::condition_variable)];
+    int64_t cond_buff_align_;
+  };
+};
+
+template<typename LinkField>
+class ObjectMsgLockFreeList : public TrivialObjectMsgLockFreeList<LinkField> {
+ public:
+  ObjectMsgLockFreeList(const ObjectMsgLockFreeList&) = delete;
+  ObjectMsgLockFreeList(ObjectMsgLockFreeList&&) = delete;
+  ObjectMsgLockFreeList() { this->__Init__(); }
+  ~ObjectMsgLockFreeList() { this->__Delete__(); }
+};
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_OBJECT_MSG_LOCK_FREE_LIST_H_
@@ -0,0 +1,132 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/object_msg/object_msg.h"
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/range.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// clang-format off
+OBJECT_MSG_BEGIN(Foo);
+  // fields
+  OBJECT_MSG_DEFINE_OPTIONAL(int, sender);
+  OBJECT_MSG_DEFINE_OPTIONAL(int, x);
+
+  // links
+  OBJECT_MSG_DEFINE_LIST_LINK(link);
+OBJECT_MSG_END(Foo);
+// clang-format on
+
+// clang-format off
+OBJECT_MSG_BEGIN(FooList);
+  // links
+  OBJECT_MSG_DEFINE_LOCK_FREE_LIST_HEAD(Foo, link, list);
+OBJECT_MSG_END(FooList);
+// clang-format on
+
+using LockFreeListFoo = OBJECT_MSG_LOCK_FREE_LIST(Foo, link);
+
+ObjectMsgPtr<Foo> NewFoo(int sender, int x) {
+  auto foo = ObjectMsgPtr<Foo>::New();
+  foo->set_sender(sender);
+  foo->set_x(x);
+  return foo;
+}
+
+void CallFromSenderThreadByEmplaceBack(LockFreeListFoo* lock_free_list, int sender, Range range) {
+  for (int i = range.begin(); i < range.end(); ++i) {
+    CHECK_EQ(lock_free_list->EmplaceBack(NewFoo(sender, i)), kObjectMsgConditionListStatusSuccess);
+  }
+}
+
+void CallFromSenderThreadByMoveFrom(LockFreeListFoo* lock_free_list, int sender, Range range) {
+  const int batch_size = 7;
+  for (int i = range.begin(); i < range.end(); i += batch_size) {
+    OBJECT_MSG_LIST(Foo, link) batch;
+    for (int j = i; j < std::min(i + batch_size, static_cast<int>(range.end())); ++j) {
+      batch.EmplaceBack(NewFoo(sender, j));
+    }
+    CHECK_EQ(lock_free_list->MoveFrom(&batch), kObjectMsgConditionListStatusSuccess);
+    CHECK(batch.empty());
+  }
+}
+
+typedef void (*SenderHandlerType)(LockFreeListFoo* lock_free_list, int sender, Range range);
+
+void TestLockFreeList(SenderHandlerType SenderHandler) {
+  LockFreeListFoo lock_free_list;
+  int sender_num = 30;
+  int range_num = 2000;
+  // the single receiver must see the elements of every sender in sending order
+  std::vector<int> next_x(sender_num, 0);
+  std::thread receiver([&]() {
+    OBJECT_MSG_LIST(Foo, link) tmp_list;
+    while (lock_free_list.MoveTo(&tmp_list) == kObjectMsgConditionListStatusSuccess) {
+      OBJECT_MSG_LIST_FOR_EACH_PTR(&tmp_list, foo) {
+        CHECK_EQ(foo->x(), next_x.at(foo->sender()));
+        ++next_x.at(foo->sender());
+        tmp_list.Erase(foo);
+      }
+    }
+  });
+  std::vector<std::thread> senders;
+  for (int i = 0; i < sender_num; ++i) {
+    senders.push_back(std::thread(SenderHandler, &lock_free_list, i, Range(0, range_num)));
+  }
+  for (std::thread& this_thread : senders) { this_thread.join(); }
+  lock_free_list.Close();
+  receiver.join();
+  ASSERT_TRUE(lock_free_list.Empty());
+  for (int i = 0; i < sender_num; ++i) { ASSERT_EQ(next_x.at(i), range_num); }
+}
+
+TEST(ObjectMsgLockFreeList, 30sender1receiver_emplace_back) {
+  TestLockFreeList(&CallFromSenderThreadByEmplaceBack);
+}
+
+TEST(ObjectMsgLockFreeList, 30sender1receiver_move_from) {
+  TestLockFreeList(&CallFromSenderThreadByMoveFrom);
+}
+
+TEST(ObjectMsgLockFreeList, try_move_to) {
+  auto foo_list = ObjectMsgPtr<FooList>::New();
+  OBJECT_MSG_LIST(Foo, link) tmp_list;
+  ASSERT_EQ(foo_list->mut_list()->TryMoveTo(&tmp_list), kObjectMsgConditionListStatusSuccess);
+  ASSERT_TRUE(tmp_list.empty());
+  foo_list->mut_list()->EmplaceBack(NewFoo(0, 0));
+  foo_list->mut_list()->EmplaceBack(NewFoo(0, 1));
+  ASSERT_FALSE(foo_list->list().Empty());
+  ASSERT_EQ(foo_list->mut_list()->TryMoveTo(&tmp_list), kObjectMsgConditionListStatusSuccess);
+  ASSERT_TRUE(foo_list->list().Empty());
+  ASSERT_EQ(tmp_list.size(), 2);
+  ASSERT_EQ(tmp_list.Begin()->x(), 0);
+  ASSERT_EQ(tmp_list.Last()->x(), 1);
+  // elements left in a closed list are released with it
+  foo_list->mut_list()->EmplaceBack(NewFoo(0, 2));
+  foo_list->mut_list()->Close();
+  ASSERT_EQ(foo_list->mut_list()->EmplaceBack(NewFoo(0, 3)),
+            kObjectMsgConditionListStatusErrorClosed);
+}
+
+}  // namespace
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -0,0 +1,190 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/profiler/metrics.h"
+#include <sstream>
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace {
+
+std::string MetricName(const std::string& name, const std::string& labels) {
+  if (labels.empty()) { return name; }
+  return name + "{" + labels + "}";
+}
+
+std::string MetricName(const std::string& name, const std::string& labels,
+                       const std::string& extra_label) {
+  if (labels.empty()) { return name + "{" + extra_label + "}"; }
+  return name + "{" + labels + "," + extra_label + "}";
+}
+
+}  // namespace
+
+MetricsHistogram::MetricsHistogram() : sum_(0), count_(0) {
+  for (auto& bucket : buckets_) { bucket.store(0, std::memory_order_relaxed); }
+}
+
+void MetricsHistogram::Observe(int64_t val) {
+  int32_t idx = 0;
+  if (val > 1) { idx = std::min<int32_t>(64 - __builtin_clzll(val - 1), kBucketNum - 1); }
+  buckets_[idx].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(val, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricsRegistry::MetricsRegistry(const std::string& dump_path, int64_t dump_interval_ms)
+    : dump_path_(dump_path), dump_interval_ms_(dump_interval_ms), dump_thread_stop_(false) {
+  if (!dump_path_.empty() && dump_interval_ms_ > 0) {
+    dump_thread_ = std::thread(&MetricsRegistry::PeriodicDump, this);
+  }
+}
+
+MetricsRegistry::~MetricsRegistry() {
+  if (dump_thread_.joinable()) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      dump_thread_stop_ = true;
+    }
+    dump_thread_cond_.notify_all();
+    dump_thread_.join();
+  }
+  if (!dump_path_.empty()) { DumpToFile(dump_path_); }
+}
+
+void MetricsRegistry::PeriodicDump() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      dump_thread_cond_.wait_for(lock, std::chrono::milliseconds(dump_interval_ms_),
+                                 [this]() { return dump_thread_stop_; });
+      if (dump_thread_stop_) { break; }
+    }
+    DumpToFile(dump_path_);
+  }
+}
+
+MetricsRegistry::MetricFamily* MetricsRegistry::MutFamily(const std::string& name,
+                                                          MetricType type) {
+  auto it = name2family_.find(name);
+  if (it == name2family_.end()) {
+    it = name2family_.emplace(name, MetricFamily()).first;
+    it->second.type = type;
+  }
+  CHECK_EQ(it->second.type, type) << "metric " << name << " registered with another type";
+  return &it->second;
+}
+
+MetricsCounter* MetricsRegistry::MutCounter(const std::string& name, const std::string& labels) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto* counters = &MutFamily(name, kCounter)->counters;
+  auto it = counters->find(labels);
+  if (it == counters->end()) {
+    it = counters->emplace(labels, std::unique_ptr<MetricsCounter>(new MetricsCounter())).first;
+  }
+  return it->second.get();
+}
+
+MetricsGauge* MetricsRegistry::MutGauge(const std::string& name, const std::string& labels) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto* gauges = &MutFamily(name, kGauge)->gauges;
+  auto it = gauges->find(labels);
+  if (it == gauges->end()) {
+    it = gauges->emplace(labels, std::unique_ptr<MetricsGauge>(new MetricsGauge())).first;
+  }
+  return it->second.get();
+}
+
+MetricsHistogram* MetricsRegistry::MutHistogram(const std::string& name,
+                                                const std::string& labels) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto* histograms = &MutFamily(name, kHistogram)->histograms;
+  auto it = histograms->find(labels);
+  if (it == histograms->end()) {
+    it = histograms->emplace(labels, std::unique_ptr<MetricsHistogram>(new MetricsHistogram()))
+             .first;
+  }
+  return it->second.get();
+}
+
+std::string MetricsRegistry::DumpText() const {
+  std::ostringstream oss;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (const auto& pair : name2family_) {
+    const std::string& name = pair.first;
+    const MetricFamily& family = pair.second;
+    if (family.type == kCounter) {
+      oss << "# TYPE " << name << " counter\n";
+      for (const auto& c : family.counters) {
+        oss << MetricName(name, c.first) << " " << c.second->value() << "\n";
+      }
+    } else if (family.type == kGauge) {
+      oss << "# TYPE " << name << " gauge\n";
+      for (const auto& g : family.gauges) {
+        oss << MetricName(name, g.first) << " " << g.second->value() << "\n";
+      }
+    } else if (family.type == kHistogram) {
+      oss << "# TYPE " << name << " histogram\n";
+      for (const auto& h : family.histograms) {
+        const MetricsHistogram& histogram = *h.second;
+        int64_t cumulative_cnt = 0;
+        FOR_RANGE(int32_t, i, 0, MetricsHistogram::kBucketNum - 1) {
+          cumulative_cnt += histogram.bucket_cnt(i);
+          oss << MetricName(name + "_bucket", h.first,
+                            MetricsLabel("le", MetricsHistogram::BucketUpperBound(i)))
+              << " " << cumulative_cnt << "\n";
+        }
+        cumulative_cnt += histogram.bucket_cnt(MetricsHistogram::kBucketNum - 1);
+        oss << MetricName(name + "_bucket", h.first, "le=\"+Inf\"") << " " << cumulative_cnt
+            << "\n";
+        oss << MetricName(name + "_sum", h.first) << " " << histogram.sum() << "\n";
+        oss << MetricName(name + "_count", h.first) << " " << histogram.count() << "\n";
+      }
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+  return oss.str();
+}
+
+void MetricsRegistry::DumpToFile(const std::string& path) const {
+  // write to a temporary file first so that scrapers never see a partially written dump
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::out | std::ios::trunc);
+    if (!ofs.is_open()) {
+      LOG(WARNING) << "failed to open runtime metrics dump file " << tmp_path;
+      return;
+    }
+    ofs << DumpText();
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "failed to rename runtime metrics dump file " << tmp_path << " to " << path;
+  }
+}
+
+std::string MetricsLabel(const std::string& key, const std::string& val) {
+  return key + "=\"" + val + "\"";
+}
+
+std::string MetricsLabel(const std::string& key, int64_t val) {
+  return MetricsLabel(key, std::to_string(val));
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
@@ -0,0 +1,125 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PROFILER_METRICS_H_
+#define ONEFLOW_CORE_PROFILER_METRICS_H_
+
+#include <array>
+#include <map>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+// All metrics are updated with relaxed atomics. A metric is normally owned by a single actor or
+// thread, so updates stay in the writer's cache and only the dumper pays for the cross-core read.
+
+class MetricsCounter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MetricsCounter);
+  MetricsCounter() : value_(0) {}
+  ~MetricsCounter() = default;
+
+  void Add(int64_t val) { value_.fetch_add(val, std::memory_order_relaxed); }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_;
+};
+
+class MetricsGauge final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MetricsGauge);
+  MetricsGauge() : value_(0) {}
+  ~MetricsGauge() = default;
+
+  void Set(int64_t val) { value_.store(val, std::memory_order_relaxed); }
+  void Add(int64_t val) { value_.fetch_add(val, std::memory_order_relaxed); }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_;
+};
+
+// Histogram of non-negative integer samples (usually microseconds) with power-of-two buckets:
+// bucket i counts samples in (2^(i-1), 2^i], the last bucket counts everything above.
+class MetricsHistogram final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MetricsHistogram);
+  static const int32_t kBucketNum = 32;
+  MetricsHistogram();
+  ~MetricsHistogram() = default;
+
+  void Observe(int64_t val);
+  int64_t bucket_cnt(int32_t idx) const { return buckets_[idx].load(std::memory_order_relaxed); }
+  int64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  int64_t count() const { return count_.load(std::memory_order_relaxed); }
+  static int64_t BucketUpperBound(int32_t idx) { return int64_t(1) << idx; }
+
+ private:
+  std::array<std::atomic<int64_t>, kBucketNum> buckets_;
+  std::atomic<int64_t> sum_;
+  std::atomic<int64_t> count_;
+};
+
+// Process wide registry of runtime metrics. Metrics are identified by a family name and a label
+// string such as `actor_id="12",op_name="conv1"`. Lookups take a lock, so callers are expected to
+// resolve their metrics once and keep the returned pointers, which stay valid until the registry
+// is destroyed.
+class MetricsRegistry final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MetricsRegistry);
+  MetricsRegistry() : MetricsRegistry("", 0) {}
+  MetricsRegistry(const std::string& dump_path, int64_t dump_interval_ms);
+  ~MetricsRegistry();
+
+  MetricsCounter* MutCounter(const std::string& name, const std::string& labels);
+  MetricsGauge* MutGauge(const std::string& name, const std::string& labels);
+  MetricsHistogram* MutHistogram(const std::string& name, const std::string& labels);
+
+  // Prometheus text exposition format
+  std::string DumpText() const;
+  void DumpToFile(const std::string& path) const;
+
+ private:
+  enum MetricType { kCounter = 0, kGauge, kHistogram };
+  struct MetricFamily {
+    MetricType type;
+    std::map<std::string, std::unique_ptr<MetricsCounter>> counters;
+    std::map<std::string, std::unique_ptr<MetricsGauge>> gauges;
+    std::map<std::string, std::unique_ptr<MetricsHistogram>> histograms;
+  };
+  MetricFamily* MutFamily(const std::string& name, MetricType type);
+  void PeriodicDump();
+
+  mutable std::mutex mutex_;
+  std::map<std::string, MetricFamily> name2family_;
+
+  std::string dump_path_;
+  int64_t dump_interval_ms_;
+  bool dump_thread_stop_;
+  std::condition_variable dump_thread_cond_;
+  std::thread dump_thread_;
+};
+
+std::string MetricsLabel(const std::string& key, const std::string& val);
+std::string MetricsLabel(const std::string& key, int64_t val);
+
+}  // namespace profiler
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PROFILER_METRICS_H_
@@ -0,0 +1,75 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/profiler/metrics.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+TEST(MetricsHistogram, bucket) {
+  MetricsHistogram histogram;
+  histogram.Observe(0);
+  histogram.Observe(1);
+  histogram.Observe(2);
+  histogram.Observe(3);
+  histogram.Observe(1024);
+  histogram.Observe(int64_t(1) << 40);
+  ASSERT_EQ(histogram.bucket_cnt(0), 2);
+  ASSERT_EQ(histogram.bucket_cnt(1), 1);
+  ASSERT_EQ(histogram.bucket_cnt(2), 1);
+  ASSERT_EQ(histogram.bucket_cnt(10), 1);
+  ASSERT_EQ(histogram.bucket_cnt(MetricsHistogram::kBucketNum - 1), 1);
+  ASSERT_EQ(histogram.count(), 6);
+  ASSERT_EQ(histogram.sum(), 1030 + (int64_t(1) << 40));
+}
+
+TEST(MetricsRegistry, same_metric_for_same_labels) {
+  MetricsRegistry registry;
+  MetricsCounter* counter = registry.MutCounter("act_cnt", MetricsLabel("actor_id", 1));
+  ASSERT_EQ(counter, registry.MutCounter("act_cnt", MetricsLabel("actor_id", 1)));
+  ASSERT_NE(counter, registry.MutCounter("act_cnt", MetricsLabel("actor_id", 2)));
+}
+
+TEST(MetricsRegistry, dump_text) {
+  MetricsRegistry registry;
+  registry.MutCounter("act_cnt", MetricsLabel("actor_id", 1))->Add(3);
+  registry.MutGauge("queue_depth", "")->Set(5);
+  registry.MutHistogram("act_time_us", MetricsLabel("actor_id", 1))->Observe(3);
+  const std::string text = registry.DumpText();
+  ASSERT_NE(text.find("# TYPE act_cnt counter\nact_cnt{actor_id=\"1\"} 3\n"), std::string::npos);
+  ASSERT_NE(text.find("queue_depth 5\n"), std::string::npos);
+  ASSERT_NE(text.find("act_time_us_bucket{actor_id=\"1\",le=\"2\"} 0\n"), std::string::npos);
+  ASSERT_NE(text.find("act_time_us_bucket{actor_id=\"1\",le=\"4\"} 1\n"), std::string::npos);
+  ASSERT_NE(text.find("act_time_us_bucket{actor_id=\"1\",le=\"+Inf\"} 1\n"), std::string::npos);
+  ASSERT_NE(text.find("act_time_us_count{actor_id=\"1\"} 1\n"), std::string::npos);
+}
+
+TEST(MetricsRegistry, multi_thread_add) {
+  MetricsRegistry registry;
+  MetricsCounter* counter = registry.MutCounter("cnt", "");
+  std::vector<std::thread> threads;
+  FOR_RANGE(int, i, 0, 8) {
+    threads.emplace_back([counter]() {
+      FOR_RANGE(int, j, 0, 10000) { counter->Add(1); }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+  ASSERT_EQ(counter->value(), 80000);
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
@@ -0,0 +1,296 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/record/ofrecord_view.h"
+#include "oneflow/core/common/data_type.h"
+
+namespace oneflow {
+
+namespace {
+
+enum WireType {
+  kWireTypeVarint = 0,
+  kWireTypeFixed64 = 1,
+  kWireTypeLengthDelimited = 2,
+  kWireTypeFixed32 = 5,
+};
+
+// field numbers of record.proto
+constexpr uint32_t kOFRecordFeatureField = 1;
+constexpr uint32_t kMapEntryKeyField = 1;
+constexpr uint32_t kMapEntryValueField = 2;
+constexpr uint32_t kListValueField = 1;
+
+uint64_t ReadVarint(const char** ptr, const char* end) {
+  uint64_t val = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    CHECK_LT(*ptr, end) << "truncated OFRecord";
+    const uint8_t byte = static_cast<uint8_t>(*((*ptr)++));
+    val |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) { return val; }
+  }
+  LOG(FATAL) << "malformed varint in OFRecord";
+  return 0;
+}
+
+struct WireField {
+  uint32_t number;
+  WireType wire_type;
+  uint64_t varint;
+  // the payload of fixed and length delimited fields
+  const char* data;
+  size_t size;
+};
+
+// reads the field at *ptr and advances *ptr past it, returns false at the end of the message
+bool ReadField(const char** ptr, const char* end, WireField* field) {
+  if (*ptr == end) { return false; }
+  const uint64_t tag = ReadVarint(ptr, end);
+  field->number = static_cast<uint32_t>(tag >> 3);
+  field->wire_type = static_cast<WireType>(tag & 0x7);
+  field->varint = 0;
+  field->data = nullptr;
+  field->size = 0;
+  switch (field->wire_type) {
+    case kWireTypeVarint: field->varint = ReadVarint(ptr, end); return true;
+    case kWireTypeFixed64: field->size = 8; break;
+    case kWireTypeFixed32: field->size = 4; break;
+    case kWireTypeLengthDelimited: field->size = ReadVarint(ptr, end); break;
+    default: LOG(FATAL) << "unsupported wire type " << field->wire_type << " in OFRecord";
+  }
+  CHECK_LE(field->size, static_cast<size_t>(end - *ptr)) << "truncated OFRecord";
+  field->data = *ptr;
+  *ptr += field->size;
+  return true;
+}
+
+Feature::KindCase ListField2KindCase(uint32_t number) {
+  switch (number) {
+    case Feature::kBytesList:
+    case Feature::kFloatList:
+    case Feature::kDoubleList:
+    case Feature::kInt32List:
+    case Feature::kInt64List: return static_cast<Feature::KindCase>(number);
+    default: return Feature::KIND_NOT_SET;
+  }
+}
+
+OFRecordFeatureView ParseFeature(const char* data, size_t size) {
+  OFRecordFeatureView feature;
+  const char* ptr = data;
+  const char* end = data + size;
+  WireField field;
+  while (ReadField(&ptr, end, &field)) {
+    const Feature::KindCase kind_case = ListField2KindCase(field.number);
+    if (kind_case == Feature::KIND_NOT_SET) { continue; }
+    CHECK_EQ(field.wire_type, kWireTypeLengthDelimited);
+    // a list split across several fields of the same kind would have to be merged
+    CHECK_NE(feature.kind_case(), kind_case) << "list of a feature split in OFRecord";
+    feature = OFRecordFeatureView(kind_case, field.data, field.size);
+  }
+  return feature;
+}
+
+int64_t CountVarints(const char* data, size_t size) {
+  int64_t cnt = 0;
+  FOR_RANGE(size_t, i, 0, size) {
+    if ((static_cast<uint8_t>(data[i]) & 0x80) == 0) { ++cnt; }
+  }
+  return cnt;
+}
+
+// how the values of a numeric list are encoded when they are not packed
+template<typename CppT>
+struct NumericListTrait;
+
+template<>
+struct NumericListTrait<float> {
+  static const WireType kUnpackedWireType = kWireTypeFixed32;
+  static float Unpacked(const WireField& field) {
+    float val;
+    std::memcpy(&val, field.data, sizeof(float));
+    return val;
+  }
+};
+
+template<>
+struct NumericListTrait<double> {
+  static const WireType kUnpackedWireType = kWireTypeFixed64;
+  static double Unpacked(const WireField& field) {
+    double val;
+    std::memcpy(&val, field.data, sizeof(double));
+    return val;
+  }
+};
+
+template<>
+struct NumericListTrait<int32_t> {
+  static const WireType kUnpackedWireType = kWireTypeVarint;
+  static int32_t Unpacked(const WireField& field) { return static_cast<int32_t>(field.varint); }
+};
+
+template<>
+struct NumericListTrait<int64_t> {
+  static const WireType kUnpackedWireType = kWireTypeVarint;
+  static int64_t Unpacked(const WireField& field) { return static_cast<int64_t>(field.varint); }
+};
+
+template<typename CppT, typename T>
+T* CopyPackedValues(const char* data, size_t size, T* out) {
+  CHECK_EQ(size % sizeof(CppT), 0);
+  const size_t num = size / sizeof(CppT);
+  if (std::is_same<CppT, T>::value) {
+    std::memcpy(out, data, size);
+  } else {
+    FOR_RANGE(size_t, i, 0, num) {
+      CppT val;
+      std::memcpy(&val, data + i * sizeof(CppT), sizeof(CppT));
+      out[i] = static_cast<T>(val);
+    }
+  }
+  return out + num;
+}
+
+template<typename CppT, typename T>
+T* CopyPackedVarints(const char* data, size_t size, T* out) {
+  const char* ptr = data;
+  const char* end = data + size;
+  while (ptr < end) { *(out++) = static_cast<T>(static_cast<CppT>(ReadVarint(&ptr, end))); }
+  return out;
+}
+
+template<typename CppT, typename T>
+void CopyListValues(const char* data, size_t size, T* out) {
+  const char* ptr = data;
+  const char* end = data + size;
+  WireField field;
+  while (ReadField(&ptr, end, &field)) {
+    if (field.number != kListValueField) { continue; }
+    if (field.wire_type == kWireTypeLengthDelimited) {
+      if (NumericListTrait<CppT>::kUnpackedWireType == kWireTypeVarint) {
+        out = CopyPackedVarints<CppT, T>(field.data, field.size, out);
+      } else {
+        out = CopyPackedValues<CppT, T>(field.data, field.size, out);
+      }
+    } else {
+      CHECK(field.wire_type == NumericListTrait<CppT>::kUnpackedWireType);
+      *(out++) = static_cast<T>(NumericListTrait<CppT>::Unpacked(field));
+    }
+  }
+}
+
+}  // namespace
+
+int64_t OFRecordFeatureView::value_size() const {
+  const char* ptr = list_data_;
+  const char* end = list_data_ + list_size_;
+  int64_t cnt = 0;
+  WireField field;
+  while (ReadField(&ptr, end, &field)) {
+    if (field.number != kListValueField) { continue; }
+    if (kind_case_ == Feature::kBytesList || field.wire_type != kWireTypeLengthDelimited) {
+      cnt += 1;
+    } else if (kind_case_ == Feature::kFloatList) {
+      cnt += field.size / sizeof(float);
+    } else if (kind_case_ == Feature::kDoubleList) {
+      cnt += field.size / sizeof(double);
+    } else {
+      cnt += CountVarints(field.data, field.size);
+    }
+  }
+  return cnt;
+}
+
+void OFRecordFeatureView::GetBytes(int64_t i, const char** data, size_t* size) const {
+  CHECK(has_bytes_list());
+  const char* ptr = list_data_;
+  const char* end = list_data_ + list_size_;
+  WireField field;
+  while (ReadField(&ptr, end, &field)) {
+    if (field.number != kListValueField) { continue; }
+    CHECK_EQ(field.wire_type, kWireTypeLengthDelimited);
+    if (i == 0) {
+      *data = field.data;
+      *size = field.size;
+      return;
+    }
+    --i;
+  }
+  LOG(FATAL) << "bytes_list index out of range";
+}
+
+template<typename T>
+void OFRecordFeatureView::CopyValues(T* out) const {
+  switch (kind_case_) {
+    case Feature::kFloatList: CopyListValues<float, T>(list_data_, list_size_, out); break;
+    case Feature::kDoubleList: CopyListValues<double, T>(list_data_, list_size_, out); break;
+    case Feature::kInt32List: CopyListValues<int32_t, T>(list_data_, list_size_, out); break;
+    case Feature::kInt64List: CopyListValues<int64_t, T>(list_data_, list_size_, out); break;
+    default: UNIMPLEMENTED();
+  }
+}
+
+#define INSTANTIATE_COPY_VALUES(type_cpp, type_proto) \
+  template void OFRecordFeatureView::CopyValues<type_cpp>(type_cpp * out) const;
+OF_PP_FOR_EACH_TUPLE(INSTANTIATE_COPY_VALUES, POD_DATA_TYPE_SEQ)
+#undef INSTANTIATE_COPY_VALUES
+
+OFRecordView::OFRecordView(const char* data, size_t size) {
+  const char* ptr = data;
+  const char* end = data + size;
+  WireField field;
+  while (ReadField(&ptr, end, &field)) {
+    if (field.number != kOFRecordFeatureField) { continue; }
+    CHECK_EQ(field.wire_type, kWireTypeLengthDelimited);
+    IndexedFeature indexed{"", 0, OFRecordFeatureView()};
+    const char* entry_ptr = field.data;
+    const char* entry_end = field.data + field.size;
+    WireField entry_field;
+    while (ReadField(&entry_ptr, entry_end, &entry_field)) {
+      if (entry_field.number == kMapEntryKeyField) {
+        CHECK_EQ(entry_field.wire_type, kWireTypeLengthDelimited);
+        indexed.name = entry_field.data;
+        indexed.name_size = entry_field.size;
+      } else if (entry_field.number == kMapEntryValueField) {
+        CHECK_EQ(entry_field.wire_type, kWireTypeLengthDelimited);
+        indexed.feature = ParseFeature(entry_field.data, entry_field.size);
+      }
+    }
+    // the last entry of a key wins, as in a parsed map
+    auto* existing = const_cast<IndexedFeature*>(Find(indexed.name, indexed.name_size));
+    if (existing != nullptr) {
+      *existing = indexed;
+    } else {
+      features_.push_back(indexed);
+    }
+  }
+}
+
+const OFRecordView::IndexedFeature* OFRecordView::Find(const char* name, size_t size) const {
+  for (const IndexedFeature& indexed : features_) {
+    if (indexed.name_size == size && std::memcmp(indexed.name, name, size) == 0) {
+      return &indexed;
+    }
+  }
+  return nullptr;
+}
+
+const OFRecordFeatureView& OFRecordView::Feature4Name(const std::string& name) const {
+  const IndexedFeature* indexed = Find(name.data(), name.size());
+  CHECK(indexed != nullptr) << "Field " << name << " not found";
+  return indexed->feature;
+}
+
+}  // namespace oneflow
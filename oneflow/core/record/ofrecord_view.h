@@ -0,0 +1,82 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_RECORD_OFRECORD_VIEW_H_
+#define ONEFLOW_CORE_RECORD_OFRECORD_VIEW_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/record/record.pb.h"
+
+namespace oneflow {
+
+// A Feature in the wire format of a serialized OFRecord. Bytes are accessed in place and numeric
+// values are decoded when copied out, so nothing is allocated. It does not own the data.
+class OFRecordFeatureView final {
+ public:
+  OFRecordFeatureView() : OFRecordFeatureView(Feature::KIND_NOT_SET, nullptr, 0) {}
+  OFRecordFeatureView(Feature::KindCase kind_case, const char* list_data, size_t list_size)
+      : kind_case_(kind_case), list_data_(list_data), list_size_(list_size) {}
+  ~OFRecordFeatureView() = default;
+
+  Feature::KindCase kind_case() const { return kind_case_; }
+  bool has_bytes_list() const { return kind_case_ == Feature::kBytesList; }
+  bool has_float_list() const { return kind_case_ == Feature::kFloatList; }
+  bool has_double_list() const { return kind_case_ == Feature::kDoubleList; }
+  bool has_int32_list() const { return kind_case_ == Feature::kInt32List; }
+  bool has_int64_list() const { return kind_case_ == Feature::kInt64List; }
+
+  // the number of values in the list of kind_case()
+  int64_t value_size() const;
+  // the i-th value of a bytes_list, pointing into the serialized record
+  void GetBytes(int64_t i, const char** data, size_t* size) const;
+  // copies the value_size() values of a numeric list into out, converted to T
+  template<typename T>
+  void CopyValues(T* out) const;
+
+ private:
+  Feature::KindCase kind_case_;
+  const char* list_data_;
+  size_t list_size_;
+};
+
+// A read-only view of a serialized OFRecord. The wire format is scanned once on construction to
+// index the features, the serialized data must outlive the view.
+class OFRecordView final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(OFRecordView);
+  OFRecordView(const char* data, size_t size);
+  ~OFRecordView() = default;
+
+  size_t feature_size() const { return features_.size(); }
+  bool HasFeature(const std::string& name) const {
+    return Find(name.data(), name.size()) != nullptr;
+  }
+  const OFRecordFeatureView& Feature4Name(const std::string& name) const;
+
+ private:
+  struct IndexedFeature {
+    const char* name;
+    size_t name_size;
+    OFRecordFeatureView feature;
+  };
+  const IndexedFeature* Find(const char* name, size_t size) const;
+
+  // records hold a handful of features, a linear search beats hashing their names
+  std::vector<IndexedFeature> features_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_RECORD_OFRECORD_VIEW_H_
@@ -0,0 +1,59 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/record/ofrecord_view.h"
+
+#include <chrono>
+#include <iostream>
+
+DEFINE_int32(image_size, 110000, "bytes of the encoded image of the record.");
+DEFINE_int32(iter_num, 1000, "number of records read by each reader.");
+
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // an ImageNet-like record, of which a decoder reads the image only
+  OFRecord record;
+  auto* features = record.mutable_feature();
+  (*features)["encoded"].mutable_bytes_list()->add_value(std::string(FLAGS_image_size, 'x'));
+  (*features)["class/label"].mutable_int64_list()->add_value(1);
+  (*features)["filename"].mutable_bytes_list()->add_value("n01440764_10026.JPEG");
+  std::string serialized;
+  CHECK(record.SerializeToString(&serialized));
+  size_t total_size = 0;
+  auto start = std::chrono::steady_clock::now();
+  FOR_RANGE(int32_t, i, 0, FLAGS_iter_num) {
+    OFRecord parsed;
+    CHECK(parsed.ParseFromArray(serialized.data(), serialized.size()));
+    total_size += parsed.feature().at("encoded").bytes_list().value(0).size();
+  }
+  const double parse_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  FOR_RANGE(int32_t, i, 0, FLAGS_iter_num) {
+    OFRecordView view(serialized.data(), serialized.size());
+    const char* data = nullptr;
+    size_t size = 0;
+    view.Feature4Name("encoded").GetBytes(0, &data, &size);
+    total_size += size;
+  }
+  const double view_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CHECK_EQ(total_size, 2 * FLAGS_iter_num * static_cast<size_t>(FLAGS_image_size));
+  std::cout << "ParseFromArray: " << FLAGS_iter_num / parse_seconds
+            << " records/s, OFRecordView: " << FLAGS_iter_num / view_seconds << " records/s"
+            << std::endl;
+  return 0;
+}
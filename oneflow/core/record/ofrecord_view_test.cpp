@@ -0,0 +1,114 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/record/ofrecord_view.h"
+#include <random>
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+OFRecord GenRandomOFRecord(std::mt19937* gen) {
+  OFRecord record;
+  auto* features = record.mutable_feature();
+  std::string bytes((*gen)() % 1000, '\0');
+  for (char& c : bytes) { c = static_cast<char>((*gen)()); }
+  (*features)["image"].mutable_bytes_list()->add_value(bytes);
+  (*features)["empty"].mutable_bytes_list()->add_value("");
+  (*features)["label"].mutable_int32_list()->add_value(static_cast<int32_t>((*gen)()));
+  const int32_t list_size = (*gen)() % 20;
+  FOR_RANGE(int32_t, i, 0, list_size) {
+    (*features)["float"].mutable_float_list()->add_value(static_cast<float>((*gen)()) / 7);
+    (*features)["double"].mutable_double_list()->add_value(static_cast<double>((*gen)()) / 7);
+    (*features)["int32"].mutable_int32_list()->add_value(-static_cast<int32_t>((*gen)() % 1000));
+    (*features)["int64"].mutable_int64_list()->add_value(static_cast<int64_t>((*gen)()) << 20);
+    (*features)["bytes"].mutable_bytes_list()->add_value(std::to_string((*gen)()));
+  }
+  (*features)["not_set"];
+  return record;
+}
+
+template<typename T, typename PbList>
+void CheckValuesEq(const OFRecordFeatureView& view, const PbList& list) {
+  ASSERT_EQ(view.value_size(), list.value_size());
+  std::vector<T> values(view.value_size());
+  view.CopyValues(values.data());
+  FOR_RANGE(int32_t, i, 0, list.value_size()) {
+    ASSERT_EQ(values.at(i), static_cast<T>(list.value(i)));
+  }
+}
+
+void CheckFeatureEq(const OFRecordFeatureView& view, const Feature& feature) {
+  ASSERT_EQ(view.kind_case(), feature.kind_case());
+  if (feature.has_bytes_list()) {
+    ASSERT_EQ(view.value_size(), feature.bytes_list().value_size());
+    FOR_RANGE(int32_t, i, 0, feature.bytes_list().value_size()) {
+      const char* data = nullptr;
+      size_t size = 0;
+      view.GetBytes(i, &data, &size);
+      ASSERT_EQ(std::string(data, size), feature.bytes_list().value(i));
+    }
+  } else if (feature.has_float_list()) {
+    CheckValuesEq<float>(view, feature.float_list());
+    CheckValuesEq<double>(view, feature.float_list());
+  } else if (feature.has_double_list()) {
+    CheckValuesEq<double>(view, feature.double_list());
+  } else if (feature.has_int32_list()) {
+    CheckValuesEq<int32_t>(view, feature.int32_list());
+    CheckValuesEq<int64_t>(view, feature.int32_list());
+  } else if (feature.has_int64_list()) {
+    CheckValuesEq<int64_t>(view, feature.int64_list());
+    CheckValuesEq<double>(view, feature.int64_list());
+  }
+}
+
+}  // namespace
+
+TEST(OFRecordView, same_as_parsed) {
+  std::mt19937 gen(0);
+  FOR_RANGE(int32_t, i, 0, 100) {
+    const OFRecord record = GenRandomOFRecord(&gen);
+    std::string serialized;
+    CHECK(record.SerializeToString(&serialized));
+    OFRecordView view(serialized.data(), serialized.size());
+    ASSERT_EQ(view.feature_size(), record.feature().size());
+    for (const auto& pair : record.feature()) {
+      ASSERT_TRUE(view.HasFeature(pair.first));
+      CheckFeatureEq(view.Feature4Name(pair.first), pair.second);
+    }
+    ASSERT_FALSE(view.HasFeature("missing"));
+  }
+}
+
+TEST(OFRecordView, unpacked_values) {
+  // repeated scalars written one field each, which parsers must accept for packed fields too
+  const std::string float_list("\x0d\x00\x00\x80\x3f\x0d\x00\x00\x00\x40", 10);
+  const std::string int32_list("\x08\x01\x08\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01", 13);
+  OFRecordFeatureView float_view(Feature::kFloatList, float_list.data(), float_list.size());
+  Feature float_feature;
+  CHECK(float_feature.mutable_float_list()->ParseFromString(float_list));
+  CheckFeatureEq(float_view, float_feature);
+  OFRecordFeatureView int32_view(Feature::kInt32List, int32_list.data(), int32_list.size());
+  Feature int32_feature;
+  CHECK(int32_feature.mutable_int32_list()->ParseFromString(int32_list));
+  CheckFeatureEq(int32_view, int32_feature);
+  ASSERT_EQ(int32_feature.int32_list().value(1), -1);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/actor/actor.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/profiler/metrics.h"
 
 namespace oneflow {
 
@@ -42,18 +43,37 @@ void Thread::EnqueueActorMsg(const ActorMsg& msg) {
 }
 
 void Thread::PollMsgChannel(const ThreadCtx& thread_ctx) {
+  profiler::MetricsCounter* msg_cnt = nullptr;
+  profiler::MetricsGauge* msg_queue_depth = nullptr;
+  profiler::MetricsHistogram* msg_batch_size = nullptr;
+  if (Global<profiler::MetricsRegistry>::Get() != nullptr) {
+    auto* registry = Global<profiler::MetricsRegistry>::Get();
+    const std::string labels = profiler::MetricsLabel("thrd_id", thrd_id_);
+    msg_cnt = registry->MutCounter("thread_msg_cnt", labels);
+    msg_queue_depth = registry->MutGauge("thread_msg_queue_depth", labels);
+    msg_batch_size = registry->MutHistogram("thread_msg_batch_size", labels);
+  }
   while (true) {
     if (local_msg_queue_.empty()) {
       CHECK_EQ(msg_channel_.ReceiveMany(&local_msg_queue_), kChannelStatusSuccess);
+      if (msg_batch_size != nullptr) { msg_batch_size->Observe(local_msg_queue_.size()); }
     }
     ActorMsg msg = std::move(local_msg_queue_.front());
     local_msg_queue_.pop();
+    if (msg_cnt != nullptr) {
+      msg_cnt->Add(1);
+      msg_queue_depth->Set(local_msg_queue_.size());
+    }
     if (msg.msg_type() == ActorMsgType::kCmdMsg) {
       if (msg.actor_cmd() == ActorCmd::kStopThread) {
         CHECK(id2actor_ptr_.empty());
         break;
       } else if (msg.actor_cmd() == ActorCmd::kConstructActor) {
-        ConstructActor(msg.dst_actor_id(), thread_ctx);
+        if (actor_construction_pool_ == nullptr) {
+          ConstructActor(msg.dst_actor_id(), thread_ctx);
+        } else {
+          AsyncConstructActor(msg.dst_actor_id(), thread_ctx);
+        }
         continue;
       } else {
         // do nothing
@@ -82,4 +102,29 @@ void Thread::ConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx) {
   Global<RuntimeCtx>::Get()->DecreaseCounter("constructing_actor_cnt");
 }
 
+void Thread::AsyncConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx) {
+  VLOG(3) << "thread " << thrd_id_ << " construct actor " << actor_id << " asynchronously";
+  std::shared_ptr<TaskProto> task;
+  {
+    std::unique_lock<std::mutex> lck(id2task_mtx_);
+    auto task_it = id2task_.find(actor_id);
+    CHECK(task_it != id2task_.end());
+    task.reset(new TaskProto(std::move(task_it->second)));
+    id2task_.erase(task_it);
+  }
+  // thread_ctx lives as long as the actor thread, which outlives the construction because no
+  // actor message is sent before every actor is constructed
+  const ThreadCtx* thread_ctx_ptr = &thread_ctx;
+  actor_construction_pool_->AddWork([this, actor_id, task, thread_ctx_ptr]() {
+    std::unique_ptr<Actor> actor = NewActor(*task, *thread_ctx_ptr);
+    {
+      // id2actor_ptr_ is only read by the actor thread after kStart, which is not sent until
+      // "constructing_actor_cnt" reaches zero
+      std::unique_lock<std::mutex> lck(id2task_mtx_);
+      CHECK(id2actor_ptr_.emplace(actor_id, std::move(actor)).second);
+    }
+    Global<RuntimeCtx>::Get()->DecreaseCounter("constructing_actor_cnt");
+  });
+}
+
 }  // namespace oneflow
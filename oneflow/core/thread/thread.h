@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/job/task.pb.h"
 #include "oneflow/core/thread/thread_context.h"
+#include "oneflow/core/thread/thread_pool.h"
 #include "oneflow/core/actor/actor.h"
 
 namespace oneflow {
@@ -37,6 +38,10 @@ class Thread {
 
   void JoinAllActor() { actor_thread_.join(); }
 
+  // Actors of this thread are constructed on the pool instead of the actor thread itself. Only
+  // valid for threads whose actors do not depend on the actor thread, e.g. its cuda device.
+  void set_actor_construction_pool(ThreadPool* pool) { actor_construction_pool_ = pool; }
+
  protected:
   Thread() = default;
   std::thread& mut_actor_thread() { return actor_thread_; }
@@ -45,6 +50,7 @@ class Thread {
 
  private:
   void ConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx);
+  void AsyncConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx);
 
   HashMap<int64_t, TaskProto> id2task_;
   std::mutex id2task_mtx_;
@@ -53,6 +59,7 @@ class Thread {
   Channel<ActorMsg> msg_channel_;
   HashMap<int64_t, std::unique_ptr<Actor>> id2actor_ptr_;
   std::queue<ActorMsg> local_msg_queue_;
+  ThreadPool* actor_construction_pool_ = nullptr;
 
   int64_t thrd_id_;
 };
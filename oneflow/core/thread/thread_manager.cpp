@@ -38,6 +38,12 @@ Thread* ThreadMgr::GetThrd(int64_t thrd_id) { return threads_.at(thrd_id); }
 
 ThreadMgr::ThreadMgr(const Plan& plan) {
   int64_t thrd_id = 0;
+  const int32_t actor_construction_thread_num =
+      Global<ResourceDesc, ForSession>::Get()->ActorConstructionThreadPoolSize();
+  if (actor_construction_thread_num > 1) {
+    // kernels may use Global<ThreadPool> during initialization, so a separate pool is used here
+    actor_construction_pool_.reset(new ThreadPool(actor_construction_thread_num));
+  }
 
 #ifdef WITH_CUDA
   FOR_RANGE(int64_t, i, 0, GetCudaWorkTypeSize()) {
@@ -51,6 +57,12 @@ ThreadMgr::ThreadMgr(const Plan& plan) {
   }
   threads_.push_back(new CpuThread(thrd_id++));  // comm_net
   CreatePersistenceThrd(plan, thrd_id);
+  // actors of gpu threads stay on their own threads, which are bound to the cuda device
+  for (Thread* thread : threads_) {
+    if (dynamic_cast<CpuThread*>(thread) != nullptr) {
+      thread->set_actor_construction_pool(actor_construction_pool_.get());
+    }
+  }
 }
 
 void ThreadMgr::CreatePersistenceThrd(const Plan& plan, int64_t thrd_id) {
@@ -40,6 +40,7 @@ class ThreadMgr final {
   void CreatePersistenceThrd(const Plan& plan, int64_t thrd_id);
 
   std::vector<Thread*> threads_;
+  std::unique_ptr<ThreadPool> actor_construction_pool_;
 };
 
 void SingleThreadLoop(size_t num, std::function<void(size_t i)> Callback);
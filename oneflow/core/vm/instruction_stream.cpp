@@ -0,0 +1,175 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/instruction_stream.h"
+#include "oneflow/core/vm/instruction.pb.h"
+#include "oneflow/core/vm/instruction.cfg.h"
+#include "oneflow/core/vm/instruction_type.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+// works for both the protobuf and the cfg classes, which share their accessors
+
+template<typename OperandProtoT>
+void InitOperand(const OperandProtoT& proto, Operand* operand) {
+  operand->set_logical_object_id(proto.logical_object_id());
+  if (proto.has_sole_mirrored_object()) {
+    operand->mutable_sole_mirrored_object();
+  } else if (proto.has_current_global_device_id()) {
+    operand->mutable_current_global_device_id();
+  } else if (proto.has_all_mirrored_object()) {
+    operand->mutable_all_mirrored_object();
+  } else {
+    UNIMPLEMENTED();
+  }
+}
+
+template<typename InstructionOperandProtoT>
+void InitInstructionOperand(const InstructionOperandProtoT& proto, InstructionOperand* operand) {
+  if (proto.has_const_operand()) {
+    InitOperand(proto.const_operand(), operand->mutable_const_operand()->mutable_operand());
+  } else if (proto.has_mut_operand()) {
+    InitOperand(proto.mut_operand(), operand->mutable_mut_operand()->mutable_operand());
+  } else if (proto.has_mut2_operand()) {
+    InitOperand(proto.mut2_operand(), operand->mutable_mut2_operand()->mutable_operand());
+  } else if (proto.has_symbol_operand()) {
+    InitOperand(proto.symbol_operand(), operand->mutable_symbol_operand()->mutable_operand());
+  } else if (proto.has_init_symbol_operand()) {
+    InitOperand(proto.init_symbol_operand(),
+                operand->mutable_init_symbol_operand()->mutable_operand());
+  } else if (proto.has_separator()) {
+    operand->mutable_separator();
+  } else if (proto.has_double_operand()) {
+    operand->set_double_operand(proto.double_operand());
+  } else if (proto.has_int64_operand()) {
+    operand->set_int64_operand(proto.int64_operand());
+  } else if (proto.has_uint64_operand()) {
+    operand->set_uint64_operand(proto.uint64_operand());
+  } else if (proto.has_bool_operand()) {
+    operand->set_bool_operand(proto.bool_operand());
+  } else {
+    UNIMPLEMENTED();
+  }
+}
+
+class StreamReader final {
+ public:
+  explicit StreamReader(const std::string& buffer)
+      : cur_(buffer.data()), end_(buffer.data() + buffer.size()) {}
+
+  bool eof() const { return cur_ == end_; }
+  int64_t remaining_size() const { return end_ - cur_; }
+
+  Maybe<void> Read(void* dst, size_t size) {
+    CHECK_LE_OR_RETURN(size, static_cast<size_t>(end_ - cur_)) << "truncated instruction stream";
+    std::memcpy(dst, cur_, size);
+    cur_ += size;
+    return Maybe<void>::Ok();
+  }
+
+  template<typename T>
+  Maybe<T> ReadPod() {
+    T val;
+    JUST(Read(&val, sizeof(T)));
+    return val;
+  }
+
+ private:
+  const char* cur_;
+  const char* end_;
+};
+
+}  // namespace
+
+template<typename T>
+void InstructionStream::AppendPod(const T& val) {
+  buffer_.append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+void InstructionStream::AppendInstrTypeName(const std::string& instr_type_name) {
+  const int64_t index = instr_type_name2index_.size();
+  const auto& pair = instr_type_name2index_.emplace(instr_type_name, index);
+  AppendPod<int64_t>(pair.first->second);
+  if (!pair.second) { return; }
+  AppendPod<int64_t>(instr_type_name.size());
+  buffer_.append(instr_type_name);
+}
+
+template<typename InstructionProtoT>
+void InstructionStream::AppendInstruction(const InstructionProtoT& instruction) {
+  AppendInstrTypeName(instruction.instr_type_name());
+  AppendPod<bool>(instruction.has_parallel_desc_symbol_id());
+  AppendPod<int64_t>(instruction.parallel_desc_symbol_id());
+  AppendPod<int64_t>(instruction.operand_size());
+  FlatMsg<InstructionOperand> operand;
+  for (int64_t i = 0; i < instruction.operand_size(); ++i) {
+    operand->clear();
+    InitInstructionOperand(instruction.operand(i), operand.Mutable());
+    AppendPod<InstructionOperand>(operand.Get());
+  }
+}
+
+void InstructionStream::Append(const InstructionListProto& instruction_list) {
+  for (const auto& instruction : instruction_list.instruction()) { AppendInstruction(instruction); }
+}
+
+void InstructionStream::Append(const cfg::InstructionListProto& instruction_list) {
+  for (int64_t i = 0; i < instruction_list.instruction_size(); ++i) {
+    AppendInstruction(instruction_list.instruction(i));
+  }
+}
+
+Maybe<void> InstructionStream::Decode(InstructionMsgList* instr_msg_list) const {
+  StreamReader reader(buffer_);
+  std::vector<InstrTypeId> index2instr_type_id;
+  while (!reader.eof()) {
+    const int64_t instr_type_index = JUST(reader.ReadPod<int64_t>());
+    CHECK_GE_OR_RETURN(instr_type_index, 0);
+    // the name of an instruction type follows its first index
+    if (instr_type_index == static_cast<int64_t>(index2instr_type_id.size())) {
+      const int64_t name_size = JUST(reader.ReadPod<int64_t>());
+      CHECK_OR_RETURN(name_size >= 0 && name_size <= reader.remaining_size())
+          << "invalid instr type name size " << name_size;
+      std::string instr_type_name(name_size, '\0');
+      JUST(reader.Read(&instr_type_name[0], instr_type_name.size()));
+      index2instr_type_id.push_back(LookupInstrTypeId(instr_type_name));
+    }
+    CHECK_LT_OR_RETURN(instr_type_index, static_cast<int64_t>(index2instr_type_id.size()));
+    auto instr_msg = ObjectMsgPtr<InstructionMsg>::New();
+    instr_msg->mutable_instr_type_id()->CopyFrom(index2instr_type_id.at(instr_type_index));
+    const bool has_parallel_desc_symbol_id = JUST(reader.ReadPod<bool>());
+    const int64_t parallel_desc_symbol_id = JUST(reader.ReadPod<int64_t>());
+    if (has_parallel_desc_symbol_id) {
+      instr_msg->set_parallel_desc_symbol_id(parallel_desc_symbol_id);
+    }
+    auto* operand_vec = instr_msg->mutable_operand();
+    const int64_t operand_size = JUST(reader.ReadPod<int64_t>());
+    const int64_t max_operand_size = reader.remaining_size() / sizeof(InstructionOperand);
+    CHECK_OR_RETURN(operand_size >= 0 && operand_size <= max_operand_size)
+        << "invalid operand size " << operand_size;
+    operand_vec->resize(operand_size);
+    for (auto& operand : *operand_vec) {
+      JUST(reader.Read(operand.Mutable(), sizeof(InstructionOperand)));
+    }
+    instr_msg_list->EmplaceBack(std::move(instr_msg));
+  }
+  return Maybe<void>::Ok();
+}
+
+}  // namespace vm
+}  // namespace oneflow
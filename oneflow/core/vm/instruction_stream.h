@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_INSTRUCTION_STREAM_H_
+#define ONEFLOW_CORE_VM_INSTRUCTION_STREAM_H_
+
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/vm/instruction.msg.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace cfg {
+class InstructionListProto;
+}
+
+using InstructionMsgList = OBJECT_MSG_LIST(InstructionMsg, instr_msg_link);
+
+// Compact binary encoding of an instruction list, decoded into InstructionMsgs without protobuf.
+// Every instruction is laid out as
+//
+//   instr_type_index: int64, followed by the instr type name (int64 size + chars) the first
+//                     time the index appears in the stream
+//   has_parallel_desc_symbol_id: bool, parallel_desc_symbol_id: int64
+//   operand_size: int64, followed by operand_size InstructionOperand flat msgs
+//
+// Instr type names are interned per stream and looked up once when decoding. Operands are copied
+// byte by byte, so the encoding and the decoding process must run the same build.
+class InstructionStream final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(InstructionStream);
+  InstructionStream() = default;
+  // for streams received from other processes, which are decoded only and never appended to
+  explicit InstructionStream(std::string&& buffer) : buffer_(std::move(buffer)) {}
+  ~InstructionStream() = default;
+
+  void Append(const InstructionListProto& instruction_list);
+  void Append(const cfg::InstructionListProto& instruction_list);
+
+  Maybe<void> Decode(InstructionMsgList* instr_msg_list) const;
+
+  bool empty() const { return buffer_.empty(); }
+  const std::string& buffer() const { return buffer_; }
+  std::string* mut_buffer() { return &buffer_; }
+
+ private:
+  template<typename InstructionProtoT>
+  void AppendInstruction(const InstructionProtoT& instruction);
+  void AppendInstrTypeName(const std::string& instr_type_name);
+  template<typename T>
+  void AppendPod(const T& val);
+
+  std::string buffer_;
+  HashMap<std::string, int64_t> instr_type_name2index_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_INSTRUCTION_STREAM_H_
@@ -0,0 +1,113 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/instruction_stream.h"
+#include "oneflow/core/vm/instruction.pb.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace test {
+
+namespace {
+
+InstructionListProto MakeInstructionList() {
+  InstructionListProto instruction_list;
+  {
+    auto* instruction = instruction_list.add_instruction();
+    instruction->set_instr_type_name("NewObject");
+    instruction->set_parallel_desc_symbol_id(9527);
+    instruction->add_operand()->set_int64_operand(IdUtil::NewLogicalObjectId());
+  }
+  {
+    auto* instruction = instruction_list.add_instruction();
+    instruction->set_instr_type_name("Nop");
+  }
+  {
+    auto* instruction = instruction_list.add_instruction();
+    instruction->set_instr_type_name("NewObject");
+    instruction->set_parallel_desc_symbol_id(9528);
+    auto* operand = instruction->add_operand()->mutable_mut_operand();
+    operand->set_logical_object_id(IdUtil::NewLogicalObjectId());
+    operand->mutable_sole_mirrored_object();
+    instruction->add_operand()->mutable_separator();
+    instruction->add_operand()->set_double_operand(0.5);
+    instruction->add_operand()->set_bool_operand(true);
+  }
+  return instruction_list;
+}
+
+}  // namespace
+
+TEST(InstructionStream, encode_and_decode) {
+  const InstructionListProto& instruction_list = MakeInstructionList();
+  InstructionStream instruction_stream;
+  instruction_stream.Append(instruction_list);
+  InstructionStream received_stream{std::string(instruction_stream.buffer())};
+  InstructionMsgList instr_msg_list;
+  CHECK_JUST(received_stream.Decode(&instr_msg_list));
+  ASSERT_EQ(instr_msg_list.size(), instruction_list.instruction_size());
+  int64_t i = 0;
+  OBJECT_MSG_LIST_UNSAFE_FOR_EACH_PTR(&instr_msg_list, instr_msg) {
+    const auto& expected = ObjectMsgPtr<InstructionMsg>::New(instruction_list.instruction(i++));
+    ASSERT_TRUE(instr_msg->instr_type_id() == expected->instr_type_id());
+    ASSERT_EQ(instr_msg->has_parallel_desc_symbol_id(), expected->has_parallel_desc_symbol_id());
+    if (expected->has_parallel_desc_symbol_id()) {
+      ASSERT_EQ(instr_msg->parallel_desc_symbol_id(), expected->parallel_desc_symbol_id());
+    }
+    ASSERT_EQ(instr_msg->operand().size(), expected->operand().size());
+    FOR_RANGE(int64_t, j, 0, expected->operand().size()) {
+      ASSERT_EQ(std::memcmp(&instr_msg->operand().at(j).Get(), &expected->operand().at(j).Get(),
+                            sizeof(InstructionOperand)),
+                0);
+    }
+  }
+}
+
+TEST(InstructionStream, truncated) {
+  InstructionStream instruction_stream;
+  instruction_stream.Append(MakeInstructionList());
+  std::string buffer = instruction_stream.buffer();
+  buffer.resize(buffer.size() - 1);
+  InstructionStream received_stream(std::move(buffer));
+  InstructionMsgList instr_msg_list;
+  ASSERT_FALSE(received_stream.Decode(&instr_msg_list).IsOk());
+}
+
+TEST(InstructionStream, unknown_instr_type_index) {
+  // the first instruction may only introduce the instruction type of index 0
+  const int64_t instr_type_index = 1;
+  InstructionStream instruction_stream(
+      std::string(reinterpret_cast<const char*>(&instr_type_index), sizeof(instr_type_index)));
+  InstructionMsgList instr_msg_list;
+  ASSERT_FALSE(instruction_stream.Decode(&instr_msg_list).IsOk());
+}
+
+TEST(InstructionStream, invalid_instr_type_name_size) {
+  // a corrupt name size is refused before the name is allocated
+  for (const int64_t name_size : {static_cast<int64_t>(-1), GetMaxVal<int64_t>()}) {
+    const int64_t header[] = {0, name_size};
+    InstructionStream instruction_stream(
+        std::string(reinterpret_cast<const char*>(header), sizeof(header)));
+    InstructionMsgList instr_msg_list;
+    ASSERT_FALSE(instruction_stream.Decode(&instr_msg_list).IsOk());
+  }
+}
+
+}  // namespace test
+
+}  // namespace vm
+}  // namespace oneflow
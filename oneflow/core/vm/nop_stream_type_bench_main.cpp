@@ -0,0 +1,71 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/vm_util.h"
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/vm/virtual_machine.msg.h"
+#include "oneflow/core/vm/vm_desc.msg.h"
+#include "oneflow/core/vm/test_util.h"
+
+#include <chrono>
+#include <iostream>
+
+DEFINE_int64(instr_num, 10000, "number of nop instructions scheduled in each case.");
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+using InstructionMsgList = OBJECT_MSG_LIST(InstructionMsg, instr_msg_link);
+
+void BenchmarkNopScheduling(const std::string& name, int64_t num_operands) {
+  auto vm_desc = ObjectMsgPtr<VmDesc>::New(TestUtil::NewVmResourceDesc().Get());
+  TestUtil::AddStreamDescByInstrNames(vm_desc.Mutable(), {"Nop", "NewObject"});
+  auto vm = ObjectMsgPtr<VirtualMachine>::New(vm_desc.Get());
+  InstructionMsgList list;
+  int64_t object_id = TestUtil::NewObject(&list, "cpu", "0:0");
+  FOR_RANGE(int64_t, i, 0, FLAGS_instr_num) {
+    auto nop_instr_msg = NewInstruction("Nop");
+    // instructions mutating the same object form a dependency chain on the nop stream
+    FOR_RANGE(int64_t, j, 0, num_operands) { nop_instr_msg->add_mut_operand(object_id); }
+    list.PushBack(nop_instr_msg.Mutable());
+  }
+  const auto start = std::chrono::steady_clock::now();
+  vm->Receive(&list);
+  int64_t schedule_cnt = 0;
+  while (!vm->Empty()) {
+    vm->Schedule();
+    ++schedule_cnt;
+    OBJECT_MSG_LIST_FOR_EACH_PTR(vm->mut_thread_ctx_list(), t) { t->TryReceiveAndRun(); }
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << name << ": " << FLAGS_instr_num / seconds << " ops/s, " << schedule_cnt
+            << " schedule rounds" << std::endl;
+}
+
+}  // namespace
+
+}  // namespace vm
+}  // namespace oneflow
+
+int main(int argc, char* argv[]) {
+  using namespace oneflow::vm;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  BenchmarkNopScheduling("independent nops", 0);
+  BenchmarkNopScheduling("dependent nops", 1);
+  return 0;
+}
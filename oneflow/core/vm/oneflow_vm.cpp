@@ -18,18 +18,69 @@ limitations under the License.
 namespace oneflow {
 
 OneflowVM::OneflowVM(const Resource& resource, int64_t this_machine_id)
-    : vm_(ObjectMsgPtr<vm::VirtualMachine>::New(vm::MakeVmDesc(resource, this_machine_id).Get())) {
+    : allocator_(kAllocatorMemSizeShiftMax, kAllocatorPrefetchCnt),
+      vm_(ObjectMsgPtr<vm::VirtualMachine>::NewFrom(
+          &allocator_, vm::MakeVmDesc(resource, this_machine_id).Get())),
+      received_cnt_(0),
+      done_cnt_(0),
+      exiting_(false) {
+  // each thread context runs its pending instructions on its own thread, parking when idle
   OBJECT_MSG_LIST_UNSAFE_FOR_EACH_PTR(vm_->mut_thread_ctx_list(), thread_ctx) {
-    auto thread_pool = std::make_unique<ThreadPool>(1);
-    CHECK(thread_ctx2thread_pool_.emplace(thread_ctx, std::move(thread_pool)).second);
+    worker_threads_.push_back(std::thread(&vm::ThreadCtx::LoopRun, thread_ctx));
   }
+  schedule_thread_ = std::thread(&OneflowVM::Loop, this);
 }
 
-void OneflowVM::TryReceiveAndRun() {
-  for (auto& pair : thread_ctx2thread_pool_) {
-    vm::ThreadCtx* thread_ctx = pair.first;
-    if (thread_ctx->mut_pending_instruction_list()->Empty()) { continue; }
-    pair.second->AddWork([thread_ctx]() { thread_ctx->TryReceiveAndRun(); });
+OneflowVM::~OneflowVM() {
+  {
+    std::unique_lock<std::mutex> lock(schedule_mutex_);
+    exiting_ = true;
+  }
+  received_cond_.notify_one();
+  schedule_thread_.join();
+  CHECK(vm_->Empty());
+  OBJECT_MSG_LIST_UNSAFE_FOR_EACH_PTR(vm_->mut_thread_ctx_list(), thread_ctx) {
+    thread_ctx->mut_pending_instruction_list()->Close();
+  }
+  for (auto& worker_thread : worker_threads_) { worker_thread.join(); }
+}
+
+void OneflowVM::Receive(vm::VirtualMachine::InstructionMsgList* instr_msg_list) {
+  // pending_msg_list of VirtualMachine is mutexed, so receiving does not race with Schedule
+  vm_->Receive(instr_msg_list);
+  {
+    std::unique_lock<std::mutex> lock(schedule_mutex_);
+    CHECK(!exiting_);
+    ++received_cnt_;
+  }
+  received_cond_.notify_one();
+}
+
+void OneflowVM::Sync() {
+  std::unique_lock<std::mutex> lock(schedule_mutex_);
+  const int64_t received_cnt = received_cnt_;
+  done_cond_.wait(lock, [this, received_cnt]() { return done_cnt_ >= received_cnt; });
+}
+
+void OneflowVM::Loop() {
+  while (true) {
+    int64_t received_cnt = 0;
+    bool exiting = false;
+    {
+      // park until new instructions arrive
+      std::unique_lock<std::mutex> lock(schedule_mutex_);
+      received_cond_.wait(lock, [this]() { return received_cnt_ > done_cnt_ || exiting_; });
+      received_cnt = received_cnt_;
+      exiting = exiting_;
+    }
+    // everything received up to received_cnt is in pending_msg_list now
+    while (!vm_->Empty()) { vm_->Schedule(); }
+    {
+      std::unique_lock<std::mutex> lock(schedule_mutex_);
+      done_cnt_ = received_cnt;
+    }
+    done_cond_.notify_all();
+    if (exiting) { break; }
   }
 }
 
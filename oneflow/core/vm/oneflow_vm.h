@@ -16,31 +16,47 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_VM_ONEFLOW_VM_H_
 #define ONEFLOW_CORE_VM_ONEFLOW_VM_H_
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "oneflow/core/common/cached_object_msg_allocator.h"
 #include "oneflow/core/vm/interpret_type.h"
 #include "oneflow/core/vm/vm_desc.msg.h"
 #include "oneflow/core/vm/virtual_machine.msg.h"
-#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
-namespace vm {
-
-class ThreadCtx;
-}
-
 class OneflowVM final {
  public:
   OneflowVM(const OneflowVM&) = delete;
   OneflowVM(OneflowVM&&) = delete;
   OneflowVM(const Resource& resource, int64_t this_machine_id);
-  ~OneflowVM() = default;
+  ~OneflowVM();
 
-  vm::VirtualMachine* mut_vm() { return vm_.Mutable(); }
-  void TryReceiveAndRun();
+  // Hands instructions over to the scheduler thread and returns without waiting for them
+  void Receive(vm::VirtualMachine::InstructionMsgList* instr_msg_list);
+  // Blocks until all instructions received before are done
+  void Sync();
 
  private:
+  void Loop();
+
+  // instructions, edges and streams of vm_ are allocated from and freed to per-thread caches
+  static const int kAllocatorMemSizeShiftMax = 20;
+  static const int64_t kAllocatorPrefetchCnt = 1;
+  ThreadLocalCachedObjectMsgAllocator allocator_;
   ObjectMsgPtr<vm::VirtualMachine> vm_;
-  HashMap<vm::ThreadCtx*, std::unique_ptr<ThreadPool>> thread_ctx2thread_pool_;
+  std::vector<std::thread> worker_threads_;
+
+  // received_cnt_ counts Receive calls, done_cnt_ how many of them the scheduler has finished.
+  std::mutex schedule_mutex_;
+  std::condition_variable received_cond_;
+  std::condition_variable done_cond_;
+  int64_t received_cnt_;
+  int64_t done_cnt_;
+  bool exiting_;
+  std::thread schedule_thread_;
 };
 
 }  // namespace oneflow
@@ -35,8 +35,11 @@ OBJECT_MSG_BEGIN(ThreadCtx);
   // links
   OBJECT_MSG_DEFINE_LIST_LINK(thread_ctx_link);
   OBJECT_MSG_DEFINE_LIST_HEAD(Stream, thread_ctx_stream_link, stream_list);
-  OBJECT_MSG_DEFINE_CONDITION_LIST_HEAD(Instruction, pending_instruction_link,
-                                        pending_instruction_list);
+  OBJECT_MSG_DEFINE_LOCK_FREE_LIST_HEAD(Instruction, pending_instruction_link,
+                                         pending_instruction_list);
+  // instructions dispatched by the scheduler in the current round, which are moved to
+  // pending_instruction_list all at once. Only accessed by the scheduler thread.
+  OBJECT_MSG_DEFINE_LIST_HEAD(Instruction, pending_instruction_link, dispatched_instruction_list);
 
   OF_PRIVATE ObjectMsgConditionListStatus ReceiveAndRun();
   OF_PUBLIC ObjectMsgConditionListStatus TryReceiveAndRun();
@@ -331,22 +331,34 @@ void VirtualMachine::FilterReadyInstructions(NewInstructionList* new_instruction
 
 void VirtualMachine::DispatchAndPrescheduleInstructions(
     ReadyInstructionList* ready_instruction_list) {
-  PrescheduledInstructionList prescheduled;
   auto* active_stream_list = mut_active_stream_list();
-  OBJECT_MSG_LIST_FOR_EACH_PTR(ready_instruction_list, instruction) {
-    auto* stream = instruction->mut_stream();
-    ready_instruction_list->MoveToDstBack(instruction, stream->mut_running_instruction_list());
-    if (stream->is_active_stream_link_empty()) { active_stream_list->PushBack(stream); }
-    const auto& stream_type = stream->stream_type();
-    if (stream_type.SharingVirtualMachineThread()) {
-      stream_type.Run(this, instruction);
-    } else {
-      stream->mut_thread_ctx()->mut_pending_instruction_list()->PushBack(instruction);
+  // A stream runs its instructions in order, so an instruction whose remaining in-edges all come
+  // from instructions just dispatched to the same stream is ready as well. Dispatching those
+  // prescheduled instructions in the same round hands a chain of dependent instructions on one
+  // stream to its thread as a single batch instead of one instruction per round.
+  while (!ready_instruction_list->empty()) {
+    PrescheduledInstructionList prescheduled;
+    OBJECT_MSG_LIST_FOR_EACH_PTR(ready_instruction_list, instruction) {
+      auto* stream = instruction->mut_stream();
+      ready_instruction_list->MoveToDstBack(instruction, stream->mut_running_instruction_list());
+      if (stream->is_active_stream_link_empty()) { active_stream_list->PushBack(stream); }
+      const auto& stream_type = stream->stream_type();
+      if (stream_type.SharingVirtualMachineThread()) {
+        stream_type.Run(this, instruction);
+      } else {
+        stream->mut_thread_ctx()->mut_dispatched_instruction_list()->PushBack(instruction);
+      }
+      TryMoveWaitingToReady(instruction, &prescheduled,
+                            [stream](Instruction* dst) { return &dst->stream() == stream; });
     }
-    TryMoveWaitingToReady(instruction, &prescheduled,
-                          [stream](Instruction* dst) { return &dst->stream() == stream; });
+    prescheduled.MoveTo(ready_instruction_list);
+  }
+  // one push onto the pending list of each thread
+  OBJECT_MSG_LIST_UNSAFE_FOR_EACH_PTR(mut_thread_ctx_list(), thread_ctx) {
+    auto* dispatched_instruction_list = thread_ctx->mut_dispatched_instruction_list();
+    if (dispatched_instruction_list->empty()) { continue; }
+    thread_ctx->mut_pending_instruction_list()->MoveFrom(dispatched_instruction_list);
   }
-  prescheduled.MoveTo(ready_instruction_list);
 }
 
 template<typename ReadyList, typename IsEdgeReadyT>
@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/vm/oneflow_vm.h"
 #include "oneflow/core/vm/instruction.msg.h"
 #include "oneflow/core/vm/instruction.pb.h"
+#include "oneflow/core/vm/instruction_stream.h"
 #include "oneflow/core/vm/stream_type.h"
 #include "oneflow/core/vm/instruction_type.h"
 #include "oneflow/core/job/resource_desc.h"
@@ -27,8 +28,6 @@ limitations under the License.
 namespace oneflow {
 namespace vm {
 
-using InstructionMsgList = OBJECT_MSG_LIST(InstructionMsg, instr_msg_link);
-
 ObjectMsgPtr<InstructionMsg> NewInstruction(const std::string& instr_type_name) {
   return ObjectMsgPtr<InstructionMsg>::New(instr_type_name);
 }
@@ -40,19 +39,36 @@ Maybe<void> Run(const std::string& instruction_list_str) {
   return Run(instruction_list_proto);
 }
 
+namespace {
+
+Maybe<void> RunInstrMsgList(InstructionMsgList* instr_msg_list) {
+  auto* oneflow_vm = JUST(GlobalMaybe<OneflowVM>());
+  oneflow_vm->Receive(instr_msg_list);
+  if (!Global<ResourceDesc, ForSession>::Get()->resource().enable_async_vm_schedule()) {
+    oneflow_vm->Sync();
+  }
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
 Maybe<void> Run(const InstructionListProto& instruction_list_proto) {
   InstructionMsgList instr_msg_list;
   for (const auto& instr_proto : instruction_list_proto.instruction()) {
     auto instr_msg = ObjectMsgPtr<InstructionMsg>::New(instr_proto);
     instr_msg_list.EmplaceBack(std::move(instr_msg));
   }
-  auto* oneflow_vm = JUST(GlobalMaybe<OneflowVM>());
-  auto* vm = oneflow_vm->mut_vm();
-  vm->Receive(&instr_msg_list);
-  while (!vm->Empty()) {
-    vm->Schedule();
-    oneflow_vm->TryReceiveAndRun();
-  }
+  return RunInstrMsgList(&instr_msg_list);
+}
+
+Maybe<void> Run(const InstructionStream& instruction_stream) {
+  InstructionMsgList instr_msg_list;
+  JUST(instruction_stream.Decode(&instr_msg_list));
+  return RunInstrMsgList(&instr_msg_list);
+}
+
+Maybe<void> Sync() {
+  JUST(GlobalMaybe<OneflowVM>())->Sync();
   return Maybe<void>::Ok();
 }
 
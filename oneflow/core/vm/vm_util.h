@@ -24,11 +24,16 @@ namespace vm {
 
 class InstructionMsg;
 class InstructionListProto;
+class InstructionStream;
 
 ObjectMsgPtr<InstructionMsg> NewInstruction(const std::string& instr_type_name);
 
 Maybe<void> Run(const std::string& instruction_list_proto_str);
+// Instructions are scheduled asynchronously unless resource.enable_async_vm_schedule is false,
+// use Sync() or a callback instruction to wait for their results.
 Maybe<void> Run(const InstructionListProto& instruction_list_proto);
+Maybe<void> Run(const InstructionStream& instruction_stream);
+Maybe<void> Sync();
 
 }  // namespace vm
 }  // namespace oneflow
@@ -0,0 +1,77 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+# Measures session startup (job compilation and runtime construction) time for many small jobs,
+# i.e. the time to the first iteration. Every function has one input and one output, which adds a
+# System-Push and a System-Pull job per function.
+#
+#   python3 startup_benchmark.py --num_functions 128 --actor_construction_thread_pool_size 1
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as tp
+
+parser = argparse.ArgumentParser(description="job compilation startup benchmark")
+parser.add_argument("--num_functions", type=int, default=64)
+parser.add_argument("--num_layers", type=int, default=8)
+parser.add_argument("--actor_construction_thread_pool_size", type=int, default=0)
+args = parser.parse_args()
+
+
+def make_function(idx):
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+
+    def func(x: tp.Numpy.Placeholder((16, 64))) -> tp.Numpy:
+        with flow.scope.placement("cpu", "0:0"):
+            for layer in range(args.num_layers):
+                x = flow.layers.dense(
+                    x, 64, activation=flow.math.relu, name="f{}_d{}".format(idx, layer)
+                )
+        return x
+
+    func.__name__ = "startup_benchmark_func_{}".format(idx)
+    return flow.global_function(function_config=func_config)(func)
+
+
+def main():
+    if args.actor_construction_thread_pool_size > 0:
+        flow.config.actor_construction_thread_pool_size(
+            args.actor_construction_thread_pool_size
+        )
+    functions = [make_function(i) for i in range(args.num_functions)]
+    x = np.random.rand(16, 64).astype(np.float32)
+    start = time.time()
+    # the first call initializes the session, which compiles all jobs and constructs all actors
+    functions[0](x)
+    startup_time = time.time() - start
+    start = time.time()
+    functions[0](x)
+    iteration_time = time.time() - start
+    print(
+        "functions: {}, actor_construction_thread_pool_size: {}, "
+        "time to first iteration: {:.3f}s, second iteration: {:.3f}s".format(
+            args.num_functions,
+            args.actor_construction_thread_pool_size,
+            startup_time,
+            iteration_time,
+        )
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,71 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+# Measures eager op throughput for small ops, where host side overhead dominates. Compare runs
+# with and without the eager kernel cache, which skips the op inference on a hit:
+#
+#   python3 op_dispatch_benchmark.py
+#   python3 op_dispatch_benchmark.py --kernel_cache_size 0
+import argparse
+import time
+
+import numpy as np
+import oneflow as flow
+import oneflow.typing as tp
+import oneflow_api
+
+parser = argparse.ArgumentParser(description="eager op dispatch benchmark")
+parser.add_argument("--num_ops", type=int, default=100)
+parser.add_argument("--num_iters", type=int, default=20)
+parser.add_argument("--shape", type=int, nargs="+", default=[16, 16])
+parser.add_argument("--device", type=str, default="cpu")
+parser.add_argument("--kernel_cache_size", type=int, default=None)
+args = parser.parse_args()
+
+
+def main():
+    flow.enable_eager_execution(True)
+    if args.kernel_cache_size is not None:
+        flow.config.eager_kernel_cache_size(args.kernel_cache_size)
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.default_logical_view(flow.scope.mirrored_view())
+
+    @flow.global_function(function_config=func_config)
+    def ElementwiseJob(x: tp.Numpy.Placeholder(tuple(args.shape))) -> tp.Numpy:
+        with flow.scope.placement(args.device, "0:0"):
+            for _ in range(args.num_ops):
+                x = flow.math.relu(x) + 1.0
+        return x
+
+    x = np.random.rand(*args.shape).astype(np.float32)
+    # warm up
+    ElementwiseJob(x)
+    start = time.time()
+    for _ in range(args.num_iters):
+        ElementwiseJob(x)
+    elapsed = time.time() - start
+    # relu and scalar add per loop step
+    op_cnt = 2 * args.num_ops * args.num_iters
+    hit_cnt, miss_cnt = oneflow_api.eager.KernelCacheHitAndMissCount()
+    print(
+        "ops: {}, time: {:.3f}s, ops/s: {:.1f}, us/op: {:.1f}, kernel cache hit: {}, miss: {}".format(
+            op_cnt, elapsed, op_cnt / elapsed, elapsed * 1e6 / op_cnt, hit_cnt, miss_cnt
+        )
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -184,6 +184,96 @@ def compute_thread_pool_size(val):
     sess.config_proto.resource.compute_thread_pool_size = val
 
 
+@oneflow_export("config.plan_cache_dir")
+def api_plan_cache_dir(val: str) -> None:
+    r"""Set up the directory of the on-disk plan cache. Compiled plans are stored there and
+    reused by later sessions with the same jobs, resource and OneFlow version.
+
+    Args:
+        val (str): cache directory, empty string disables the cache
+    """
+    return enable_if.unique([plan_cache_dir, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def plan_cache_dir(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is str
+    sess.config_proto.resource.plan_cache_dir = val
+
+
+@oneflow_export("config.enable_compact_plan_distribution")
+def api_enable_compact_plan_distribution(val: bool = True) -> None:
+    r"""Whether or not distribute the plan to other machines compressed, chunked and with
+    deduplicated op attributes. Worth enabling for large clusters and plans.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_compact_plan_distribution, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_compact_plan_distribution(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.enable_compact_plan_distribution = val
+
+
+@oneflow_export("config.actor_construction_thread_pool_size")
+def api_actor_construction_thread_pool_size(val: int) -> None:
+    r"""Set up the number of threads used to construct the actors of CPU actor threads at
+    runtime startup
+
+    Args:
+        val (int): size of thread pool, 1 constructs actors on their own actor threads
+    """
+    return enable_if.unique([actor_construction_thread_pool_size, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def actor_construction_thread_pool_size(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.actor_construction_thread_pool_size = val
+
+
+@oneflow_export("config.enable_async_vm_schedule")
+def api_enable_async_vm_schedule(val: bool = True) -> None:
+    r"""Whether or not return from eager instruction dispatch before the instructions finish.
+    The virtual machine schedules them on its own thread then.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_async_vm_schedule, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_async_vm_schedule(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.enable_async_vm_schedule = val
+
+
+@oneflow_export("config.eager_kernel_cache_size")
+def api_eager_kernel_cache_size(val: int) -> None:
+    r"""Set up the number of initialized kernels the eager mode keeps for reuse by later calls
+    with the same op conf, input blob descs and placement.
+
+    Args:
+        val (int): number of cached kernels, 0 disables the cache. Defaults to 1024.
+    """
+    return enable_if.unique([eager_kernel_cache_size, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def eager_kernel_cache_size(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.eager_kernel_cache_size = val
+
+
 @oneflow_export("config.rdma_mem_block_mbyte")
 def api_rdma_mem_block_mbyte(val: int) -> None:
     r"""Set up the memory block size in rdma mode.
@@ -395,6 +485,57 @@ def collect_act_event(val=True):
     sess.config_proto.profile_conf.collect_act_event = val
 
 
+@oneflow_export("config.collect_runtime_metrics")
+def api_collect_runtime_metrics(val: bool = True) -> None:
+    r"""Whether or not collect runtime metrics of actors, threads, CommNet and allocators.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([collect_runtime_metrics, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def collect_runtime_metrics(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.profiler_conf.collect_runtime_metrics = val
+
+
+@oneflow_export("config.runtime_metrics_dump_path")
+def api_runtime_metrics_dump_path(val: str) -> None:
+    r"""Set up the file runtime metrics are dumped to. Defaults to runtime_metrics.txt in log dir.
+
+    Args:
+        val (str): path of the dump file
+    """
+    return enable_if.unique([runtime_metrics_dump_path, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def runtime_metrics_dump_path(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is str
+    sess.config_proto.profiler_conf.runtime_metrics_dump_path = val
+
+
+@oneflow_export("config.runtime_metrics_dump_interval_ms")
+def api_runtime_metrics_dump_interval_ms(val: int) -> None:
+    r"""Set up the interval of dumping runtime metrics. 0 means dumping only when runtime exits.
+
+    Args:
+        val (int): interval in milliseconds
+    """
+    return enable_if.unique([runtime_metrics_dump_interval_ms, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def runtime_metrics_dump_interval_ms(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.profiler_conf.runtime_metrics_dump_interval_ms = val
+
+
 @oneflow_export("config.collective_boxing.enable_fusion")
 def api_enable_fusion(val: bool = True) -> None:
     r"""Whether or not allow fusion the operators
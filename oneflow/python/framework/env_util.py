@@ -140,6 +140,22 @@ def ctrl_port(val):
     default_env_proto.ctrl_port = val
 
 
+@oneflow_export("env.ctrl_tree_fanout")
+def api_ctrl_tree_fanout(val: int) -> None:
+    r"""Set the fanout of the tree that machine-level barriers and broadcasts run on. Same on every machine.
+
+    Args:
+        val: number of children per machine in the tree, 0 keeps them on the master machine
+    """
+    return enable_if.unique([ctrl_tree_fanout, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.env_initialized)
+def ctrl_tree_fanout(val):
+    assert type(val) is int
+    default_env_proto.ctrl_tree_fanout = val
+
+
 @oneflow_export("env.data_port")
 def api_data_port(val: int) -> None:
     r"""Set port number used to data transfer among multiple machines. Same on every machine.
@@ -297,7 +297,7 @@ def static_mem_alloc_policy_white_list_add_policy(func_desc, policy):
     getattr(
         func_desc.job_config_proto.mutable_memory_allocation_algorithm_conf(),
         "set_" + policy,
-    )(Ture)
+    )(True)
 
 
 @oneflow_function_config("static_mem_alloc_policy_white_list.remove")
@@ -355,10 +355,39 @@ def policy_time_line(func_desc):
     return "use_time_line_algo"
 
 
+@oneflow_function_config("static_mem_alloc_policy_white_list.policy_mem_packing")
+def policy_mem_packing(func_desc):
+    r"""A static memory allocation policy called: mem_packing
+
+    Args:
+        func_desc ([type]): [description]
+
+    Returns:
+        [type]: [description]
+    """
+    return "use_mem_packing_algo"
+
+
+@oneflow_function_config("mem_packing_algo_search_step_budget")
+def set_mem_packing_algo_search_step_budget(func_desc, value):
+    r"""Set the work the mem_packing static memory allocation policy may spend refining the
+    offsets of each memory chain. Placing a register costs one step plus one per register alive
+    at the same time, so the plan is the same on every machine. Defaults to 10000000
+
+    Args:
+        func_desc ([type]): [description]
+        value (int): Search steps per memory chain.
+    """
+    func_desc.job_config_proto.mutable_memory_allocation_algorithm_conf().set_mem_packing_algo_search_step_budget(
+        value
+    )
+
+
 @oneflow_function_config("static_mem_alloc_algo_white_list.show")
 def show_static_mem_alloc_algo_white_list(func_desc):
     r"""Show configuration of  static memory allocation policy,
-          including: "use_mem_size_first_algo", "use_mutual_exclusion_first_algo", "use_time_line_algo"
+          including: "use_mem_size_first_algo", "use_mutual_exclusion_first_algo", "use_time_line_algo",
+          "use_mem_packing_algo"
 
     Args:
         func_desc ([type]): [description]
@@ -370,6 +399,7 @@ def show_static_mem_alloc_algo_white_list(func_desc):
         "use_mem_size_first_algo",
         "use_mutual_exclusion_first_algo",
         "use_time_line_algo",
+        "use_mem_packing_algo",
     ]
 
 
@@ -507,6 +537,21 @@ def set_enable_inplace(func_desc, value=True):
     func_desc.job_config_proto.set_enable_inplace(value)
 
 
+@oneflow_function_config("auto_checkpointing_memory_budget_mbyte")
+def set_auto_checkpointing_memory_budget_mbyte(func_desc, value):
+    r"""Recompute forward ops picked automatically in the backward pass, in addition to those
+    of checkpointing scopes, to keep the estimated peak memory of the activations on every device
+    under the budget, e.g. 8192mb. The peaks are estimated on the topological order of the ops
+    and may differ from the memory reuse of the plan. The picked ops and the estimated peaks are
+    reported in auto_checkpointing_job<job_id> of the log directory
+
+    Args:
+        func_desc ([type]): [description]
+        value (int): Memory budget in MByte.
+    """
+    func_desc.job_config_proto.set_auto_checkpointing_memory_budget_mbyte(value)
+
+
 @oneflow_function_config("enable_inplace_in_reduce_struct")
 def set_enable_inplace_in_reduce_struct(func_desc, value=True):
     print(
@@ -250,6 +250,8 @@ class Session(object):
         del self.job_name2module_name2module_
         self.ReleaseLazyRefBlob()
         self.ForceReleaseEagerBlobs()
+        # eager instructions are scheduled asynchronously, wait for them before tearing down
+        oneflow_api.vm.Sync()
         oneflow_api.StopLazyGlobalSession()
         oneflow_api.DestroyLazyGlobalSession()
         self.status_ = SessionStatus.CLOSED
@@ -269,6 +271,7 @@ class Session(object):
             self.cond_var_.wait()
         assert self.running_job_cnt_ == 0
         self.cond_var_.release()
+        oneflow_api.vm.Sync()
 
     def ReleaseLazyRefBlob(self):
         self.op_name2lazy_blob_cache_.clear()
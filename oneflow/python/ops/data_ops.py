@@ -15,6 +15,8 @@ limitations under the License.
 """
 from __future__ import absolute_import
 
+import os
+import struct
 from typing import Optional, Sequence, Tuple, Union, List
 
 import oneflow as flow
@@ -290,6 +292,12 @@ def ofrecord_reader(
     random_shuffle: bool = False,
     shuffle_buffer_size: int = 1024,
     shuffle_after_epoch: bool = False,
+    lazy_parse: bool = False,
+    indexed: bool = False,
+    start_cursor: int = 0,
+    cache_mode: str = "none",
+    cache_dir: str = "",
+    cache_memory_budget: int = -1,
     name: Optional[str] = None,
 ) -> oneflow_api.BlobDesc:
     r"""Get ofrecord object from ofrecord dataset.
@@ -303,6 +311,12 @@ def ofrecord_reader(
         random_shuffle (bool, optional): Determines records shuffled or not. Defaults to False.
         shuffle_buffer_size (int, optional): Shuffle buffer size. Defaults to 1024.
         shuffle_after_epoch (bool, optional): Shuffled or not after each epoch. Defaults to False.
+        lazy_parse (bool, optional): Keep the records serialized and let the ofrecord decoders read only the features they need, instead of parsing every feature. The result can only be consumed by the ofrecord decoders. Defaults to False.
+        indexed (bool, optional): Read the records by their offsets in the part files, see :func:`oneflow.data.generate_record_index`. Every epoch is then a global permutation of all the records when random_shuffle is set, or every epoch but the first with shuffle_after_epoch, and every rank reads the same number of records. Defaults to False.
+        start_cursor (int, optional): With indexed, the number of records this rank has already read, e.g. the train step times the local batch size, to resume from the middle of an epoch. Defaults to 0.
+        cache_mode (str, optional): "memory" or "file" to keep the records this rank reads in the first epoch, in memory or in a local file under cache_dir, and serve the later epochs from that cache instead of the part files, shuffling the cached records every epoch when random_shuffle is set. Not supported together with indexed or shuffle_after_epoch, since the part files of a rank stay the same. Defaults to "none".
+        cache_dir (str, optional): Local directory of the cache files of cache_mode "file". Defaults to "".
+        cache_memory_budget (int, optional): With cache_mode "memory", the maximum bytes of records to cache, memory is allocated in blocks as records arrive and the reader falls back to reading the part files when an epoch does not fit. -1 means no limit. Defaults to -1.
         name (Optional[str], optional): Optional name. Defaults to None.
         
     Returns:
@@ -366,6 +380,12 @@ def ofrecord_reader(
         .Attr("shuffle_buffer_size", shuffle_buffer_size)
         .Attr("shuffle_after_epoch", shuffle_after_epoch)
         .Attr("part_name_suffix_length", part_name_suffix_length)
+        .Attr("lazy_parse", lazy_parse)
+        .Attr("indexed", indexed)
+        .Attr("start_cursor", start_cursor)
+        .Attr("cache_mode", cache_mode)
+        .Attr("cache_dir", cache_dir)
+        .Attr("cache_memory_budget", cache_memory_budget)
         .Build()
         .InferAndTryRun()
         .RemoteBlobList()[0]
@@ -478,6 +498,8 @@ def onerec_reader(
     shuffle_buffer_size=1024,
     shuffle_after_epoch=False,
     verify_example=True,
+    indexed=False,
+    start_cursor=0,
     name=None,
 ):
     assert isinstance(files, (list, tuple))
@@ -496,7 +518,54 @@ def onerec_reader(
         .Attr("shuffle_buffer_size", shuffle_buffer_size)
         .Attr("shuffle_after_epoch", shuffle_after_epoch)
         .Attr("verify_example", verify_example)
+        .Attr("indexed", indexed)
+        .Attr("start_cursor", start_cursor)
         .Build()
         .InferAndTryRun()
         .RemoteBlobList()[0]
     )
+
+
+_RECORD_INDEX_MAGIC = 0x5844494345524F46  # 'OFRECIDX', little endian
+_ONEREC_MAGIC = 0x24434552454E4F5E  # '^ONEREC$', little endian
+
+
+@oneflow_export("data.generate_record_index")
+def generate_record_index(
+    files: Union[str, Sequence[str]], record_format: str = "ofrecord"
+) -> None:
+    r"""Write the sidecar index `<file>.index` of local record files, which holds the offset and
+    the length of every record. The readers use it when `indexed` is set, and scan the files
+    at startup when it is missing.
+
+    Args:
+        files (Union[str, Sequence[str]]): Paths of the record files.
+        record_format (str, optional): "ofrecord" or "onerec". Defaults to "ofrecord".
+    """
+    if isinstance(files, str):
+        files = [files]
+    for path in files:
+        file_size = os.path.getsize(path)
+        entries = []
+        with open(path, "rb") as f:
+            offset = 0
+            while offset < file_size:
+                if record_format == "ofrecord":
+                    (length,) = struct.unpack("<q", f.read(8))
+                    offset += 8
+                    entries.append((offset, length))
+                    offset += length
+                elif record_format == "onerec":
+                    magic, _, length, _ = struct.unpack("<qiiQ", f.read(24))
+                    assert magic == _ONEREC_MAGIC, "bad OneRec frame in " + path
+                    offset += 24
+                    entries.append((offset, length))
+                    offset += (length + 7) // 8 * 8 + 8
+                else:
+                    raise ValueError("unknown record_format " + record_format)
+                f.seek(offset)
+        assert offset == file_size, "truncated record file " + path
+        with open(path + ".index", "wb") as f:
+            f.write(struct.pack("<qq", _RECORD_INDEX_MAGIC, len(entries)))
+            for entry in entries:
+                f.write(struct.pack("<qq", *entry))
@@ -739,6 +739,176 @@ def CropMirrorNormalize(
     )
 
 
+@oneflow_export(
+    "image.DecodeCropResizeMirrorNormalize",
+    "image.decode_crop_resize_mirror_normalize",
+)
+def api_image_decode_crop_resize_mirror_normalize(
+    input_blob: oneflow_api.BlobDesc,
+    target_size: Sequence[int],
+    mirror_blob: Optional[oneflow_api.BlobDesc] = None,
+    color_space: str = "BGR",
+    random_crop: bool = True,
+    num_attempts: int = 10,
+    seed: Optional[int] = None,
+    random_area: Sequence[float] = [0.08, 1.0],
+    random_aspect_ratio: Sequence[float] = [0.75, 1.333333],
+    output_layout: str = "NCHW",
+    mean: Sequence[float] = [0.0],
+    std: Sequence[float] = [1.0],
+    output_dtype: dtype_util.dtype = dtype_util.float,
+    name: str = "ImageDecodeCropResizeMirrorNormalize",
+) -> oneflow_api.BlobDesc:
+    """This operator fuses image decode, random crop, resize, horizontal flip and normalization.
+    Each encoded image is processed in one pass and written straight into the output Blob, no
+    intermediate image Blob is created.
+
+    Args:
+        input_blob (oneflow_api.BlobDesc): The encoded images, a `tensor_buffer` Blob such as the output of `flow.data.OFRecordBytesDecoder`.
+        target_size (Sequence[int]): The output image size (width, height).
+        mirror_blob (Optional[oneflow_api.BlobDesc], optional): The operation for horizontal flip, if it is `None`, the operator will not perform the horizontal flip. Defaults to None.
+        color_space (str, optional): The color space, "BGR", "RGB" or "GRAY". Defaults to "BGR".
+        random_crop (bool, optional): Whether to randomly crop the image before resizing it, the whole image is resized if it is False. Defaults to True.
+        num_attempts (int, optional): The maximum number of random cropping attempts. Defaults to 10.
+        seed (Optional[int], optional): The random seed. Defaults to None.
+        random_area (Sequence[float], optional): The random cropping area. Defaults to [0.08, 1.0].
+        random_aspect_ratio (Sequence[float], optional): The random scaled ratio. Defaults to [0.75, 1.333333].
+        output_layout (str, optional): The output format, "NCHW" or "NHWC". Defaults to "NCHW".
+        mean (Sequence[float], optional): The mean value for normalization. Defaults to [0.0].
+        std (Sequence[float], optional): The standard deviation values for normalization. Defaults to [1.0].
+        output_dtype (dtype_util.dtype, optional): The datatype of output Blob, float or float16. Defaults to dtype_util.float.
+        name (str, optional): The name for the operation. Defaults to "ImageDecodeCropResizeMirrorNormalize".
+
+    Returns:
+        oneflow_api.BlobDesc: The result Blob
+
+    For example:
+
+    .. code-block:: python
+
+        import oneflow as flow
+        import oneflow.typing as tp
+        from typing import Tuple
+
+
+        @flow.global_function(type="predict")
+        def train_data_job() -> Tuple[tp.Numpy, tp.Numpy]:
+            batch_size = 16
+            # our ofrecord file path is "./dataset/part-0"
+            ofrecord = flow.data.ofrecord_reader(
+                "./imgdataset",
+                batch_size=batch_size,
+                data_part_num=1,
+                part_name_suffix_length=-1,
+                part_name_prefix='part-',
+                random_shuffle=True,
+                shuffle_after_epoch=True,
+            )
+            encoded = flow.data.OFRecordBytesDecoder(ofrecord, "encoded")
+            rng = flow.random.CoinFlip(batch_size=batch_size)
+            image = flow.image.DecodeCropResizeMirrorNormalize(
+                encoded,
+                target_size=(224, 224),
+                mirror_blob=rng,
+                color_space="RGB",
+                mean=[123.68, 116.779, 103.939],
+                std=[58.393, 57.12, 57.375],
+            )
+            label = flow.data.OFRecordRawDecoder(
+                ofrecord, "class/label", shape=(1, ), dtype=flow.int32
+            )
+
+            return image, label
+
+        if __name__ == "__main__":
+            images, labels = train_data_job()
+            # images.shape (16, 3, 224, 224)
+
+    """
+    assert isinstance(name, str)
+    assert len(target_size) == 2
+    if seed is not None:
+        assert name is not None
+    module = flow.find_or_create_module(
+        name,
+        lambda: ImageDecodeCropResizeMirrorNormalizeModule(
+            target_size=target_size,
+            has_mirror=mirror_blob is not None,
+            color_space=color_space,
+            random_crop=random_crop,
+            num_attempts=num_attempts,
+            random_seed=seed,
+            random_area=random_area,
+            random_aspect_ratio=random_aspect_ratio,
+            output_layout=output_layout,
+            mean=mean,
+            std=std,
+            output_dtype=output_dtype,
+            name=name,
+        ),
+    )
+    return module(input_blob, mirror_blob)
+
+
+class ImageDecodeCropResizeMirrorNormalizeModule(module_util.Module):
+    def __init__(
+        self,
+        target_size: Sequence[int],
+        has_mirror: bool,
+        color_space: str,
+        random_crop: bool,
+        num_attempts: int,
+        random_seed: Optional[int],
+        random_area: Sequence[float],
+        random_aspect_ratio: Sequence[float],
+        output_layout: str,
+        mean: Sequence[float],
+        std: Sequence[float],
+        output_dtype: dtype_util.dtype,
+        name: str,
+    ):
+        module_util.Module.__init__(self, name)
+        seed, has_seed = flow.random.gen_seed(random_seed)
+        self.op_module_builder = flow.user_op_module_builder(
+            "image_decode_crop_resize_mirror_normalize"
+        ).InputSize("in", 1)
+        if has_mirror:
+            self.op_module_builder = self.op_module_builder.InputSize("mirror", 1)
+        self.op_module_builder = (
+            self.op_module_builder.Output("out")
+            .Attr("color_space", color_space)
+            .Attr("target_width", target_size[0])
+            .Attr("target_height", target_size[1])
+            .Attr("random_crop", random_crop)
+            .Attr("num_attempts", num_attempts)
+            .Attr("random_area", random_area)
+            .Attr("random_aspect_ratio", random_aspect_ratio)
+            .Attr("has_seed", has_seed)
+            .Attr("seed", seed)
+            .Attr("output_layout", output_layout)
+            .Attr("mean", mean)
+            .Attr("std", std)
+            .Attr("output_dtype", output_dtype)
+            .CheckAndComplete()
+        )
+        self.op_module_builder.user_op_module.InitOpKernel()
+
+    def forward(
+        self,
+        input: oneflow_api.BlobDesc,
+        mirror: Optional[oneflow_api.BlobDesc] = None,
+    ):
+        if self.call_seq_no == 0:
+            name = self.module_name
+        else:
+            name = id_util.UniqueStr("ImageDecodeCropResizeMirrorNormalize_")
+
+        op_builder = self.op_module_builder.OpName(name).Input("in", [input])
+        if mirror is not None:
+            op_builder = op_builder.Input("mirror", [mirror])
+        return op_builder.Build().InferAndTryRun().SoleOutputBlob()
+
+
 @oneflow_export("image.random_crop", "image_random_crop")
 def api_image_random_crop(
     input_blob: oneflow_api.BlobDesc,
@@ -0,0 +1,97 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+import cv2
+import numpy as np
+import oneflow as flow
+import oneflow.typing as oft
+
+
+def _of_image_decode_resize_mirror_normalize(
+    images, mirror, target_size, mean, std, output_layout
+):
+    image_files = [open(im, "rb") for im in images]
+    images_bytes = [imf.read() for imf in image_files]
+    static_shape = (len(images_bytes), max([len(bys) for bys in images_bytes]))
+    for imf in image_files:
+        imf.close()
+
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.default_logical_view(flow.scope.mirrored_view())
+
+    @flow.global_function(function_config=func_config)
+    def image_decode_resize_mirror_normalize_job(
+        images_def: oft.ListListNumpy.Placeholder(shape=static_shape, dtype=flow.int8),
+        mirror_def: oft.ListNumpy.Placeholder(shape=(len(images),), dtype=flow.int8),
+    ):
+        images_buffer = flow.tensor_list_to_tensor_buffer(images_def)
+        return flow.image.decode_crop_resize_mirror_normalize(
+            images_buffer,
+            target_size=target_size,
+            mirror_blob=mirror_def,
+            color_space="RGB",
+            random_crop=False,
+            output_layout=output_layout,
+            mean=mean,
+            std=std,
+        )
+
+    images_np_arr = [
+        np.frombuffer(bys, dtype=np.byte).reshape(1, -1) for bys in images_bytes
+    ]
+    mirror_np_arr = np.array(mirror, dtype=np.int8)
+    return (
+        image_decode_resize_mirror_normalize_job([images_np_arr], [mirror_np_arr])
+        .get()
+        .numpy_list()[0]
+    )
+
+
+def _compare_with_cv(test_case, images, mirror, target_size, output_layout):
+    mean = [123.68, 116.779, 103.939]
+    std = [58.393, 57.12, 57.375]
+    of_images = _of_image_decode_resize_mirror_normalize(
+        images, mirror, target_size, mean, std, output_layout
+    )
+    if output_layout == "NCHW":
+        of_images = np.transpose(of_images, (0, 2, 3, 1))
+    # undo the normalization, the decoders of opencv-python and oneflow may differ by 1
+    of_images = of_images * np.array(std) + np.array(mean)
+    for image_file, flip, of_image in zip(images, mirror, of_images):
+        image = cv2.cvtColor(cv2.imread(image_file), cv2.COLOR_BGR2RGB)
+        image = cv2.resize(image, tuple(target_size), interpolation=cv2.INTER_LINEAR)
+        if flip:
+            image = image[:, ::-1, :]
+        test_case.assertEqual(of_image.shape, image.shape)
+        test_case.assertTrue(np.allclose(of_image, image, atol=1.001))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestImageDecodeCropResizeMirrorNormalize(flow.unittest.TestCase):
+    def test_image_decode_crop_resize_mirror_normalize(test_case):
+        images = [
+            "/dataset/mscoco_2017/val2017/000000000139.jpg",
+            "/dataset/mscoco_2017/val2017/000000000632.jpg",
+        ]
+        # larger than the images, so they are decoded at full scale
+        for output_layout in ["NCHW", "NHWC"]:
+            _compare_with_cv(test_case, images, [0, 1], (700, 680), output_layout)
+
+
+if __name__ == "__main__":
+    unittest.main()
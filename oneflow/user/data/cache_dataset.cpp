@@ -0,0 +1,188 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/cache_dataset.h"
+#include <numeric>
+#include <random>
+#include <sys/mman.h>
+
+namespace oneflow {
+namespace data {
+
+namespace {
+
+constexpr size_t kMemoryCacheBlockSize = 64 * 1024 * 1024;
+
+}  // namespace
+
+CacheDataset::CacheDataset(std::unique_ptr<Dataset<TensorBuffer>>&& dataset,
+                           const std::string& cache_file_path, int64_t memory_budget,
+                           bool shuffle, int64_t seed)
+    : loader_(std::move(dataset)),
+      cache_file_path_(cache_file_path),
+      memory_budget_(memory_budget),
+      shuffle_(shuffle),
+      seed_(seed),
+      caching_(true),
+      cached_(false),
+      memory_block_size_(0),
+      memory_block_used_(0),
+      cache_file_(nullptr),
+      mapped_cache_(nullptr),
+      cache_size_(0),
+      epoch_(0),
+      pos_(0) {
+  if (!cache_file_path_.empty()) {
+    cache_file_ = fopen(cache_file_path_.c_str(), "wb");
+    PCHECK(cache_file_ != nullptr) << "Fail to create cache file " << cache_file_path_;
+  }
+}
+
+CacheDataset::~CacheDataset() {
+  if (mapped_cache_ != nullptr) {
+    PCHECK(munmap(const_cast<char*>(mapped_cache_), cache_size_) == 0);
+  }
+  if (cache_file_ != nullptr) { fclose(cache_file_); }
+  if (!cache_file_path_.empty()) { remove(cache_file_path_.c_str()); }
+}
+
+CacheDataset::LoadTargetPtrList CacheDataset::Next() {
+  if (!cached_) {
+    LoadTargetPtrList ret = NextUncached();
+    if (!ret.empty()) { return ret; }
+  }
+  if (pos_ == static_cast<int64_t>(samples_.size())) {
+    epoch_ += 1;
+    ResetEpoch();
+  }
+  const CachedSample& cached = samples_.at(order_.at(pos_));
+  pos_ += 1;
+  LoadTargetPtrList ret;
+  LoadTargetPtr sample(new TensorBuffer());
+  sample->Resize(cached.shape, cached.data_type);
+  CHECK_EQ(sample->nbytes(), cached.nbytes);
+  if (cached.nbytes > 0) { std::memcpy(sample->mut_data(), SampleData(cached), cached.nbytes); }
+  ret.push_back(std::move(sample));
+  return ret;
+}
+
+CacheDataset::LoadTargetPtrList CacheDataset::NextUncached() {
+  while (true) {
+    LoadTargetPtrList ret = loader_->Next();
+    if (!ret.empty()) {
+      if (caching_) {
+        for (const auto& sample : ret) {
+          Cache(*sample);
+          if (!caching_) { break; }
+        }
+      }
+      return ret;
+    }
+    // the end of an epoch, only the first one matters
+    if (caching_) {
+      FinishCaching();
+      return ret;
+    }
+  }
+}
+
+void CacheDataset::Cache(const TensorBuffer& sample) {
+  if (cache_file_ == nullptr) {
+    CacheInMemory(sample);
+    return;
+  }
+  const size_t nbytes = sample.nbytes();
+  samples_.push_back({sample.shape(), sample.data_type(), 0, cache_size_, nbytes});
+  PCHECK(fwrite(sample.data(), 1, nbytes, cache_file_) == nbytes)
+      << "Fail to write cache file " << cache_file_path_;
+  cache_size_ += nbytes;
+}
+
+void CacheDataset::CacheInMemory(const TensorBuffer& sample) {
+  const size_t nbytes = sample.nbytes();
+  if (memory_blocks_.empty() || memory_block_used_ + nbytes > memory_block_size_) {
+    // samples never span blocks, a large one gets a block of its own
+    size_t block_size = std::max(kMemoryCacheBlockSize, nbytes);
+    if (memory_budget_ >= 0) {
+      const size_t budget = memory_budget_;
+      block_size = std::min(block_size, budget - std::min(cache_size_, budget));
+      if (block_size < nbytes) {
+        AbandonCaching();
+        return;
+      }
+    }
+    memory_blocks_.emplace_back(new char[block_size]);
+    memory_block_size_ = block_size;
+    memory_block_used_ = 0;
+    cache_size_ += block_size;
+  }
+  samples_.push_back(
+      {sample.shape(), sample.data_type(), memory_blocks_.size() - 1, memory_block_used_, nbytes});
+  if (nbytes > 0) {
+    std::memcpy(memory_blocks_.back().get() + memory_block_used_, sample.data(), nbytes);
+  }
+  memory_block_used_ += nbytes;
+}
+
+void CacheDataset::FinishCaching() {
+  CHECK(!samples_.empty()) << "the first epoch has no sample";
+  if (cache_file_ != nullptr) {
+    PCHECK(fclose(cache_file_) == 0) << "Fail to write cache file " << cache_file_path_;
+    cache_file_ = nullptr;
+    if (cache_size_ > 0) {
+      FILE* file = fopen(cache_file_path_.c_str(), "rb");
+      PCHECK(file != nullptr) << "Fail to open cache file " << cache_file_path_;
+      void* mapped = mmap(nullptr, cache_size_, PROT_READ, MAP_SHARED, fileno(file), 0);
+      PCHECK(mapped != MAP_FAILED) << "Fail to map cache file " << cache_file_path_;
+      fclose(file);
+      mapped_cache_ = static_cast<const char*>(mapped);
+    }
+  }
+  // the samples are served from the cache from now on, close the files of the wrapped dataset
+  loader_.reset();
+  caching_ = false;
+  cached_ = true;
+  epoch_ = 1;
+  ResetEpoch();
+}
+
+void CacheDataset::AbandonCaching() {
+  LOG(WARNING) << "the samples of an epoch outgrow the cache budget of " << memory_budget_
+               << " bytes, stop caching";
+  caching_ = false;
+  samples_.clear();
+  samples_.shrink_to_fit();
+  memory_blocks_.clear();
+  memory_blocks_.shrink_to_fit();
+  cache_size_ = 0;
+}
+
+const char* CacheDataset::SampleData(const CachedSample& sample) const {
+  if (mapped_cache_ != nullptr) { return mapped_cache_ + sample.offset; }
+  return memory_blocks_.at(sample.block_id).get() + sample.offset;
+}
+
+void CacheDataset::ResetEpoch() {
+  pos_ = 0;
+  order_.resize(samples_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  if (shuffle_) {
+    std::mt19937 gen(seed_ + epoch_);
+    std::shuffle(order_.begin(), order_.end(), gen);
+  }
+}
+
+}  // namespace data
+}  // namespace oneflow
@@ -0,0 +1,85 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_CACHE_DATASET_H_
+#define ONEFLOW_USER_DATA_CACHE_DATASET_H_
+
+#include "oneflow/user/data/dataset.h"
+
+namespace oneflow {
+namespace data {
+
+// Keeps the samples of the first epoch read from the wrapped dataset, in memory or in a local
+// cache file which is memory mapped once complete, then serves all the later epochs from the
+// cache, in a new random order every epoch when shuffle is set. The wrapped dataset returns an
+// empty list at the end of each epoch, so the epoch size is only known once the first epoch has
+// been read. In memory, the samples are copied into blocks allocated as they arrive. When the
+// blocks would outgrow memory_budget (-1 for no limit), the cache is dropped and the wrapped
+// dataset keeps being read.
+class CacheDataset final : public Dataset<TensorBuffer> {
+ public:
+  using LoadTargetPtr = std::shared_ptr<TensorBuffer>;
+  using LoadTargetPtrList = std::vector<LoadTargetPtr>;
+  OF_DISALLOW_COPY_AND_MOVE(CacheDataset);
+  CacheDataset(std::unique_ptr<Dataset<TensorBuffer>>&& dataset,
+               const std::string& cache_file_path, int64_t memory_budget, bool shuffle,
+               int64_t seed);
+  ~CacheDataset() override;
+
+  LoadTargetPtrList Next() override;
+
+ private:
+  struct CachedSample {
+    Shape shape;
+    DataType data_type;
+    // the memory block of the sample, the offset is in the cache file with a cache file
+    size_t block_id;
+    size_t offset;
+    size_t nbytes;
+  };
+  LoadTargetPtrList NextUncached();
+  void Cache(const TensorBuffer& sample);
+  void CacheInMemory(const TensorBuffer& sample);
+  void FinishCaching();
+  void AbandonCaching();
+  void ResetEpoch();
+  const char* SampleData(const CachedSample& sample) const;
+
+  std::unique_ptr<Dataset<TensorBuffer>> loader_;
+  const std::string cache_file_path_;
+  const int64_t memory_budget_;
+  const bool shuffle_;
+  const int64_t seed_;
+
+  bool caching_;
+  bool cached_;
+  std::vector<CachedSample> samples_;
+  std::vector<std::unique_ptr<char[]>> memory_blocks_;
+  size_t memory_block_size_;
+  size_t memory_block_used_;
+  FILE* cache_file_;
+  const char* mapped_cache_;
+  // the bytes of the cache file, or of all the memory blocks
+  size_t cache_size_;
+
+  int64_t epoch_;
+  int64_t pos_;
+  std::vector<int64_t> order_;
+};
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_CACHE_DATASET_H_
@@ -0,0 +1,121 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/cache_dataset.h"
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include <numeric>
+
+namespace oneflow {
+namespace data {
+
+namespace test {
+
+namespace {
+
+// epochs of num_samples samples holding their index i, i + 1 chars each, each followed by an
+// empty list
+class CountingDataset final : public Dataset<TensorBuffer> {
+ public:
+  explicit CountingDataset(int64_t num_samples, int64_t* num_reads)
+      : num_samples_(num_samples), num_reads_(num_reads), index_(0) {}
+  ~CountingDataset() override = default;
+
+  LoadTargetPtrList Next() override {
+    LoadTargetPtrList ret;
+    if (index_ == num_samples_) {
+      index_ = 0;
+      return ret;
+    }
+    const int64_t index = index_++;
+    *num_reads_ += 1;
+    LoadTargetPtr sample(new TensorBuffer());
+    sample->Resize(Shape({index + 1}), DataType::kChar);
+    std::memset(sample->mut_data(), static_cast<int>(index), index + 1);
+    ret.push_back(sample);
+    return ret;
+  }
+
+ private:
+  int64_t num_samples_;
+  int64_t* num_reads_;
+  int64_t index_;
+};
+
+int64_t SampleIndex(const TensorBuffer& sample) {
+  const int64_t index = sample.data<char>()[0];
+  CHECK_EQ(sample.elem_cnt(), index + 1);
+  return index;
+}
+
+std::vector<int64_t> ReadEpoch(Dataset<TensorBuffer>* dataset, int64_t num_samples) {
+  std::vector<int64_t> indices;
+  FOR_RANGE(int64_t, i, 0, num_samples) {
+    indices.push_back(SampleIndex(*dataset->Next().front()));
+  }
+  return indices;
+}
+
+void TestCacheDataset(const std::string& cache_file_path, int64_t memory_budget) {
+  const int64_t num_samples = 100;
+  int64_t num_reads = 0;
+  CacheDataset dataset(std::unique_ptr<Dataset<TensorBuffer>>(
+                           new CountingDataset(num_samples, &num_reads)),
+                       cache_file_path, memory_budget, true, 0);
+  std::vector<int64_t> expected(num_samples);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(ReadEpoch(&dataset, num_samples), expected);
+  std::vector<int64_t> last_epoch = expected;
+  FOR_RANGE(int32_t, epoch, 0, 3) {
+    std::vector<int64_t> indices = ReadEpoch(&dataset, num_samples);
+    ASSERT_NE(indices, last_epoch);
+    last_epoch = indices;
+    std::sort(indices.begin(), indices.end());
+    ASSERT_EQ(indices, expected);
+  }
+  // later epochs never read the wrapped dataset
+  ASSERT_EQ(num_reads, num_samples);
+}
+
+}  // namespace
+
+TEST(CacheDataset, memory) { TestCacheDataset("", -1); }
+
+// the samples of an epoch take exactly 5050 bytes
+TEST(CacheDataset, memory_within_budget) { TestCacheDataset("", 5050); }
+
+TEST(CacheDataset, file) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  TestCacheDataset(JoinPath(current_dir, "/tmp_test_cache_dataset"), -1);
+}
+
+TEST(CacheDataset, over_budget) {
+  const int64_t num_samples = 100;
+  int64_t num_reads = 0;
+  CacheDataset dataset(std::unique_ptr<Dataset<TensorBuffer>>(
+                           new CountingDataset(num_samples, &num_reads)),
+                       "", 5049, true, 0);
+  FOR_RANGE(int32_t, epoch, 0, 2) {
+    std::vector<int64_t> indices = ReadEpoch(&dataset, num_samples);
+    FOR_RANGE(int64_t, i, 0, num_samples) { ASSERT_EQ(indices.at(i), i); }
+  }
+  ASSERT_EQ(num_reads, 2 * num_samples);
+}
+
+}  // namespace test
+
+}  // namespace data
+}  // namespace oneflow
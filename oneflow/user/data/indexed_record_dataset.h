@@ -0,0 +1,115 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_INDEXED_RECORD_DATASET_H_
+#define ONEFLOW_USER_DATA_INDEXED_RECORD_DATASET_H_
+
+#include "oneflow/user/data/dataset.h"
+#include "oneflow/user/data/record_index.h"
+#include "oneflow/user/data/onerec_dataset.h"
+#include "oneflow/core/framework/op_kernel.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+namespace data {
+
+// Reads the record payloads of the indexed record files in the order of a RecordIndexSampler
+// over all the records of all the files, a batch of positional reads at a time. With
+// verify_digests, OneRec records are read with their whole frame to check both digests, as the
+// sequential OneRecDataset does.
+class IndexedRecordDataset final : public Dataset<TensorBuffer> {
+ public:
+  using LoadTargetPtr = std::shared_ptr<TensorBuffer>;
+  using LoadTargetPtrList = std::vector<LoadTargetPtr>;
+  OF_DISALLOW_COPY_AND_MOVE(IndexedRecordDataset);
+  IndexedRecordDataset(user_op::KernelInitContext* ctx, const std::vector<std::string>& file_paths,
+                       const std::string& record_format, int32_t batch_size, bool verify_digests)
+      : batch_size_(batch_size), verify_digests_(verify_digests) {
+    CHECK(!verify_digests || record_format == "onerec") << record_format << " has no digests";
+    fs::FileSystem* data_fs = DataFS();
+    files_.resize(file_paths.size());
+    FOR_RANGE(size_t, i, 0, file_paths.size()) {
+      data_fs->NewRandomAccessFile(file_paths.at(i), &files_.at(i));
+      for (const RecordIndexEntry& entry :
+           LoadOrScanRecordIndex(data_fs, file_paths.at(i), record_format)) {
+        records_.push_back({static_cast<int32_t>(i), entry});
+      }
+    }
+    // the permutation must be the same on all ranks, so it never uses a per rank random seed
+    int64_t seed = ctx->Attr<int64_t>("seed");
+    if (seed == -1) { seed = kOneflowDatasetSeed; }
+    sampler_.reset(new RecordIndexSampler(
+        records_.size(), ctx->parallel_ctx().parallel_num(), ctx->parallel_ctx().parallel_id(),
+        ctx->Attr<bool>("random_shuffle"), ctx->Attr<bool>("shuffle_after_epoch"), seed,
+        ctx->Attr<int64_t>("start_cursor")));
+  }
+  ~IndexedRecordDataset() = default;
+
+  LoadTargetPtrList Next() override {
+    LoadTargetPtrList ret(batch_size_);
+    std::vector<int64_t> record_ids(batch_size_);
+    for (int64_t& record_id : record_ids) { record_id = sampler_->Next(); }
+    MultiThreadLoop(batch_size_, [&](size_t i) {
+      const IndexedRecord& record = records_.at(record_ids.at(i));
+      ret.at(i).reset(new TensorBuffer());
+      if (verify_digests_) {
+        ReadAndVerifyOneRecFrame(record, ret.at(i).get());
+        return;
+      }
+      ret.at(i)->Resize(Shape({record.entry.length}), DataType::kChar);
+      files_.at(record.file_id)
+          ->Read(record.entry.offset, record.entry.length, ret.at(i)->mut_data<char>());
+    });
+    return ret;
+  }
+
+ private:
+  struct IndexedRecord {
+    int32_t file_id;
+    RecordIndexEntry entry;
+  };
+
+  void ReadAndVerifyOneRecFrame(const IndexedRecord& record, TensorBuffer* tensor) const {
+    const int64_t payload_size = record.entry.length;
+    const int64_t frame_size =
+        kHeaderSize + RoundUp(payload_size, kPayloadAlignmentSize) + kDigestFieldSize;
+    std::vector<char> frame(frame_size);
+    files_.at(record.file_id)->Read(record.entry.offset - kHeaderSize, frame_size, frame.data());
+    OneRecFrameHeaderView header_view{};
+    std::memcpy(header_view.raw, frame.data(), kHeaderSize);
+    CHECK_EQ(header_view.header.magic, kMagicNumber);
+    CHECK_EQ(header_view.header.reserved, kReservedNumber);
+    CHECK_EQ(header_view.header.payload_size, payload_size) << "stale record index";
+    CHECK_EQ(ByteSwap(header_view.header.digest),
+             XXH64(header_view.raw, kHeaderSizeWithoutDigest, 0));
+    const char* payload = frame.data() + kHeaderSize;
+    OneRecFrameFooterView footer_view{};
+    std::memcpy(footer_view.raw, frame.data() + frame_size - kDigestFieldSize, kDigestFieldSize);
+    CHECK_EQ(ByteSwap(footer_view.digest), XXH64(payload, payload_size, 0));
+    tensor->Resize(Shape({payload_size}), DataType::kChar);
+    std::memcpy(tensor->mut_data<char>(), payload, payload_size);
+  }
+
+  int32_t batch_size_;
+  bool verify_digests_;
+  std::vector<std::unique_ptr<fs::RandomAccessFile>> files_;
+  std::vector<IndexedRecord> records_;
+  std::unique_ptr<RecordIndexSampler> sampler_;
+};
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_INDEXED_RECORD_DATASET_H_
@@ -18,10 +18,14 @@ limitations under the License.
 
 #include "oneflow/user/data/data_reader.h"
 #include "oneflow/user/data/ofrecord_dataset.h"
+#include "oneflow/user/data/indexed_record_dataset.h"
+#include "oneflow/user/data/cache_dataset.h"
 #include "oneflow/user/data/ofrecord_parser.h"
 #include "oneflow/user/data/random_shuffle_dataset.h"
 #include "oneflow/user/data/batch_dataset.h"
+#include <algorithm>
 #include <iostream>
+#include <unistd.h>
 
 namespace oneflow {
 namespace data {
@@ -29,17 +33,51 @@ namespace data {
 class OFRecordDataReader final : public DataReader<TensorBuffer> {
  public:
   OFRecordDataReader(user_op::KernelInitContext* ctx) : DataReader<TensorBuffer>(ctx) {
-    loader_.reset(new OFRecordDataset(ctx));
     parser_.reset(new OFRecordParser());
+    int32_t batch_size = ctx->TensorDesc4ArgNameAndIndex("out", 0)->shape().elem_cnt();
+    if (ctx->Attr<bool>("indexed")) {
+      CHECK(ctx->Attr<std::string>("cache_mode") == "none") << "indexed reads do not cache";
+      loader_.reset(new IndexedRecordDataset(ctx, GetOFRecordPartFilePaths(ctx), "ofrecord",
+                                             batch_size, false));
+      StartLoadThread();
+      return;
+    }
+    const std::string& cache_mode = ctx->Attr<std::string>("cache_mode");
+    if (cache_mode == "none") {
+      loader_.reset(new OFRecordDataset(ctx));
+    } else {
+      CHECK(cache_mode == "memory" || cache_mode == "file") << cache_mode;
+      // the cache keeps the part files of the first epoch, they can not be reshuffled over ranks
+      CHECK(!ctx->Attr<bool>("shuffle_after_epoch"))
+          << "shuffle_after_epoch does not work with cache_mode " << cache_mode
+          << ", use random_shuffle to shuffle the cached records";
+      const std::string cache_file_path = cache_mode == "file" ? CacheFilePath(ctx) : "";
+      int64_t seed = ctx->Attr<int64_t>("seed");
+      if (seed == -1) { seed = NewRandomSeed(); }
+      std::unique_ptr<Dataset<TensorBuffer>> dataset(new OFRecordDataset(ctx, true));
+      loader_.reset(new CacheDataset(std::move(dataset), cache_file_path,
+                                     ctx->Attr<int64_t>("cache_memory_budget"),
+                                     ctx->Attr<bool>("random_shuffle"), seed));
+    }
     if (ctx->Attr<bool>("random_shuffle")) {
       loader_.reset(new RandomShuffleDataset<TensorBuffer>(ctx, std::move(loader_)));
     }
-    int32_t batch_size = ctx->TensorDesc4ArgNameAndIndex("out", 0)->shape().elem_cnt();
     loader_.reset(new BatchDataset<TensorBuffer>(batch_size, std::move(loader_)));
     StartLoadThread();
   }
   ~OFRecordDataReader() = default;
 
+ private:
+  static std::string CacheFilePath(user_op::KernelInitContext* ctx) {
+    const std::string& cache_dir = ctx->Attr<std::string>("cache_dir");
+    CHECK(!cache_dir.empty()) << "cache_mode file needs a local cache_dir";
+    std::string op_name = ctx->user_op_conf().op_name();
+    std::replace(op_name.begin(), op_name.end(), '/', '_');
+    return JoinPath(cache_dir, op_name + "-" + std::to_string(getpid()) + "-"
+                                   + std::to_string(ctx->parallel_ctx().parallel_id())
+                                   + ".cache");
+  }
+
  protected:
   using DataReader<TensorBuffer>::loader_;
   using DataReader<TensorBuffer>::parser_;
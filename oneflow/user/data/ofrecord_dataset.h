@@ -26,28 +26,34 @@ limitations under the License.
 namespace oneflow {
 namespace data {
 
+inline std::vector<std::string> GetOFRecordPartFilePaths(user_op::KernelInitContext* ctx) {
+  const int32_t data_part_num = ctx->Attr<int32_t>("data_part_num");
+  const std::string& data_dir = ctx->Attr<std::string>("data_dir");
+  const std::string& part_name_prefix = ctx->Attr<std::string>("part_name_prefix");
+  const int32_t part_name_suffix_length = ctx->Attr<int32_t>("part_name_suffix_length");
+  std::vector<std::string> file_paths;
+  for (int i = 0; i < data_part_num; ++i) {
+    std::string num = std::to_string(i);
+    int32_t zero_count = std::max(part_name_suffix_length - static_cast<int32_t>(num.length()), 0);
+    file_paths.push_back(JoinPath(data_dir, part_name_prefix + std::string(zero_count, '0') + num));
+  }
+  return file_paths;
+}
+
 class OFRecordDataset final : public Dataset<TensorBuffer> {
  public:
   using LoadTargetPtr = std::shared_ptr<TensorBuffer>;
   using LoadTargetPtrList = std::vector<LoadTargetPtr>;
   OF_DISALLOW_COPY_AND_MOVE(OFRecordDataset);
-  OFRecordDataset(user_op::KernelInitContext* ctx) {
+  // With mark_epoch_end, Next returns an empty list at the end of every epoch of this rank
+  explicit OFRecordDataset(user_op::KernelInitContext* ctx, bool mark_epoch_end = false)
+      : mark_epoch_end_(mark_epoch_end) {
     current_epoch_ = 0;
     shuffle_after_epoch_ = ctx->Attr<bool>("shuffle_after_epoch");
 
     // in stream
     data_part_num_ = ctx->Attr<int32_t>("data_part_num");
-    std::string data_dir = ctx->Attr<std::string>("data_dir");
-    std::string part_name_prefix = ctx->Attr<std::string>("part_name_prefix");
-    int32_t part_name_suffix_length = ctx->Attr<int32_t>("part_name_suffix_length");
-
-    for (int i = 0; i < data_part_num_; ++i) {
-      std::string num = std::to_string(i);
-      int32_t zero_count =
-          std::max(part_name_suffix_length - static_cast<int32_t>(num.length()), 0);
-      data_file_paths_.push_back(
-          JoinPath(data_dir, part_name_prefix + std::string(zero_count, '0') + num));
-    }
+    data_file_paths_ = GetOFRecordPartFilePaths(ctx);
 
     parallel_id_ = ctx->parallel_ctx().parallel_id();
     parallel_num_ = ctx->parallel_ctx().parallel_num();
@@ -56,37 +62,42 @@ class OFRecordDataset final : public Dataset<TensorBuffer> {
     range_ = bs.At(parallel_id_);
     std::vector<std::string> local_file_paths = GetLocalFilePaths();
     save_to_local_ = Global<const IOConf>::Get()->save_downloaded_file_to_local_fs();
-    in_stream_.reset(
-        new PersistentInStream(DataFS(), local_file_paths, !shuffle_after_epoch_, save_to_local_));
+    const bool cyclic = !shuffle_after_epoch_ && !mark_epoch_end_;
+    in_stream_.reset(new PersistentInStream(DataFS(), local_file_paths, cyclic, save_to_local_));
   }
   ~OFRecordDataset() = default;
 
   LoadTargetPtrList Next() override {
     LoadTargetPtrList ret;
     LoadTargetPtr sample_ptr(new TensorBuffer());
-    ReadSample(*sample_ptr);
+    if (!ReadSample(*sample_ptr)) { return ret; }
     ret.push_back(std::move(sample_ptr));
     return ret;
   }
 
  private:
-  void ReadSample(TensorBuffer& tensor) {
+  // returns false at the end of an epoch with mark_epoch_end
+  bool ReadSample(TensorBuffer& tensor) {
     int64_t OFRecord_size = -1;
     char* size_ptr = reinterpret_cast<char*>(&OFRecord_size);
     if (in_stream_->ReadFully(size_ptr, sizeof(int64_t)) != 0) {
-      ShuffleAfterEpoch();
+      StartNextEpoch();
+      if (mark_epoch_end_) { return false; }
       CHECK_EQ(in_stream_->ReadFully(size_ptr, sizeof(int64_t)), 0);
     }
     CHECK_GT(OFRecord_size, 0);
     tensor.Resize(Shape({OFRecord_size}), DataType::kChar);
     CHECK_EQ(in_stream_->ReadFully(tensor.mut_data<char>(), OFRecord_size), 0);
+    return true;
   }
 
-  void ShuffleAfterEpoch() {
-    CHECK(shuffle_after_epoch_);
+  void StartNextEpoch() {
+    CHECK(shuffle_after_epoch_ || mark_epoch_end_);
     current_epoch_++;  // move to next epoch
-    std::mt19937 g(kOneflowDatasetSeed + current_epoch_);
-    std::shuffle(data_file_paths_.begin(), data_file_paths_.end(), g);
+    if (shuffle_after_epoch_) {
+      std::mt19937 g(kOneflowDatasetSeed + current_epoch_);
+      std::shuffle(data_file_paths_.begin(), data_file_paths_.end(), g);
+    }
     std::vector<std::string> local_file_paths = GetLocalFilePaths();
     in_stream_.reset(new PersistentInStream(DataFS(), local_file_paths, false, save_to_local_));
   }
@@ -97,6 +108,7 @@ class OFRecordDataset final : public Dataset<TensorBuffer> {
     return ret;
   }
 
+  const bool mark_epoch_end_;
   int32_t current_epoch_;
   bool shuffle_after_epoch_;
 
@@ -23,9 +23,11 @@ limitations under the License.
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/framework/op_kernel.h"
 #include "oneflow/core/persistence/persistent_in_stream.h"
+#include "oneflow/core/record/ofrecord_view.h"
 #include "oneflow/core/job/job_set.pb.h"
 #include "oneflow/user/data/ofrecord_dataset.h"
 #include "oneflow/user/image/image_util.h"
+#include "oneflow/user/image/jpeg_decoder.h"
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/global_for.h"
 #include <opencv2/opencv.hpp>
@@ -45,24 +47,27 @@ using BaseLoadTargetPtrList = BaseDataset::LoadTargetPtrList;
 
 namespace {
 
-void DecodeImageFromOFRecord(const OFRecord& record, const std::string& feature_name,
+void DecodeImageFromOFRecord(const OFRecordView& record, const std::string& feature_name,
                              const std::string& color_space, TensorBuffer* out) {
-  auto image_feature_it = record.feature().find(feature_name);
-  CHECK(image_feature_it != record.feature().end());
-  const Feature& image_feature = image_feature_it->second;
+  const OFRecordFeatureView& image_feature = record.Feature4Name(feature_name);
   CHECK(image_feature.has_bytes_list());
-  CHECK(image_feature.bytes_list().value_size() == 1);
-  const std::string& src_data = image_feature.bytes_list().value(0);
-  cv::Mat image = cv::imdecode(cv::Mat(1, src_data.size(), CV_8UC1, (void*)(src_data.data())),
-                               cv::IMREAD_COLOR);
+  CHECK(image_feature.value_size() == 1);
+  const char* src_data = nullptr;
+  size_t src_size = 0;
+  image_feature.GetBytes(0, &src_data, &src_size);
+  cv::Mat image;
+  if (!JpegDecodeImage(reinterpret_cast<const unsigned char*>(src_data), src_size, color_space,
+                       &image)) {
+    image = cv::imdecode(cv::Mat(1, src_size, CV_8UC1, const_cast<char*>(src_data)),
+                         cv::IMREAD_COLOR);
+    // convert color space
+    if (ImageUtil::IsColor(color_space) && color_space != "BGR") {
+      ImageUtil::ConvertColor("BGR", image, color_space, image);
+    }
+  }
   int W = image.cols;
   int H = image.rows;
 
-  // convert color space
-  if (ImageUtil::IsColor(color_space) && color_space != "BGR") {
-    ImageUtil::ConvertColor("BGR", image, color_space, image);
-  }
-
   CHECK(image.isContinuous());
   const int c = ImageUtil::IsColor(color_space) ? 3 : 1;
   CHECK_EQ(c, image.channels());
@@ -73,18 +78,13 @@ void DecodeImageFromOFRecord(const OFRecord& record, const std::string& feature_
   memcpy(out->mut_data<uint8_t>(), image.ptr(), image_shape.elem_cnt());
 }
 
-void DecodeLabelFromFromOFRecord(const OFRecord& record, const std::string& feature_name,
+void DecodeLabelFromFromOFRecord(const OFRecordView& record, const std::string& feature_name,
                                  TensorBuffer* out) {
-  auto label_feature_it = record.feature().find(feature_name);
-  CHECK(label_feature_it != record.feature().end());
-  const Feature& label_feature = label_feature_it->second;
+  const OFRecordFeatureView& label_feature = record.Feature4Name(feature_name);
   out->Resize(Shape({1}), DataType::kInt32);
-  if (label_feature.has_int32_list()) {
-    CHECK_EQ(label_feature.int32_list().value_size(), 1);
-    *out->mut_data<int32_t>() = label_feature.int32_list().value(0);
-  } else if (label_feature.has_int64_list()) {
-    CHECK_EQ(label_feature.int64_list().value_size(), 1);
-    *out->mut_data<int32_t>() = label_feature.int64_list().value(0);
+  if (label_feature.has_int32_list() || label_feature.has_int64_list()) {
+    CHECK_EQ(label_feature.value_size(), 1);
+    label_feature.CopyValues(out->mut_data<int32_t>());
   } else {
     UNIMPLEMENTED();
   }
@@ -117,9 +117,8 @@ void DecodeWorker(const std::string image_feature_name, const std::string label_
     auto receive_status = in_buffer->Receive(&serialized_record);
     if (receive_status == kBufferStatusErrorClosed) { break; }
     CHECK(receive_status == kBufferStatusSuccess);
-    OFRecord record;
-    CHECK(record.ParseFromArray(serialized_record->data<char>(),
-                                serialized_record->shape().elem_cnt()));
+    // only the image and the label are read, index the features instead of parsing them all
+    OFRecordView record(serialized_record->data<char>(), serialized_record->shape().elem_cnt());
     std::shared_ptr<ImageClassificationDataInstance> instance(
         new ImageClassificationDataInstance());
     instance->image.reset(new TensorBuffer());
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "oneflow/user/data/data_reader.h"
 #include "oneflow/user/data/onerec_dataset.h"
+#include "oneflow/user/data/indexed_record_dataset.h"
 #include "oneflow/user/data/onerec_parser.h"
 #include "oneflow/user/data/random_shuffle_dataset.h"
 #include "oneflow/user/data/batch_random_shuffle_dataset.h"
@@ -33,7 +34,11 @@ class OneRecDataReader final : public DataReader<TensorBuffer> {
     const int32_t batch_size = ctx->TensorDesc4ArgNameAndIndex("out", 0)->shape().elem_cnt();
     const auto random_shuffle = ctx->Attr<bool>("random_shuffle");
     parser_.reset(new OneRecParser());
-    if (random_shuffle) {
+    if (ctx->Attr<bool>("indexed")) {
+      const auto& files = ctx->Attr<std::vector<std::string>>("files");
+      loader_.reset(new IndexedRecordDataset(ctx, files, "onerec", batch_size,
+                                             ctx->Attr<bool>("verify_example")));
+    } else if (random_shuffle) {
       const auto mode = ctx->Attr<std::string>("shuffle_mode");
       if (mode == "batch") {
         loader_.reset(new OneRecDataset(ctx, batch_size));
@@ -0,0 +1,162 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/record_index.h"
+#include "oneflow/user/data/onerec_dataset.h"
+#include <numeric>
+
+namespace oneflow {
+namespace data {
+
+namespace {
+
+constexpr int64_t kRecordIndexMagic = 0x5844494345524F46;  // 'OFRECIDX', little endian
+constexpr uint64_t kRecordIndexHeaderSize = 2 * sizeof(int64_t);
+constexpr uint64_t kOFRecordLengthFieldSize = sizeof(int64_t);
+
+std::vector<RecordIndexEntry> ScanOFRecordFile(const fs::RandomAccessFile& file,
+                                               uint64_t file_size) {
+  std::vector<RecordIndexEntry> entries;
+  uint64_t offset = 0;
+  while (offset < file_size) {
+    CHECK_LE(offset + kOFRecordLengthFieldSize, file_size) << "truncated OFRecord file";
+    int64_t length = -1;
+    file.Read(offset, kOFRecordLengthFieldSize, reinterpret_cast<char*>(&length));
+    CHECK_GT(length, 0);
+    offset += kOFRecordLengthFieldSize;
+    entries.push_back({static_cast<int64_t>(offset), length});
+    offset += length;
+  }
+  CHECK_EQ(offset, file_size) << "truncated OFRecord file";
+  return entries;
+}
+
+std::vector<RecordIndexEntry> ScanOneRecFile(const fs::RandomAccessFile& file,
+                                             uint64_t file_size) {
+  std::vector<RecordIndexEntry> entries;
+  uint64_t offset = 0;
+  while (offset < file_size) {
+    CHECK_LE(offset + kHeaderSize, file_size) << "truncated OneRec file";
+    OneRecFrameHeaderView header_view{};
+    file.Read(offset, kHeaderSize, header_view.raw);
+    CHECK_EQ(header_view.header.magic, kMagicNumber);
+    const int32_t payload_size = header_view.header.payload_size;
+    CHECK_GE(payload_size, 0);
+    offset += kHeaderSize;
+    entries.push_back({static_cast<int64_t>(offset), payload_size});
+    offset += RoundUp(payload_size, kPayloadAlignmentSize) + kDigestFieldSize;
+  }
+  CHECK_EQ(offset, file_size) << "truncated OneRec file";
+  return entries;
+}
+
+}  // namespace
+
+std::string RecordIndexPath(const std::string& file_path) { return file_path + ".index"; }
+
+void SaveRecordIndex(fs::FileSystem* fs, const std::string& index_path,
+                     const std::vector<RecordIndexEntry>& entries) {
+  static_assert(sizeof(RecordIndexEntry) == 2 * sizeof(int64_t), "");
+  std::unique_ptr<fs::WritableFile> file;
+  fs->NewWritableFile(index_path, &file);
+  const int64_t header[2] = {kRecordIndexMagic, static_cast<int64_t>(entries.size())};
+  file->Append(reinterpret_cast<const char*>(header), sizeof(header));
+  file->Append(reinterpret_cast<const char*>(entries.data()),
+               entries.size() * sizeof(RecordIndexEntry));
+  file->Close();
+}
+
+std::vector<RecordIndexEntry> LoadRecordIndex(fs::FileSystem* fs, const std::string& index_path) {
+  std::unique_ptr<fs::RandomAccessFile> file;
+  fs->NewRandomAccessFile(index_path, &file);
+  const uint64_t file_size = fs->GetFileSize(index_path);
+  CHECK_GE(file_size, kRecordIndexHeaderSize) << "bad record index " << index_path;
+  int64_t header[2];
+  file->Read(0, kRecordIndexHeaderSize, reinterpret_cast<char*>(header));
+  CHECK_EQ(header[0], kRecordIndexMagic) << "bad record index " << index_path;
+  std::vector<RecordIndexEntry> entries(header[1]);
+  CHECK_EQ(file_size, kRecordIndexHeaderSize + entries.size() * sizeof(RecordIndexEntry))
+      << "bad record index " << index_path;
+  if (!entries.empty()) {
+    file->Read(kRecordIndexHeaderSize, entries.size() * sizeof(RecordIndexEntry),
+               reinterpret_cast<char*>(entries.data()));
+  }
+  return entries;
+}
+
+std::vector<RecordIndexEntry> ScanRecordFile(fs::FileSystem* fs, const std::string& file_path,
+                                             const std::string& record_format) {
+  std::unique_ptr<fs::RandomAccessFile> file;
+  fs->NewRandomAccessFile(file_path, &file);
+  const uint64_t file_size = fs->GetFileSize(file_path);
+  if (record_format == "ofrecord") {
+    return ScanOFRecordFile(*file, file_size);
+  } else if (record_format == "onerec") {
+    return ScanOneRecFile(*file, file_size);
+  } else {
+    UNIMPLEMENTED() << record_format;
+    return {};
+  }
+}
+
+std::vector<RecordIndexEntry> LoadOrScanRecordIndex(fs::FileSystem* fs,
+                                                    const std::string& file_path,
+                                                    const std::string& record_format) {
+  const std::string index_path = RecordIndexPath(file_path);
+  if (fs->FileExists(index_path)) { return LoadRecordIndex(fs, index_path); }
+  LOG(WARNING) << "no record index " << index_path << ", scanning " << file_path
+               << ", generate the index with flow.data.generate_record_index to skip this";
+  return ScanRecordFile(fs, file_path, record_format);
+}
+
+RecordIndexSampler::RecordIndexSampler(int64_t num_samples, int64_t parallel_num,
+                                       int64_t parallel_id, bool shuffle, bool shuffle_after_epoch,
+                                       int64_t seed, int64_t cursor)
+    : num_samples_(num_samples),
+      parallel_num_(parallel_num),
+      parallel_id_(parallel_id),
+      shuffle_(shuffle),
+      shuffle_after_epoch_(shuffle_after_epoch),
+      seed_(seed),
+      num_samples_per_rank_(num_samples / parallel_num) {
+  CHECK_GE(parallel_id, 0);
+  CHECK_LT(parallel_id, parallel_num);
+  CHECK_GT(num_samples_per_rank_, 0) << "fewer samples than ranks";
+  CHECK_GE(cursor, 0);
+  ResetEpoch(cursor / num_samples_per_rank_);
+  pos_ = cursor % num_samples_per_rank_;
+}
+
+int64_t RecordIndexSampler::Next() {
+  if (pos_ == num_samples_per_rank_) {
+    ResetEpoch(epoch_ + 1);
+    pos_ = 0;
+  }
+  const int64_t global_pos = pos_ * parallel_num_ + parallel_id_;
+  pos_ += 1;
+  return IsShuffled() ? permutation_.at(global_pos) : global_pos;
+}
+
+void RecordIndexSampler::ResetEpoch(int64_t epoch) {
+  epoch_ = epoch;
+  if (!IsShuffled()) { return; }
+  permutation_.resize(num_samples_);
+  std::iota(permutation_.begin(), permutation_.end(), 0);
+  std::mt19937_64 gen(seed_ + epoch);
+  std::shuffle(permutation_.begin(), permutation_.end(), gen);
+}
+
+}  // namespace data
+}  // namespace oneflow
@@ -0,0 +1,86 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_RECORD_INDEX_H_
+#define ONEFLOW_USER_DATA_RECORD_INDEX_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+namespace data {
+
+// Where the payload of a record lies in a record file.
+struct RecordIndexEntry {
+  int64_t offset;
+  int64_t length;
+};
+
+// The sidecar index of a record file is `<file>.index`: the int64 magic "OFRECIDX", the int64
+// number of records, then the int64 offset and length of each record payload, all little endian.
+// It can be generated offline by flow.data.generate_record_index.
+std::string RecordIndexPath(const std::string& file_path);
+void SaveRecordIndex(fs::FileSystem* fs, const std::string& index_path,
+                     const std::vector<RecordIndexEntry>& entries);
+std::vector<RecordIndexEntry> LoadRecordIndex(fs::FileSystem* fs, const std::string& index_path);
+
+// Walks the frames of a record file of record_format "ofrecord" (an int64 length before each
+// record) or "onerec", reading the frame headers only.
+std::vector<RecordIndexEntry> ScanRecordFile(fs::FileSystem* fs, const std::string& file_path,
+                                             const std::string& record_format);
+
+// Loads the sidecar index of a record file, or scans the file when it has none.
+std::vector<RecordIndexEntry> LoadOrScanRecordIndex(fs::FileSystem* fs,
+                                                    const std::string& file_path,
+                                                    const std::string& record_format);
+
+// The order in which a rank reads the samples of an indexed dataset. Every epoch is a global
+// permutation of all the samples seeded by seed and the epoch, so all ranks agree on it, and its
+// positions are dealt to the ranks round robin. Without shuffle the epochs are the identity, or
+// only the first one with shuffle_after_epoch. Each rank gets
+// num_samples / parallel_num samples per epoch, the remainder is left out of that epoch so that
+// all ranks run the same number of steps. The cursor is the number of samples the rank has been
+// handed, a sampler constructed with a saved cursor continues from there, even mid-epoch.
+class RecordIndexSampler final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(RecordIndexSampler);
+  RecordIndexSampler(int64_t num_samples, int64_t parallel_num, int64_t parallel_id, bool shuffle,
+                     bool shuffle_after_epoch, int64_t seed, int64_t cursor);
+  ~RecordIndexSampler() = default;
+
+  int64_t Next();
+  int64_t cursor() const { return epoch_ * num_samples_per_rank_ + pos_; }
+  int64_t num_samples_per_rank() const { return num_samples_per_rank_; }
+
+ private:
+  void ResetEpoch(int64_t epoch);
+  bool IsShuffled() const { return shuffle_ || (shuffle_after_epoch_ && epoch_ > 0); }
+
+  const int64_t num_samples_;
+  const int64_t parallel_num_;
+  const int64_t parallel_id_;
+  const bool shuffle_;
+  const bool shuffle_after_epoch_;
+  const int64_t seed_;
+  const int64_t num_samples_per_rank_;
+  std::vector<int64_t> permutation_;
+  int64_t epoch_;
+  int64_t pos_;
+};
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_RECORD_INDEX_H_
@@ -0,0 +1,124 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/record_index.h"
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/posix/posix_file_system.h"
+
+namespace oneflow {
+namespace data {
+
+namespace test {
+
+TEST(RecordIndex, ofrecord_file) {
+  fs::PosixFileSystem file_system;
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  const std::string file_path = JoinPath(current_dir, "/tmp_test_record_index_part-0");
+  std::vector<std::string> records;
+  std::unique_ptr<fs::WritableFile> file;
+  file_system.NewWritableFile(file_path, &file);
+  FOR_RANGE(int32_t, i, 0, 50) {
+    records.push_back(std::string(1 + i * 7 % 13, static_cast<char>('a' + i % 26)));
+    const int64_t length = records.back().size();
+    file->Append(reinterpret_cast<const char*>(&length), sizeof(length));
+    file->Append(records.back().data(), length);
+  }
+  file->Close();
+
+  const std::vector<RecordIndexEntry> scanned =
+      ScanRecordFile(&file_system, file_path, "ofrecord");
+  ASSERT_EQ(scanned.size(), records.size());
+  std::unique_ptr<fs::RandomAccessFile> data_file;
+  file_system.NewRandomAccessFile(file_path, &data_file);
+  FOR_RANGE(size_t, i, 0, records.size()) {
+    std::string record(scanned.at(i).length, '\0');
+    data_file->Read(scanned.at(i).offset, scanned.at(i).length, &record[0]);
+    ASSERT_EQ(record, records.at(i));
+  }
+
+  const std::string index_path = RecordIndexPath(file_path);
+  SaveRecordIndex(&file_system, index_path, scanned);
+  const std::vector<RecordIndexEntry> loaded =
+      LoadOrScanRecordIndex(&file_system, file_path, "ofrecord");
+  ASSERT_EQ(loaded.size(), scanned.size());
+  FOR_RANGE(size_t, i, 0, loaded.size()) {
+    ASSERT_EQ(loaded.at(i).offset, scanned.at(i).offset);
+    ASSERT_EQ(loaded.at(i).length, scanned.at(i).length);
+  }
+  file_system.DelFile(index_path);
+  file_system.DelFile(file_path);
+}
+
+TEST(RecordIndexSampler, exact_sharding) {
+  const int64_t num_samples = 103;
+  const int64_t parallel_num = 4;
+  FOR_RANGE(int64_t, epoch, 0, 3) {
+    std::vector<int32_t> seen(num_samples, 0);
+    FOR_RANGE(int64_t, parallel_id, 0, parallel_num) {
+      RecordIndexSampler sampler(num_samples, parallel_num, parallel_id, true, false, 0,
+                                 epoch * (num_samples / parallel_num));
+      ASSERT_EQ(sampler.num_samples_per_rank(), num_samples / parallel_num);
+      FOR_RANGE(int64_t, i, 0, sampler.num_samples_per_rank()) { seen.at(sampler.Next()) += 1; }
+    }
+    // every rank reads the same number of distinct samples, num_samples % parallel_num are left
+    ASSERT_EQ(std::count(seen.begin(), seen.end(), 1), num_samples / parallel_num * parallel_num);
+    ASSERT_EQ(std::count(seen.begin(), seen.end(), 0), num_samples % parallel_num);
+  }
+}
+
+TEST(RecordIndexSampler, shuffle_per_epoch) {
+  RecordIndexSampler sampler(1000, 1, 0, true, false, 0, 0);
+  std::vector<int64_t> first_epoch;
+  std::vector<int64_t> second_epoch;
+  FOR_RANGE(int32_t, i, 0, 1000) { first_epoch.push_back(sampler.Next()); }
+  FOR_RANGE(int32_t, i, 0, 1000) { second_epoch.push_back(sampler.Next()); }
+  ASSERT_NE(first_epoch, second_epoch);
+  std::sort(first_epoch.begin(), first_epoch.end());
+  std::sort(second_epoch.begin(), second_epoch.end());
+  ASSERT_EQ(first_epoch, second_epoch);
+  ASSERT_EQ(first_epoch.back(), 999);
+
+  RecordIndexSampler sequential(10, 2, 1, false, false, 0, 0);
+  FOR_RANGE(int32_t, i, 0, 10) { ASSERT_EQ(sequential.Next(), (i % 5) * 2 + 1); }
+}
+
+TEST(RecordIndexSampler, resume_from_cursor) {
+  RecordIndexSampler sampler(57, 3, 2, true, false, 7, 0);
+  std::vector<int64_t> expected;
+  FOR_RANGE(int32_t, i, 0, 100) { expected.push_back(sampler.Next()); }
+  ASSERT_EQ(sampler.cursor(), 100);
+  FOR_RANGE(int32_t, cursor, 0, 100) {
+    RecordIndexSampler resumed(57, 3, 2, true, false, 7, cursor);
+    FOR_RANGE(int32_t, i, cursor, 100) { ASSERT_EQ(resumed.Next(), expected.at(i)); }
+  }
+}
+
+TEST(RecordIndexSampler, shuffle_after_epoch) {
+  RecordIndexSampler sampler(100, 2, 0, false, true, 0, 0);
+  FOR_RANGE(int32_t, i, 0, 50) { ASSERT_EQ(sampler.Next(), i * 2); }
+  std::vector<int64_t> second_epoch;
+  FOR_RANGE(int32_t, i, 0, 50) { second_epoch.push_back(sampler.Next()); }
+  RecordIndexSampler shuffled(100, 2, 0, true, false, 0, 50);
+  FOR_RANGE(int32_t, i, 0, 50) { ASSERT_EQ(second_epoch.at(i), shuffled.Next()); }
+  RecordIndexSampler resumed(100, 2, 0, false, true, 0, 50);
+  FOR_RANGE(int32_t, i, 0, 50) { ASSERT_EQ(second_epoch.at(i), resumed.Next()); }
+}
+
+}  // namespace test
+
+}  // namespace data
+}  // namespace oneflow
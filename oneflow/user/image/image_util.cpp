@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/image/image_util.h"
+#include "oneflow/user/image/jpeg_decoder.h"
 #include <opencv2/opencv.hpp>
 
 namespace oneflow {
@@ -131,4 +132,46 @@ bool CheckInterpolationValid(const std::string& interp_type, std::ostringstream&
   return true;
 }
 
+cv::Mat DecodeRandomCropImage(const unsigned char* data, size_t length,
+                              RandomCropGenerator* random_crop_gen, const std::string& color_space,
+                              int target_width, int target_height) {
+  cv::Mat image;
+  CropWindow crop;
+  if (JpegPartialDecodeRandomCropImage(data, length, random_crop_gen, &crop, color_space,
+                                       target_width, target_height, &image)) {
+    return image;
+  }
+  image = cv::imdecode(cv::Mat(1, length, CV_8UC1, const_cast<unsigned char*>(data)),
+                       ImageUtil::IsColor(color_space) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
+  int W = image.cols;
+  int H = image.rows;
+
+  // random crop
+  if (random_crop_gen != nullptr) {
+    CHECK(image.data != nullptr);
+    cv::Mat image_roi;
+    if (crop.shape.elem_cnt() == 0) { random_crop_gen->GenerateCropWindow({H, W}, &crop); }
+    const int y = crop.anchor.At(0);
+    const int x = crop.anchor.At(1);
+    const int newH = crop.shape.At(0);
+    const int newW = crop.shape.At(1);
+    CHECK(newW > 0 && newW <= W);
+    CHECK(newH > 0 && newH <= H);
+    cv::Rect roi(x, y, newW, newH);
+    image(roi).copyTo(image_roi);
+    image = image_roi;
+    W = image.cols;
+    H = image.rows;
+    CHECK(W == newW);
+    CHECK(H == newH);
+  }
+
+  // convert color space
+  if (ImageUtil::IsColor(color_space) && color_space != "BGR") {
+    ImageUtil::ConvertColor("BGR", image, color_space, image);
+  }
+
+  return image;
+}
+
 }  // namespace oneflow
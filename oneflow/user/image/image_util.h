@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/framework/tensor.h"
+#include "oneflow/user/image/random_crop_generator.h"
 #include <opencv2/opencv.hpp>
 
 namespace oneflow {
@@ -46,6 +47,14 @@ int GetCvInterpolationFlag(const std::string& inter_type, int org_w, int org_h,
                            int res_h);
 bool CheckInterpolationValid(const std::string& interp_type, std::ostringstream& ss);
 
+// Decodes the (randomly cropped when crop_generator is not null) image in color_space, JPEGs only
+// have the crop window decoded, others are fully decoded by OpenCV then cropped. See
+// JpegPartialDecodeRandomCropImage for target_width and target_height, the result may be a
+// non-continuous view.
+cv::Mat DecodeRandomCropImage(const unsigned char* data, size_t length,
+                              RandomCropGenerator* crop_generator, const std::string& color_space,
+                              int target_width, int target_height);
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_USER_IMAGE_IMAGE_UTIL_H_
@@ -0,0 +1,240 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/image/jpeg_decoder.h"
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+
+namespace oneflow {
+
+namespace {
+
+constexpr int kJpegScaleDenom = 8;
+constexpr int kJpegCropPadding = 2;
+constexpr uint16_t kExifOrientationTag = 0x0112;
+
+struct JpegErrorManager {
+  jpeg_error_mgr pub;
+  jmp_buf jmp;
+};
+
+void JpegErrorExit(j_common_ptr cinfo) {
+  longjmp(reinterpret_cast<JpegErrorManager*>(cinfo->err)->jmp, 1);
+}
+
+void JpegOutputMessage(j_common_ptr cinfo) {
+  // warnings of corrupted data are reported by falling back to cv::imdecode
+}
+
+uint32_t ReadExifUInt(const unsigned char* p, int size, bool little_endian) {
+  uint32_t val = 0;
+  FOR_RANGE(int, i, 0, size) {
+    const int shift = little_endian ? i * 8 : (size - 1 - i) * 8;
+    val |= static_cast<uint32_t>(p[i]) << shift;
+  }
+  return val;
+}
+
+// returns the orientation recorded in the IFD0 of an APP1 Exif marker, 1 (top-left) if absent
+int GetExifOrientation(const jpeg_saved_marker_ptr marker_list) {
+  for (jpeg_saved_marker_ptr marker = marker_list; marker != nullptr; marker = marker->next) {
+    if (marker->marker != JPEG_APP0 + 1 || marker->data_length < 14) { continue; }
+    const unsigned char* exif = marker->data;
+    if (memcmp(exif, "Exif\0\0", 6) != 0) { continue; }
+    const unsigned char* tiff = exif + 6;
+    const size_t tiff_length = marker->data_length - 6;
+    bool little_endian = false;
+    if (tiff[0] == 'I' && tiff[1] == 'I') {
+      little_endian = true;
+    } else if (!(tiff[0] == 'M' && tiff[1] == 'M')) {
+      continue;
+    }
+    const size_t ifd_offset = ReadExifUInt(tiff + 4, 4, little_endian);
+    if (ifd_offset + 2 > tiff_length) { continue; }
+    const size_t num_entries = ReadExifUInt(tiff + ifd_offset, 2, little_endian);
+    FOR_RANGE(size_t, i, 0, num_entries) {
+      const size_t entry_offset = ifd_offset + 2 + i * 12;
+      if (entry_offset + 12 > tiff_length) { break; }
+      const unsigned char* entry = tiff + entry_offset;
+      if (ReadExifUInt(entry, 2, little_endian) == kExifOrientationTag) {
+        return ReadExifUInt(entry + 8, 2, little_endian);
+      }
+    }
+  }
+  return 1;
+}
+
+bool GetJpegColorSpace(const std::string& color_space, J_COLOR_SPACE* jpeg_color_space,
+                       int* num_channels) {
+  if (color_space == "BGR") {
+    *jpeg_color_space = JCS_EXT_BGR;
+    *num_channels = 3;
+  } else if (color_space == "RGB") {
+    *jpeg_color_space = JCS_EXT_RGB;
+    *num_channels = 3;
+  } else if (color_space == "GRAY") {
+    *jpeg_color_space = JCS_GRAYSCALE;
+    *num_channels = 1;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// libjpeg reports errors by longjmp, so the methods which call into it keep no automatic objects
+// with non-trivial destructors.
+class JpegDecompressor final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(JpegDecompressor);
+  JpegDecompressor() : created_(false) {
+    cinfo_.err = jpeg_std_error(&err_.pub);
+    err_.pub.error_exit = JpegErrorExit;
+    err_.pub.output_message = JpegOutputMessage;
+  }
+  ~JpegDecompressor() {
+    if (created_) { jpeg_destroy_decompress(&cinfo_); }
+  }
+
+  bool ReadHeader(const unsigned char* data, size_t length) {
+    if (setjmp(err_.jmp)) { return false; }
+    jpeg_create_decompress(&cinfo_);
+    created_ = true;
+    jpeg_mem_src(&cinfo_, const_cast<unsigned char*>(data), length);
+    jpeg_save_markers(&cinfo_, JPEG_APP0 + 1, 0xFFFF);
+    return jpeg_read_header(&cinfo_, TRUE) == JPEG_HEADER_OK;
+  }
+
+  // decodes rows [y, y + height) and at least columns [x, x + width) of the image scaled by
+  // scale_num / kJpegScaleDenom, *col_offset is where column x lands in out
+  bool Decode(J_COLOR_SPACE color_space, int num_channels, int scale_num, int x, int y, int width,
+              int height, int* col_offset, cv::Mat* out) {
+    if (setjmp(err_.jmp)) { return false; }
+    cinfo_.out_color_space = color_space;
+    cinfo_.scale_num = scale_num;
+    cinfo_.scale_denom = kJpegScaleDenom;
+    cinfo_.dct_method = JDCT_ISLOW;
+    jpeg_start_decompress(&cinfo_);
+    if (x + width > static_cast<int>(cinfo_.output_width)
+        || y + height > static_cast<int>(cinfo_.output_height)) {
+      return false;
+    }
+    JDIMENSION crop_x = x;
+    JDIMENSION crop_width = width;
+    if (crop_width < cinfo_.output_width) { jpeg_crop_scanline(&cinfo_, &crop_x, &crop_width); }
+    *col_offset = x - crop_x;
+    out->create(height, cinfo_.output_width, CV_8UC(num_channels));
+    while (static_cast<int>(cinfo_.output_scanline) < y) {
+      if (jpeg_skip_scanlines(&cinfo_, y - cinfo_.output_scanline) == 0) { return false; }
+    }
+    while (static_cast<int>(cinfo_.output_scanline) < y + height) {
+      JSAMPROW row = out->ptr<JSAMPLE>(cinfo_.output_scanline - y);
+      if (jpeg_read_scanlines(&cinfo_, &row, 1) != 1) { return false; }
+    }
+    // the remaining rows are never decoded, jpeg_destroy_decompress aborts the decompression
+    return true;
+  }
+
+  int image_width() const { return cinfo_.image_width; }
+  int image_height() const { return cinfo_.image_height; }
+  J_COLOR_SPACE jpeg_color_space() const { return cinfo_.jpeg_color_space; }
+  jpeg_saved_marker_ptr marker_list() const { return cinfo_.marker_list; }
+
+ private:
+  jpeg_decompress_struct cinfo_;
+  JpegErrorManager err_;
+  bool created_;
+};
+
+// the smallest of 1/8, 2/8, ..., 8/8 which scales the window to no smaller than the target
+int GetJpegScaleNum(int64_t width, int64_t height, int64_t target_width, int64_t target_height) {
+  if (target_width <= 0 || target_height <= 0) { return kJpegScaleDenom; }
+  FOR_RANGE(int64_t, scale_num, 1, kJpegScaleDenom) {
+    if (width * scale_num >= target_width * kJpegScaleDenom
+        && height * scale_num >= target_height * kJpegScaleDenom) {
+      return scale_num;
+    }
+  }
+  return kJpegScaleDenom;
+}
+
+int ScaleDown(int64_t val, int scale_num) { return val * scale_num / kJpegScaleDenom; }
+
+int ScaleUp(int64_t val, int scale_num) {
+  return (val * scale_num + kJpegScaleDenom - 1) / kJpegScaleDenom;
+}
+
+}  // namespace
+
+bool JpegPartialDecodeRandomCropImage(const unsigned char* data, size_t length,
+                                      RandomCropGenerator* crop_generator, CropWindow* crop,
+                                      const std::string& color_space, int target_width,
+                                      int target_height, cv::Mat* out) {
+  if (length < 3 || data[0] != 0xFF || data[1] != 0xD8 || data[2] != 0xFF) { return false; }
+  J_COLOR_SPACE out_color_space;
+  int num_channels = 0;
+  if (!GetJpegColorSpace(color_space, &out_color_space, &num_channels)) { return false; }
+  JpegDecompressor decompressor;
+  if (!decompressor.ReadHeader(data, length)) { return false; }
+  // cv::imdecode converts CMYK and applies the EXIF orientation, leave these images to it
+  if (decompressor.jpeg_color_space() == JCS_CMYK || decompressor.jpeg_color_space() == JCS_YCCK) {
+    return false;
+  }
+  if (GetExifOrientation(decompressor.marker_list()) != 1) { return false; }
+
+  const int image_width = decompressor.image_width();
+  const int image_height = decompressor.image_height();
+  int x = 0;
+  int y = 0;
+  int width = image_width;
+  int height = image_height;
+  if (crop_generator != nullptr) {
+    crop_generator->GenerateCropWindow({image_height, image_width}, crop);
+    y = crop->anchor.At(0);
+    x = crop->anchor.At(1);
+    height = crop->shape.At(0);
+    width = crop->shape.At(1);
+    CHECK(width > 0 && x + width <= image_width);
+    CHECK(height > 0 && y + height <= image_height);
+  }
+  const int scale_num = GetJpegScaleNum(width, height, target_width, target_height);
+  const int scaled_image_width = ScaleUp(image_width, scale_num);
+  const int scaled_image_height = ScaleUp(image_height, scale_num);
+  const int scaled_x = ScaleDown(x, scale_num);
+  const int scaled_y = ScaleDown(y, scale_num);
+  const int scaled_width = std::min(ScaleUp(x + width, scale_num), scaled_image_width) - scaled_x;
+  const int scaled_height =
+      std::min(ScaleUp(y + height, scale_num), scaled_image_height) - scaled_y;
+  // the outermost columns of a cropped scanline are upsampled from replicated chroma samples, so
+  // decode a few more columns than needed to keep the window identical to a full decode
+  const int padded_x = std::max(scaled_x - kJpegCropPadding, 0);
+  const int padded_width =
+      std::min(scaled_x + scaled_width + kJpegCropPadding, scaled_image_width) - padded_x;
+  int col_offset = 0;
+  cv::Mat decoded;
+  if (!decompressor.Decode(out_color_space, num_channels, scale_num, padded_x, scaled_y,
+                           padded_width, scaled_height, &col_offset, &decoded)) {
+    return false;
+  }
+  col_offset += scaled_x - padded_x;
+  if (col_offset == 0 && scaled_width == decoded.cols) {
+    *out = decoded;
+  } else {
+    *out = decoded(cv::Rect(col_offset, 0, scaled_width, scaled_height));
+  }
+  return true;
+}
+
+}  // namespace oneflow
@@ -0,0 +1,46 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_IMAGE_JPEG_DECODER_H_
+#define ONEFLOW_USER_IMAGE_JPEG_DECODER_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/user/image/random_crop_generator.h"
+#include <opencv2/opencv.hpp>
+
+namespace oneflow {
+
+// Decodes a JPEG image with libjpeg-turbo into `out`, color_space is one of "BGR", "RGB" and
+// "GRAY". When crop_generator is not null, a crop window is generated into `crop` from the image
+// size exactly as for a fully decoded image, and only that window is decoded. When target_width and
+// target_height are positive, the window is also downscaled in the DCT domain by the largest
+// factor that keeps it no smaller than the target, so the caller is expected to resize the result.
+// `out` may be a non-continuous view. Returns false if the data can not be decoded this way
+// (not a JPEG, CMYK, EXIF rotated, corrupted, ...), the caller should then fall back to
+// cv::imdecode, and crop the decoded image with `crop` if a window was already generated (its
+// shape is no longer empty), so that each image draws a single window from crop_generator.
+bool JpegPartialDecodeRandomCropImage(const unsigned char* data, size_t length,
+                                      RandomCropGenerator* crop_generator, CropWindow* crop,
+                                      const std::string& color_space, int target_width,
+                                      int target_height, cv::Mat* out);
+
+inline bool JpegDecodeImage(const unsigned char* data, size_t length,
+                            const std::string& color_space, cv::Mat* out) {
+  return JpegPartialDecodeRandomCropImage(data, length, nullptr, nullptr, color_space, 0, 0, out);
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_IMAGE_JPEG_DECODER_H_
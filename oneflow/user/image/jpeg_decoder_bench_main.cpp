@@ -0,0 +1,85 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/image/jpeg_decoder.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+
+DEFINE_int32(image_num, 64, "number of random 500x375 jpegs.");
+DEFINE_int32(iter_num, 3, "number of passes over the images.");
+
+namespace oneflow {
+
+namespace {
+
+std::vector<unsigned char> EncodeRandomJpeg(int width, int height, std::mt19937* gen) {
+  cv::Mat image(height, width, CV_8UC3);
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+  // smooth the noise a little, so the image compresses like a photo
+  cv::GaussianBlur(image, image, cv::Size(5, 5), 0);
+  const int quality = 75 + (*gen)() % 25;
+  std::vector<unsigned char> jpeg;
+  CHECK(cv::imencode(".jpg", image, jpeg, {cv::IMWRITE_JPEG_QUALITY, quality}));
+  return jpeg;
+}
+
+double ImagesPerSecond(const std::vector<std::vector<unsigned char>>& jpegs,
+                       const std::function<void(const std::vector<unsigned char>&)>& Decode) {
+  const auto start = std::chrono::steady_clock::now();
+  FOR_RANGE(int32_t, i, 0, FLAGS_iter_num) {
+    for (const auto& jpeg : jpegs) { Decode(jpeg); }
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return jpegs.size() * FLAGS_iter_num / seconds;
+}
+
+}  // namespace
+
+}  // namespace oneflow
+
+int main(int argc, char* argv[]) {
+  using namespace oneflow;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  // ImageNet-sized images cropped and resized for a 224x224 input
+  std::mt19937 gen(0);
+  std::vector<std::vector<unsigned char>> jpegs;
+  FOR_RANGE(int32_t, i, 0, FLAGS_image_num) { jpegs.push_back(EncodeRandomJpeg(500, 375, &gen)); }
+  const cv::Size target(224, 224);
+  RandomCropGenerator full_crop_generator({3.0 / 4, 4.0 / 3}, {0.08, 1.0}, 1, 10);
+  const double full = ImagesPerSecond(jpegs, [&](const std::vector<unsigned char>& jpeg) {
+    const cv::Mat image = cv::imdecode(jpeg, cv::IMREAD_COLOR);
+    CropWindow crop;
+    full_crop_generator.GenerateCropWindow({image.rows, image.cols}, &crop);
+    const cv::Rect roi(crop.anchor.At(1), crop.anchor.At(0), crop.shape.At(1), crop.shape.At(0));
+    cv::Mat resized;
+    cv::resize(image(roi), resized, target, 0, 0, cv::INTER_LINEAR);
+  });
+  RandomCropGenerator partial_crop_generator({3.0 / 4, 4.0 / 3}, {0.08, 1.0}, 1, 10);
+  const double partial = ImagesPerSecond(jpegs, [&](const std::vector<unsigned char>& jpeg) {
+    cv::Mat image;
+    CropWindow crop;
+    CHECK(JpegPartialDecodeRandomCropImage(jpeg.data(), jpeg.size(), &partial_crop_generator,
+                                           &crop, "BGR", target.width, target.height, &image));
+    cv::Mat resized;
+    cv::resize(image, resized, target, 0, 0, cv::INTER_LINEAR);
+  });
+  std::cout << "full decode: " << full << " images/s, partial decode: " << partial << " images/s"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,123 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/image/jpeg_decoder.h"
+#include <random>
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+std::vector<unsigned char> EncodeRandomJpeg(int width, int height, std::mt19937* gen) {
+  cv::Mat image(height, width, CV_8UC3);
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+  // smooth the noise a little, so the image compresses like a photo
+  cv::GaussianBlur(image, image, cv::Size(5, 5), 0);
+  const int quality = 75 + (*gen)() % 25;
+  std::vector<unsigned char> jpeg;
+  CHECK(cv::imencode(".jpg", image, jpeg, {cv::IMWRITE_JPEG_QUALITY, quality}));
+  return jpeg;
+}
+
+cv::Mat OpenCVDecode(const std::vector<unsigned char>& jpeg) {
+  return cv::imdecode(jpeg, cv::IMREAD_COLOR);
+}
+
+void CheckMatEq(const cv::Mat& lhs, const cv::Mat& rhs) {
+  ASSERT_EQ(lhs.rows, rhs.rows);
+  ASSERT_EQ(lhs.cols, rhs.cols);
+  ASSERT_EQ(lhs.type(), rhs.type());
+  ASSERT_EQ(cv::norm(lhs, rhs, cv::NORM_INF), 0);
+}
+
+}  // namespace
+
+TEST(JpegDecoder, full_decode) {
+  std::mt19937 gen(0);
+  FOR_RANGE(int32_t, i, 0, 20) {
+    const int width = 17 + gen() % 400;
+    const int height = 17 + gen() % 300;
+    const std::vector<unsigned char> jpeg = EncodeRandomJpeg(width, height, &gen);
+    cv::Mat bgr;
+    ASSERT_TRUE(JpegDecodeImage(jpeg.data(), jpeg.size(), "BGR", &bgr));
+    const cv::Mat expected = OpenCVDecode(jpeg);
+    CheckMatEq(bgr, expected);
+    cv::Mat rgb;
+    ASSERT_TRUE(JpegDecodeImage(jpeg.data(), jpeg.size(), "RGB", &rgb));
+    cv::Mat expected_rgb;
+    cv::cvtColor(expected, expected_rgb, cv::COLOR_BGR2RGB);
+    CheckMatEq(rgb, expected_rgb);
+  }
+}
+
+TEST(JpegDecoder, random_crop) {
+  std::mt19937 gen(0);
+  RandomCropGenerator crop_generator({3.0 / 4, 4.0 / 3}, {0.08, 1.0}, 1, 10);
+  RandomCropGenerator expected_crop_generator({3.0 / 4, 4.0 / 3}, {0.08, 1.0}, 1, 10);
+  FOR_RANGE(int32_t, i, 0, 50) {
+    const int width = 17 + gen() % 400;
+    const int height = 17 + gen() % 300;
+    const std::vector<unsigned char> jpeg = EncodeRandomJpeg(width, height, &gen);
+    cv::Mat cropped;
+    CropWindow crop;
+    ASSERT_TRUE(JpegPartialDecodeRandomCropImage(jpeg.data(), jpeg.size(), &crop_generator, &crop,
+                                                 "BGR", 0, 0, &cropped));
+    const cv::Mat image = OpenCVDecode(jpeg);
+    CropWindow expected_crop;
+    expected_crop_generator.GenerateCropWindow({image.rows, image.cols}, &expected_crop);
+    ASSERT_EQ(crop.anchor, expected_crop.anchor);
+    ASSERT_EQ(crop.shape, expected_crop.shape);
+    const cv::Rect roi(crop.anchor.At(1), crop.anchor.At(0), crop.shape.At(1), crop.shape.At(0));
+    CheckMatEq(cropped, image(roi));
+  }
+}
+
+TEST(JpegDecoder, scaled_random_crop) {
+  std::mt19937 gen(0);
+  RandomCropGenerator crop_generator({3.0 / 4, 4.0 / 3}, {0.08, 1.0}, 1, 10);
+  FOR_RANGE(int32_t, i, 0, 50) {
+    const int width = 17 + gen() % 600;
+    const int height = 17 + gen() % 500;
+    const std::vector<unsigned char> jpeg = EncodeRandomJpeg(width, height, &gen);
+    const int target_width = 1 + gen() % 224;
+    const int target_height = 1 + gen() % 224;
+    cv::Mat scaled;
+    CropWindow crop;
+    ASSERT_TRUE(JpegPartialDecodeRandomCropImage(jpeg.data(), jpeg.size(), &crop_generator, &crop,
+                                                 "RGB", target_width, target_height, &scaled));
+    ASSERT_EQ(scaled.channels(), 3);
+    ASSERT_GT(scaled.rows, 0);
+    ASSERT_GT(scaled.cols, 0);
+  }
+}
+
+TEST(JpegDecoder, fallback) {
+  cv::Mat image(32, 32, CV_8UC3, cv::Scalar::all(128));
+  std::vector<unsigned char> png;
+  CHECK(cv::imencode(".png", image, png));
+  cv::Mat decoded;
+  ASSERT_FALSE(JpegDecodeImage(png.data(), png.size(), "BGR", &decoded));
+  std::vector<unsigned char> jpeg;
+  CHECK(cv::imencode(".jpg", image, jpeg));
+  ASSERT_FALSE(JpegDecodeImage(jpeg.data(), jpeg.size(), "HSV", &decoded));
+  jpeg.resize(16);
+  ASSERT_FALSE(JpegDecodeImage(jpeg.data(), jpeg.size(), "BGR", &decoded));
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/user/image/image_util.h"
+#include "oneflow/user/image/jpeg_decoder.h"
 #include <opencv2/opencv.hpp>
 
 namespace oneflow {
@@ -27,12 +28,16 @@ void DecodeImage(const TensorBuffer& raw_bytes, TensorBuffer* image_buffer,
   // should only support kChar, but numpy ndarray maybe cannot convert to char*
   CHECK(raw_bytes.data_type() == DataType::kChar || raw_bytes.data_type() == DataType::kInt8
         || raw_bytes.data_type() == DataType::kUInt8);
-  cv::_InputArray raw_bytes_arr(raw_bytes.data<char>(), raw_bytes.elem_cnt());
-  cv::Mat image_mat = cv::imdecode(
-      raw_bytes_arr, (ImageUtil::IsColor(color_space) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE)
-                         | cv::IMREAD_ANYDEPTH);
-  if (ImageUtil::IsColor(color_space) && color_space != "BGR") {
-    ImageUtil::ConvertColor("BGR", image_mat, color_space, image_mat);
+  cv::Mat image_mat;
+  if (!JpegDecodeImage(static_cast<const unsigned char*>(raw_bytes.data()), raw_bytes.elem_cnt(),
+                       color_space, &image_mat)) {
+    cv::_InputArray raw_bytes_arr(raw_bytes.data<char>(), raw_bytes.elem_cnt());
+    image_mat = cv::imdecode(
+        raw_bytes_arr, (ImageUtil::IsColor(color_space) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE)
+                           | cv::IMREAD_ANYDEPTH);
+    if (ImageUtil::IsColor(color_space) && color_space != "BGR") {
+      ImageUtil::ConvertColor("BGR", image_mat, color_space, image_mat);
+    }
   }
   if (data_type == DataType::kUInt8) {
     image_mat.convertTo(image_mat, CV_8U);
@@ -404,4 +404,108 @@ REGISTER_USER_KERNEL("image_random_crop")
                      & (user_op::HobDataType("in", 0) == DataType::kTensorBuffer)
                      & (user_op::HobDataType("out", 0) == DataType::kTensorBuffer));
 
+namespace {
+
+template<TensorLayout layout, typename T>
+void MirrorNormalize1Sample(const cv::Mat& image, bool mirror, const std::vector<float>& mean_vec,
+                            const std::vector<float>& inv_std_vec, T* out_dptr) {
+  const int64_t H = image.rows;
+  const int64_t W = image.cols;
+  const int64_t C = image.channels();
+  FOR_RANGE(int64_t, h, 0, H) {
+    const uint8_t* in_row = image.ptr<uint8_t>(h);
+    FOR_RANGE(int64_t, w, 0, W) {
+      const uint8_t* in_pixel = in_row + (mirror ? W - 1 - w : w) * C;
+      FOR_RANGE(int64_t, c, 0, C) {
+        const float val = (static_cast<float>(in_pixel[c]) - mean_vec[c]) * inv_std_vec[c];
+        out_dptr[GetOffset<layout>(h, w, c, H, W, C)] = static_cast<T>(val);
+      }
+    }
+  }
+}
+
+class DecodeCropResizeMirrorNormalizeState final : public user_op::OpKernelState {
+ public:
+  explicit DecodeCropResizeMirrorNormalizeState(user_op::KernelInitContext* ctx)
+      : cmn_attr_(ctx) {
+    if (ctx->Attr<bool>("random_crop")) { random_crop_state_ = CreateRandomCropKernelState(ctx); }
+  }
+  ~DecodeCropResizeMirrorNormalizeState() = default;
+
+  const CMNAttr& cmn_attr() const { return cmn_attr_; }
+  RandomCropGenerator* GetGenerator(int32_t idx) {
+    return random_crop_state_ ? random_crop_state_->GetGenerator(idx) : nullptr;
+  }
+
+ private:
+  CMNAttr cmn_attr_;
+  std::shared_ptr<RandomCropKernelState> random_crop_state_;
+};
+
+}  // namespace
+
+// decodes, crops, resizes, mirrors and normalizes each image in one task, so no intermediate image
+// but the cropped and the resized one of a single image is ever materialized
+template<typename T>
+class ImageDecodeCropResizeMirrorNormalizeKernel final : public user_op::OpKernel {
+ public:
+  ImageDecodeCropResizeMirrorNormalizeKernel() = default;
+  ~ImageDecodeCropResizeMirrorNormalizeKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<DecodeCropResizeMirrorNormalizeState>(ctx);
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* decode_state = dynamic_cast<DecodeCropResizeMirrorNormalizeState*>(state);
+    CHECK_NOTNULL(decode_state);
+    const std::vector<float>& mean_vec = decode_state->cmn_attr().mean_vec();
+    const std::vector<float>& inv_std_vec = decode_state->cmn_attr().inv_std_vec();
+    const user_op::Tensor* in_blob = ctx->Tensor4ArgNameAndIndex("in", 0);
+    user_op::Tensor* out_blob = ctx->Tensor4ArgNameAndIndex("out", 0);
+    std::vector<int8_t> mirror = GetMirrorVec(ctx);
+    const int64_t record_num = in_blob->shape().At(0);
+    const std::string& color_space = ctx->Attr<std::string>("color_space");
+    const int64_t C = ImageUtil::IsColor(color_space) ? 3 : 1;
+    const int64_t H = ctx->Attr<int64_t>("target_height");
+    const int64_t W = ctx->Attr<int64_t>("target_width");
+    const bool is_nchw = ctx->Attr<std::string>("output_layout") == "NCHW";
+    CHECK_EQ(out_blob->shape().elem_cnt(), record_num * C * H * W);
+    const TensorBuffer* in_buffers = in_blob->dptr<TensorBuffer>();
+    T* out_dptr = out_blob->mut_dptr<T>();
+
+    MultiThreadLoop(record_num, [&](size_t i) {
+      const TensorBuffer& in_buffer = in_buffers[i];
+      const cv::Mat image = DecodeRandomCropImage(
+          static_cast<const unsigned char*>(in_buffer.data()), in_buffer.elem_cnt(),
+          decode_state->GetGenerator(i), color_space, W, H);
+      CHECK(image.data != nullptr);
+      CHECK_EQ(image.channels(), C);
+      cv::Mat resized;
+      cv::resize(image, resized, cv::Size(W, H), 0, 0, cv::INTER_LINEAR);
+      T* image_out_dptr = out_dptr + i * C * H * W;
+      if (is_nchw) {
+        MirrorNormalize1Sample<TensorLayout::kNCHW, T>(resized, mirror.at(i), mean_vec,
+                                                       inv_std_vec, image_out_dptr);
+      } else {
+        MirrorNormalize1Sample<TensorLayout::kNHWC, T>(resized, mirror.at(i), mean_vec,
+                                                       inv_std_vec, image_out_dptr);
+      }
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_IMAGE_DECODE_CROP_RESIZE_MIRROR_NORMALIZE_KERNEL(dtype)                  \
+  REGISTER_USER_KERNEL("image_decode_crop_resize_mirror_normalize")                       \
+      .SetCreateFn<ImageDecodeCropResizeMirrorNormalizeKernel<dtype>>()                   \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                 \
+                       & (user_op::HobDataType("in", 0) == DataType::kTensorBuffer)       \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+
+REGISTER_IMAGE_DECODE_CROP_RESIZE_MIRROR_NORMALIZE_KERNEL(float)
+REGISTER_IMAGE_DECODE_CROP_RESIZE_MIRROR_NORMALIZE_KERNEL(float16)
+
 }  // namespace oneflow
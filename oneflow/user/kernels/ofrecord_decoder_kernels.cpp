@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/kernel/kernel_util.h"
+#include "oneflow/core/record/ofrecord_view.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/user/image/random_crop_generator.h"
 #include "oneflow/user/image/image_util.h"
@@ -68,6 +69,66 @@ void DecodeOneRawOFRecord(const Feature& feature, T* dptr, int64_t sample_elem_c
   }
 }
 
+template<typename T>
+void DecodeOneRawOFRecord(const OFRecordFeatureView& feature, T* dptr, int64_t sample_elem_cnt,
+                          bool dim1_varying_length, bool auto_zero_padding) {
+  if (feature.has_bytes_list()) {
+    CHECK_EQ(feature.value_size(), 1);
+    const char* value0 = nullptr;
+    size_t size = 0;
+    feature.GetBytes(0, &value0, &size);
+    sample_elem_cnt = std::min<int64_t>(sample_elem_cnt, size);
+    CopyElem<int8_t, T>(reinterpret_cast<const int8_t*>(value0), dptr, sample_elem_cnt);
+  } else if (feature.has_float_list() || feature.has_double_list() || feature.has_int32_list()
+             || feature.has_int64_list()) {
+    const int64_t value_size = feature.value_size();
+    const int64_t padding_elem_num = auto_zero_padding ? sample_elem_cnt - value_size : 0;
+    if (dim1_varying_length || auto_zero_padding) {
+      CHECK_LE(value_size, sample_elem_cnt);
+      sample_elem_cnt = value_size;
+    } else {
+      CHECK_EQ(sample_elem_cnt, value_size);
+    }
+    feature.CopyValues(dptr);
+    if (padding_elem_num > 0) {
+      std::memset(dptr + sample_elem_cnt, 0, padding_elem_num * sizeof(T));
+    }
+  } else {
+    UNIMPLEMENTED();
+  }
+}
+
+// the serialized i-th record of a lazily parsed "in"
+const char* SerializedRecord(const user_op::Tensor* in, int64_t i, size_t* size) {
+  const TensorBuffer& buffer = in->dptr<TensorBuffer>()[i];
+  *size = buffer.nbytes();
+  return static_cast<const char*>(buffer.data());
+}
+
+// the single bytes value of feature `name` of the i-th record of "in", which holds parsed
+// OFRecords, or serialized ones read through OFRecordView when the reader parses lazily
+void GetOneBytesFeature(const user_op::Tensor* in, int64_t i, const std::string& name,
+                        const char** data, size_t* size) {
+  if (in->data_type() == DataType::kTensorBuffer) {
+    size_t record_size = 0;
+    const char* serialized = SerializedRecord(in, i, &record_size);
+    OFRecordView record(serialized, record_size);
+    const OFRecordFeatureView& feature = record.Feature4Name(name);
+    CHECK(feature.has_bytes_list());
+    CHECK_EQ(feature.value_size(), 1);
+    feature.GetBytes(0, data, size);
+  } else {
+    const OFRecord& record = in->dptr<OFRecord>()[i];
+    auto it = record.feature().find(name);
+    CHECK(it != record.feature().end()) << "Field " << name << " not found";
+    const Feature& feature = it->second;
+    CHECK(feature.has_bytes_list());
+    CHECK_EQ(feature.bytes_list().value_size(), 1);
+    *data = feature.bytes_list().value(0).data();
+    *size = feature.bytes_list().value(0).size();
+  }
+}
+
 }  // namespace
 
 template<typename T>
@@ -84,13 +145,24 @@ class OFRecordRawDecoderKernel final : public user_op::OpKernel {
     int64_t record_num = in_blob->shape().At(0);
     int64_t sample_elem_cnt = out_blob->shape().Count(1);
     CHECK(record_num > 0);
-    const OFRecord* records = in_blob->dptr<OFRecord>();
     T* out_dptr = out_blob->mut_dptr<T>();
     const std::string& name = ctx->Attr<std::string>("name");
 
     bool auto_zero_padding = ctx->Attr<bool>("auto_zero_padding");
     bool dim1_varying_length = ctx->Attr<bool>("dim1_varying_length");
 
+    if (in_blob->data_type() == DataType::kTensorBuffer) {
+      MultiThreadLoop(record_num, [&](size_t i) {
+        size_t record_size = 0;
+        const char* serialized = SerializedRecord(in_blob, i, &record_size);
+        OFRecordView record(serialized, record_size);
+        T* dptr = out_dptr + i * sample_elem_cnt;
+        DecodeOneRawOFRecord(record.Feature4Name(name), dptr, sample_elem_cnt, auto_zero_padding,
+                             dim1_varying_length);
+      });
+      return;
+    }
+    const OFRecord* records = in_blob->dptr<OFRecord>();
     MultiThreadLoop(record_num, [&](size_t i) {
       const OFRecord& record = *(records + i);
       T* dptr = out_dptr + i * sample_elem_cnt;
@@ -103,11 +175,12 @@ class OFRecordRawDecoderKernel final : public user_op::OpKernel {
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_RAW_DECODER_KERNEL(dtype)                                      \
-  REGISTER_USER_KERNEL("ofrecord_raw_decoder")                                  \
-      .SetCreateFn<OFRecordRawDecoderKernel<dtype>>()                           \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                       \
-                       & (user_op::HobDataType("in", 0) == DataType::kOFRecord) \
+#define REGISTER_RAW_DECODER_KERNEL(dtype)                                              \
+  REGISTER_USER_KERNEL("ofrecord_raw_decoder")                                          \
+      .SetCreateFn<OFRecordRawDecoderKernel<dtype>>()                                   \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                               \
+                       & ((user_op::HobDataType("in", 0) == DataType::kOFRecord)        \
+                          | (user_op::HobDataType("in", 0) == DataType::kTensorBuffer)) \
                        & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
 
 REGISTER_RAW_DECODER_KERNEL(char)
@@ -128,23 +201,17 @@ class OFRecordBytesDecoderKernel final : public user_op::OpKernel {
     const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
     CHECK_EQ(out->shape(), in->shape());
-    CHECK_EQ(in->data_type(), DataType::kOFRecord);
     CHECK_EQ(out->data_type(), DataType::kTensorBuffer);
     const int64_t num_instances = in->shape().elem_cnt();
-    const auto* records = in->dptr<OFRecord>();
     auto* buffers = out->mut_dptr<TensorBuffer>();
     const std::string& name = ctx->Attr<std::string>("name");
     MultiThreadLoop(num_instances, [&](size_t i) {
-      const OFRecord& record = *(records + i);
       TensorBuffer* buffer = buffers + i;
-      auto it = record.feature().find(name);
-      CHECK(it != record.feature().end()) << "Field " << name << " not found";
-      const Feature& feature = it->second;
-      CHECK(feature.has_bytes_list());
-      CHECK_EQ(feature.bytes_list().value_size(), 1);
-      const int64_t size = feature.bytes_list().value(0).size();
-      buffer->Resize(Shape({size}), DataType::kUInt8);
-      memcpy(buffer->mut_data(), feature.bytes_list().value(0).data(), size);
+      const char* data = nullptr;
+      size_t size = 0;
+      GetOneBytesFeature(in, i, name, &data, &size);
+      buffer->Resize(Shape({static_cast<int64_t>(size)}), DataType::kUInt8);
+      memcpy(buffer->mut_data(), data, size);
     });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -153,62 +220,37 @@ class OFRecordBytesDecoderKernel final : public user_op::OpKernel {
 REGISTER_USER_KERNEL("ofrecord_bytes_decoder")
     .SetCreateFn<OFRecordBytesDecoderKernel>()
     .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")
-                     & (user_op::HobDataType("in", 0) == DataType::kOFRecord)
+                     & ((user_op::HobDataType("in", 0) == DataType::kOFRecord)
+                        | (user_op::HobDataType("in", 0) == DataType::kTensorBuffer))
                      & (user_op::HobDataType("out", 0) == DataType::kTensorBuffer));
 
 namespace {
 
-void DecodeRandomCropImageFromOneRecord(const OFRecord& record, TensorBuffer* buffer,
+void DecodeRandomCropImageFromOneRecord(const user_op::Tensor* in, int64_t i, TensorBuffer* buffer,
                                         const std::string& name, const std::string& color_space,
                                         RandomCropGenerator* random_crop_gen) {
-  CHECK(record.feature().find(name) != record.feature().end()) << "Field " << name << " not found";
-  const Feature& feature = record.feature().at(name);
-  CHECK(feature.has_bytes_list());
-  CHECK(feature.bytes_list().value_size() == 1);
-  const std::string& src_data = feature.bytes_list().value(0);
-
-  // cv::_InputArray image_data(src_data.data(), src_data.size());
-  // cv::Mat image = cv::imdecode(image_data, cv::IMREAD_ANYCOLOR);
-  cv::Mat image =
-      cv::imdecode(cv::Mat(1, src_data.size(), CV_8UC1, (void*)(src_data.data())),  // NOLINT
-                   ImageUtil::IsColor(color_space) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
-  int W = image.cols;
-  int H = image.rows;
-
-  // random crop
-  if (random_crop_gen != nullptr) {
-    CHECK(image.data != nullptr);
-    cv::Mat image_roi;
-    CropWindow crop;
-    random_crop_gen->GenerateCropWindow({H, W}, &crop);
-    const int y = crop.anchor.At(0);
-    const int x = crop.anchor.At(1);
-    const int newH = crop.shape.At(0);
-    const int newW = crop.shape.At(1);
-    CHECK(newW > 0 && newW <= W);
-    CHECK(newH > 0 && newH <= H);
-    cv::Rect roi(x, y, newW, newH);
-    image(roi).copyTo(image_roi);
-    image = image_roi;
-    W = image.cols;
-    H = image.rows;
-    CHECK(W == newW);
-    CHECK(H == newH);
-  }
-
-  // convert color space
-  if (ImageUtil::IsColor(color_space) && color_space != "BGR") {
-    ImageUtil::ConvertColor("BGR", image, color_space, image);
-  }
-
-  CHECK(image.isContinuous());
+  const char* src_data = nullptr;
+  size_t src_size = 0;
+  GetOneBytesFeature(in, i, name, &src_data, &src_size);
+
+  const cv::Mat image = DecodeRandomCropImage(reinterpret_cast<const unsigned char*>(src_data),
+                                              src_size, random_crop_gen, color_space, 0, 0);
+  const int W = image.cols;
+  const int H = image.rows;
   const int c = ImageUtil::IsColor(color_space) ? 3 : 1;
   CHECK_EQ(c, image.channels());
   Shape image_shape({H, W, c});
   buffer->Resize(image_shape, DataType::kUInt8);
   CHECK_EQ(image_shape.elem_cnt(), buffer->nbytes());
   CHECK_EQ(image_shape.elem_cnt(), image.total() * image.elemSize());
-  memcpy(buffer->mut_data<uint8_t>(), image.ptr(), image_shape.elem_cnt());
+  if (image.isContinuous()) {
+    memcpy(buffer->mut_data<uint8_t>(), image.ptr(), image_shape.elem_cnt());
+  } else {
+    const int64_t row_size = W * c;
+    FOR_RANGE(int, i, 0, H) {
+      memcpy(buffer->mut_data<uint8_t>() + i * row_size, image.ptr(i), row_size);
+    }
+  }
 }
 
 }  // namespace
@@ -232,16 +274,14 @@ class OFRecordImageDecoderRandomCropKernel final : public user_op::OpKernel {
     CHECK(record_num > 0);
     user_op::Tensor* in_blob = ctx->Tensor4ArgNameAndIndex("in", 0);
     CHECK_EQ(out_blob->shape(), in_blob->shape());
-    const OFRecord* records = in_blob->dptr<OFRecord>();
     TensorBuffer* buffers = out_blob->mut_dptr<TensorBuffer>();
     const std::string& name = ctx->Attr<std::string>("name");
     const std::string& color_space = ctx->Attr<std::string>("color_space");
 
     MultiThreadLoop(record_num, [&](size_t i) {
-      const OFRecord& record = *(records + i);
       TensorBuffer* buffer = buffers + i;
       RandomCropGenerator* gen = crop_window_generators->GetGenerator(i);
-      DecodeRandomCropImageFromOneRecord(record, buffer, name, color_space, gen);
+      DecodeRandomCropImageFromOneRecord(in_blob, i, buffer, name, color_space, gen);
     });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -250,7 +290,8 @@ class OFRecordImageDecoderRandomCropKernel final : public user_op::OpKernel {
 REGISTER_USER_KERNEL("ofrecord_image_decoder_random_crop")
     .SetCreateFn<OFRecordImageDecoderRandomCropKernel>()
     .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")
-                     & (user_op::HobDataType("in", 0) == DataType::kOFRecord)
+                     & ((user_op::HobDataType("in", 0) == DataType::kOFRecord)
+                        | (user_op::HobDataType("in", 0) == DataType::kTensorBuffer))
                      & (user_op::HobDataType("out", 0) == DataType::kTensorBuffer));
 
 class OFRecordImageDecoderKernel final : public user_op::OpKernel {
@@ -265,15 +306,13 @@ class OFRecordImageDecoderKernel final : public user_op::OpKernel {
     CHECK(record_num > 0);
     user_op::Tensor* in_blob = ctx->Tensor4ArgNameAndIndex("in", 0);
     CHECK_EQ(out_blob->shape(), in_blob->shape());
-    const OFRecord* records = in_blob->dptr<OFRecord>();
     TensorBuffer* buffers = out_blob->mut_dptr<TensorBuffer>();
     const std::string& name = ctx->Attr<std::string>("name");
     const std::string& color_space = ctx->Attr<std::string>("color_space");
 
     MultiThreadLoop(record_num, [&](size_t i) {
-      const OFRecord& record = *(records + i);
       TensorBuffer* buffer = buffers + i;
-      DecodeRandomCropImageFromOneRecord(record, buffer, name, color_space, nullptr);
+      DecodeRandomCropImageFromOneRecord(in_blob, i, buffer, name, color_space, nullptr);
     });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -282,7 +321,8 @@ class OFRecordImageDecoderKernel final : public user_op::OpKernel {
 REGISTER_USER_KERNEL("ofrecord_image_decoder")
     .SetCreateFn<OFRecordImageDecoderKernel>()
     .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")
-                     & (user_op::HobDataType("in", 0) == DataType::kOFRecord)
+                     & ((user_op::HobDataType("in", 0) == DataType::kOFRecord)
+                        | (user_op::HobDataType("in", 0) == DataType::kTensorBuffer))
                      & (user_op::HobDataType("out", 0) == DataType::kTensorBuffer));
 
 }  // namespace oneflow
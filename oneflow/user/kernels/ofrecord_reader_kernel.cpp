@@ -55,6 +55,7 @@ class OFRecordReaderKernel final : public user_op::OpKernel {
 REGISTER_USER_KERNEL("OFRecordReader")
     .SetCreateFn<OFRecordReaderKernel>()
     .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")
-                     & (user_op::HobDataType("out", 0) == DataType::kOFRecord));
+                     & ((user_op::HobDataType("out", 0) == DataType::kOFRecord)
+                        | (user_op::HobDataType("out", 0) == DataType::kTensorBuffer)));
 
 }  // namespace oneflow
@@ -190,4 +190,71 @@ REGISTER_CPU_ONLY_USER_OP("image_random_crop")
     })
     .SetBatchAxisInferFn(user_op::BatchAxisInferFnUtil::NaiveInferBatchAxis);
 
+REGISTER_CPU_ONLY_USER_OP("image_decode_crop_resize_mirror_normalize")
+    .Input("in")
+    .OptionalInput("mirror")
+    .Output("out")
+    .Attr<std::string>("color_space", "BGR")
+    .Attr<int64_t>("target_width")
+    .Attr<int64_t>("target_height")
+    .Attr<bool>("random_crop", true)
+    .Attr<int32_t>("num_attempts", 10)
+    .Attr<int64_t>("seed", -1)
+    .Attr<bool>("has_seed", false)
+    .Attr<std::vector<float>>("random_area", {0.08, 1.0})
+    .Attr<std::vector<float>>("random_aspect_ratio", {0.75, 1.333333})
+    .Attr<std::string>("output_layout", "NCHW")
+    .Attr<std::vector<float>>("mean", {0.0})
+    .Attr<std::vector<float>>("std", {1.0})
+    .Attr<DataType>("output_dtype", DataType::kFloat)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      user_op::TensorDesc* in_tensor = ctx->TensorDesc4ArgNameAndIndex("in", 0);
+      CHECK_EQ_OR_RETURN(in_tensor->data_type(), DataType::kTensorBuffer);
+      CHECK_EQ_OR_RETURN(in_tensor->shape().NumAxes(), 1);
+      user_op::TensorDesc* mirror_tensor = ctx->TensorDesc4ArgNameAndIndex("mirror", 0);
+      if (mirror_tensor) {
+        CHECK_OR_RETURN(mirror_tensor->shape().NumAxes() == 1
+                        && in_tensor->shape().At(0) == mirror_tensor->shape().At(0));
+        CHECK_EQ_OR_RETURN(mirror_tensor->data_type(), DataType::kInt8);
+      }
+      const std::string& color_space = ctx->Attr<std::string>("color_space");
+      CHECK_OR_RETURN(color_space == "BGR" || color_space == "RGB" || color_space == "GRAY")
+          << "color_space: " << color_space << " is not supported";
+      int64_t N = in_tensor->shape().At(0);
+      int64_t H = ctx->Attr<int64_t>("target_height");
+      int64_t W = ctx->Attr<int64_t>("target_width");
+      int64_t C = ImageUtil::IsColor(color_space) ? 3 : 1;
+      CHECK_OR_RETURN(H > 0 && W > 0);
+      user_op::TensorDesc* out_tensor = ctx->TensorDesc4ArgNameAndIndex("out", 0);
+      const std::string& output_layout = ctx->Attr<std::string>("output_layout");
+      if (output_layout == "NCHW") {
+        *out_tensor->mut_shape() = Shape({N, C, H, W});
+      } else if (output_layout == "NHWC") {
+        *out_tensor->mut_shape() = Shape({N, H, W, C});
+      } else {
+        return Error::CheckFailedError()
+               << "output_layout: " << output_layout << " is not supported";
+      }
+      DataType output_dtype = ctx->Attr<DataType>("output_dtype");
+      CHECK_OR_RETURN(output_dtype == DataType::kFloat || output_dtype == DataType::kFloat16)
+          << "output_dtype: " << output_dtype << " is not supported";
+      *out_tensor->mut_data_type() = output_dtype;
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) {
+      user_op::InputArgModifier* in_modifier = GetInputArgModifierFn("in", 0);
+      CHECK_NOTNULL(in_modifier);
+      in_modifier->set_requires_grad(false);
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      ctx->NewBuilder().Split(ctx->inputs(), 0).Split(ctx->outputs(), 0).Build();
+      return Maybe<void>::Ok();
+    })
+    .SetBatchAxisInferFn([](user_op::BatchAxisContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->BatchAxis4ArgNameAndIndex("in", 0)->value(), 0);
+      ctx->BatchAxis4ArgNameAndIndex("out", 0)->set_value(0);
+      return Maybe<void>::Ok();
+    });
+
 }  // namespace oneflow
@@ -28,6 +28,12 @@ REGISTER_CPU_ONLY_USER_OP("OFRecordReader")
     .Attr<int64_t>("seed", -1)
     .Attr<int32_t>("shuffle_buffer_size", 1024)
     .Attr<bool>("shuffle_after_epoch", false)
+    .Attr<bool>("lazy_parse", false)
+    .Attr<bool>("indexed", false)
+    .Attr<int64_t>("start_cursor", 0)
+    .Attr<std::string>("cache_mode", "none")
+    .Attr<std::string>("cache_dir", "")
+    .Attr<int64_t>("cache_memory_budget", -1)
     .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
       user_op::TensorDesc* out_tensor = ctx->TensorDesc4ArgNameAndIndex("out", 0);
       int32_t local_batch_size = ctx->Attr<int32_t>("batch_size");
@@ -38,7 +44,9 @@ REGISTER_CPU_ONLY_USER_OP("OFRecordReader")
         local_batch_size /= parallel_num;
       }
       *out_tensor->mut_shape() = Shape({local_batch_size});
-      *out_tensor->mut_data_type() = DataType::kOFRecord;
+      // lazily parsed records are kept serialized, to be read through OFRecordView by decoders
+      *out_tensor->mut_data_type() =
+          ctx->Attr<bool>("lazy_parse") ? DataType::kTensorBuffer : DataType::kOFRecord;
       return Maybe<void>::Ok();
     })
     .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {